@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <dynarmic/A32/config.h>
 
@@ -48,6 +49,31 @@ public:
      */
     void InvalidateCacheRange(std::uint32_t start_address, std::size_t length);
 
+    /**
+     * Queues an invalidation of the code cache at a range of addresses.
+     * Can be called from any thread. The invalidation is performed by the thread running this Jit at
+     * its next safepoint without returning from Jit::Run, or at the start of the next call to Jit::Run.
+     * @param start_address The starting address of the range to invalidate.
+     * @param length The length (in bytes) of the range to invalidate.
+     */
+    void QueueInvalidateCacheRange(std::uint32_t start_address, std::size_t length);
+
+    /**
+     * Invalidates the software TLB (See: UserConfig::enable_tlb).
+     * Must be called whenever an entry in the page table is modified.
+     * Can only be called from a callback, or while Jit::Run is not executing. To invalidate the TLB
+     * of a Jit running on another thread, halt it first (See: Jit::HaltExecution).
+     */
+    void InvalidateTLB();
+
+    /**
+     * Returns the base addresses of all pages marked in the dirty page bitmap
+     * (See: UserConfig::dirty_page_bitmap) and clears the bitmap.
+     * Can be called while other Jits sharing the bitmap are running. Cannot be called from a callback.
+     * @note This scans the whole bitmap of 16Ki words.
+     */
+    std::vector<std::uint32_t> HarvestDirtyPages();
+
     /**
      * Reset CPU state to state at startup. Does not clear code cache.
      * Cannot be called from a callback.
@@ -56,7 +82,9 @@ public:
 
     /**
      * Stops execution in Jit::Run.
-     * Can only be called from a callback.
+     * May be called from a callback or from another thread. Execution stops at the next block link,
+     * indirect branch or return to the dispatcher. If called while Jit::Run is not executing, the
+     * next call to Jit::Run stops at the first such point.
      */
     void HaltExecution();
 
@@ -12,6 +12,9 @@
 #include <memory>
 
 namespace Dynarmic {
+
+class ExclusiveMonitor;
+
 namespace A32 {
 
 using VAddr = std::uint32_t;
@@ -73,12 +76,35 @@ struct UserCallbacks {
 struct UserConfig {
     UserCallbacks* callbacks;
 
+    size_t processor_id = 0;
+    // Exclusive monitor shared by the processors of an emulated system. Unless
+    // inline_exclusive_access is enabled, every LDREX and every STREX which may succeed calls
+    // into the monitor; only a STREX without a local reservation fails inline.
+    ExclusiveMonitor* global_monitor = nullptr;
+
     // Page Table
     // The page table is used for faster memory access. If an entry in the table is nullptr,
     // the JIT will fallback to calling the MemoryRead*/MemoryWrite* callbacks.
     static constexpr std::size_t PAGE_BITS = 12;
     static constexpr std::size_t NUM_PAGE_TABLE_ENTRIES = 1 << (32 - PAGE_BITS);
     std::array<std::uint8_t*, NUM_PAGE_TABLE_ENTRIES>* page_table = nullptr;
+    // This enables a small direct-mapped software TLB that caches recently used entries
+    // of page_table in the JIT state. If this is true, Jit::InvalidateTLB must be called
+    // whenever an entry in page_table is modified.
+    bool enable_tlb = false;
+    // Pointer to a bitmap of NUM_PAGE_TABLE_ENTRIES bits, one per page. If this is not nullptr,
+    // writes which go directly through page_table set the bit of the written page. Writes which
+    // go through the memory callbacks are not recorded. Use Jit::HarvestDirtyPages to read and
+    // clear the bitmap.
+    std::uint64_t* dirty_page_bitmap = nullptr;
+    // Determines if exclusive accesses are done inline. Exclusive stores to memory in page_table
+    // write to it directly instead of calling the memory callbacks. If global_monitor is set,
+    // LDREX marks its reservation, and STREX checks its reservation and clears those of other
+    // processors, from emitted code. This takes the monitor's lock for the granule, as the monitor
+    // itself does, so callers may still use the monitor directly. Exclusive stores which miss
+    // page_table or cross a page boundary go through the monitor and the memory callbacks.
+    // This is only used if page_table is not nullptr.
+    bool inline_exclusive_access = false;
 
     // Coprocessors
     std::array<std::shared_ptr<Coprocessor>, 16> coprocessors;
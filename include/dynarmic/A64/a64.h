@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <dynarmic/A64/config.h>
 
@@ -43,6 +44,32 @@ public:
      */
     void InvalidateCacheRange(std::uint64_t start_address, std::size_t length);
 
+    /**
+     * Queues an invalidation of the code cache at a range of addresses.
+     * Can be called from any thread. The invalidation is performed by the thread running this Jit at
+     * its next safepoint without returning from Jit::Run, or at the start of the next call to Jit::Run.
+     * @param start_address The starting address of the range to invalidate.
+     * @param length The length (in bytes) of the range to invalidate.
+     */
+    void QueueInvalidateCacheRange(std::uint64_t start_address, std::size_t length);
+
+    /**
+     * Invalidates the software TLB (See: UserConfig::enable_tlb).
+     * Must be called whenever an entry in the page table is modified.
+     * Can only be called from a callback, or while Jit::Run is not executing. To invalidate the TLB
+     * of a Jit running on another thread, halt it first (See: Jit::HaltExecution).
+     */
+    void InvalidateTLB();
+
+    /**
+     * Returns the base addresses of all pages marked in the dirty page bitmap
+     * (See: UserConfig::dirty_page_bitmap) and clears the bitmap.
+     * Can be called while other Jits sharing the bitmap are running. Cannot be called from a callback.
+     * @note This scans the whole bitmap, which is 1 << (page_table_address_space_bits - 18) words
+     *       (256Ki words at the default of 36 bits), so avoid calling it too frequently.
+     */
+    std::vector<std::uint64_t> HarvestDirtyPages();
+
     /**
      * Reset CPU state to state at startup. Does not clear code cache.
      * Cannot be called from a callback.
@@ -51,7 +78,9 @@ public:
 
     /**
      * Stops execution in Jit::Run.
-     * Can only be called from a callback.
+     * May be called from a callback or from another thread. Execution stops at the next block link,
+     * indirect branch or return to the dispatcher. If called while Jit::Run is not executing, the
+     * next call to Jit::Run stops at the first such point.
      */
     void HaltExecution();
 
@@ -115,6 +144,20 @@ public:
      */
     std::string Disassemble() const;
 
+    struct CodeStatistics {
+        /// Size in bytes of all host machine code produced, including far code.
+        std::size_t code_size;
+        /// Number of loads from and stores to spill slots emitted by the register allocator.
+        std::size_t spill_count;
+        /// Number of moves between host registers emitted by the register allocator.
+        std::size_t move_count;
+    };
+
+    /**
+     * Debugging: Statistics about all of compiled code since the cache was last cleared.
+     */
+    CodeStatistics GetCodeStatistics() const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> impl;
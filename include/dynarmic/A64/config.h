@@ -7,13 +7,20 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace Dynarmic {
+
+class ExclusiveMonitor;
+
 namespace A64 {
 
+class TranslationCache;
+
 using VAddr = std::uint64_t;
 
 using Vector = std::array<std::uint64_t, 2>;
@@ -108,7 +115,15 @@ struct UserCallbacks {
     virtual std::uint64_t GetCNTPCT() = 0;
 };
 
-class ExclusiveMonitor;
+using ExclusiveMonitor = Dynarmic::ExclusiveMonitor;
+
+/// Describes a device mapped into guest memory. The functions are called directly from emitted
+/// code with the device's context instead of going through UserCallbacks.
+struct MMIOHandler {
+    void* context = nullptr;
+    std::uint64_t (*read)(void* context, VAddr vaddr, std::size_t bytesize) = nullptr;
+    void (*write)(void* context, VAddr vaddr, std::uint64_t value, std::size_t bytesize) = nullptr;
+};
 
 struct UserConfig {
     UserCallbacks* callbacks;
@@ -116,12 +131,25 @@ struct UserConfig {
     size_t processor_id = 0;
     ExclusiveMonitor* global_monitor = nullptr;
 
+    /// When set, blocks translated by this Jit are shared with every other Jit constructed with
+    /// the same TranslationCache. Jit::InvalidateCacheRange and Jit::ClearCache also discard the
+    /// shared translations; use TranslationCache::InvalidateCacheRange to invalidate a range on
+    /// every sharing Jit at once.
+    TranslationCache* translation_cache = nullptr;
+
     /// When set to true, UserCallbacks::DataCacheOperationRaised will be called when any
     /// data cache instruction is executed. Notably DC ZVA will not implicitly do anything.
     /// When set to false, UserCallbacks::DataCacheOperationRaised will never be called.
     /// Executing DC ZVA in this mode will result in zeros being written to memory.
     bool hook_data_cache_operations = false;
 
+    /// When set to true and global_monitor is not nullptr, WFE, SEV and SEVL are handled inline
+    /// using per-processor event registers held by global_monitor. UserCallbacks::ExceptionRaised
+    /// is then only called with WaitForEvent when the event register was clear, and with SendEvent
+    /// when another processor may be waiting for an event.
+    /// When set to false, these instructions always call UserCallbacks::ExceptionRaised.
+    bool inline_event_handling = false;
+
     /// Counter-timer frequency register. The value of the register is not interpreted by
     /// dynarmic.
     std::uint32_t cntfrq_el0 = 600000000;
@@ -159,6 +187,35 @@ struct UserConfig {
     /// relevant memory callback.
     /// This is only used if page_table is not nullptr.
     bool silently_mirror_page_table = true;
+    /// This enables a small direct-mapped software TLB that caches recently used entries
+    /// of page_table in the JIT state. If this is true, Jit::InvalidateTLB must be called
+    /// whenever an entry in page_table is modified.
+    /// This is only used if page_table is not nullptr.
+    bool enable_tlb = false;
+    /// Pointer to a bitmap of (1 << (page_table_address_space_bits - 12)) bits, one per page.
+    /// If this is not nullptr, writes which go directly through page_table set the bit of
+    /// the written page. Writes which go through the memory callbacks are not recorded.
+    /// Use Jit::HarvestDirtyPages to read and clear the bitmap.
+    /// This is only used if page_table is not nullptr.
+    std::uint64_t* dirty_page_bitmap = nullptr;
+    /// Pointer to a table of (1 << (page_table_address_space_bits - 12)) entries parallel to
+    /// page_table. A non-null entry marks the page as MMIO, and the page_table entry for such a
+    /// page should be null. Accesses to an MMIO page which miss page_table
+    /// call the handler directly instead of the memory callbacks, and accesses to constant
+    /// addresses within it call the handler without walking the page table. 128-bit accesses
+    /// always use the memory callbacks. Jit::ClearCache must be called whenever an entry changes.
+    /// This is only used if page_table is not nullptr.
+    MMIOHandler* const* mmio_page_table = nullptr;
+    /// Determines if exclusive loads and stores to memory in page_table are done inline.
+    /// An exclusive load records the value it loaded, and an exclusive store becomes a host
+    /// compare-and-swap against that value. Note that such a store succeeds if memory still
+    /// holds the loaded value, even if it has been written to in between. Accesses which miss
+    /// page_table go through global_monitor and the memory callbacks as usual. Only the store
+    /// side is inlined when global_monitor is set: exclusive loads still call into it to mark
+    /// the reservation, and a successful inline store clears the reservations other processors
+    /// hold on its granule, so processors may mix inline and callback exclusives.
+    /// This is only used if page_table is not nullptr.
+    bool inline_exclusive_access = false;
 
     /// This option relates to translation. Generally when we run into an unpredictable
     /// instruction the ExceptionRaised callback is called. If this is true, we define
@@ -168,6 +225,30 @@ struct UserConfig {
     /// This enables the fast dispatcher.
     bool enable_fast_dispatch = true;
 
+    /// This option relates to translation. If this is true and the host supports the SHA
+    /// extensions, the SHA1 and SHA256 instructions are emitted with them. Otherwise they are
+    /// expanded into generic vector operations.
+    bool enable_host_sha_instructions = true;
+
+    /// This computes the live ranges of all values in a block before emitting it, and uses them
+    /// to decide which registers to allocate and which values to spill. This is a heuristic on top
+    /// of the usual greedy allocator, not a linear scan allocator: values are still assigned one
+    /// instruction at a time, only the choice of register and of eviction victim changes. This
+    /// reduces spills in long blocks at the cost of slower translation (See: Jit::GetCodeStatistics).
+    bool enable_liveness_register_allocation = false;
+
+    /// Guest registers which are kept in host registers for the whole of Jit::Run, instead of
+    /// being loaded from and stored to memory by every block. Indices 0-30 refer to X0-X30 and
+    /// 31 refers to SP. At most four registers may be pinned. Pinned registers are written back
+    /// before and reloaded after every callback, so callbacks may still access them.
+    std::vector<std::size_t> pinned_registers = {};
+
+    /// When a block ends in direct links to already-translated blocks which all overwrite NZCV
+    /// before reading it, the final NZCV write of that block is only performed on the paths which
+    /// return to the dispatcher. A block is retranslated whenever any block it links to is
+    /// invalidated.
+    bool enable_cross_block_nzcv_elimination = false;
+
     // The below options relate to accuracy of floating-point emulation.
 
     /// Determines how accurate NaN handling is.
@@ -180,6 +261,16 @@ struct UserConfig {
         NoChecks,
     } floating_point_nan_accuracy = NaNAccuracy::Accurate;
 
+    /// When not nullptr, ticks are accounted for inline and UserCallbacks::AddTicks and
+    /// UserCallbacks::GetTicksRemaining are never called. Emitted code instead adds the cycles of
+    /// each executed block to *cycle_counter, and Jit::Run returns once *cycle_counter is no longer
+    /// less than *cycle_deadline. Both values are treated as signed 64-bit integers.
+    /// *cycle_counter must only be modified while this Jit is not executing.
+    std::uint64_t* cycle_counter = nullptr;
+    /// Must not be nullptr if cycle_counter is not nullptr. The deadline may be shared between
+    /// several Jit instances and may be modified by any thread at any time.
+    const std::atomic<std::uint64_t>* cycle_deadline = nullptr;
+
     // Determines whether AddTicks and GetTicksRemaining are called.
     // If false, execution will continue until soon after Jit::HaltExecution is called.
     // bool enable_ticks = true; // TODO
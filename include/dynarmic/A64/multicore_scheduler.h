@@ -0,0 +1,75 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <dynarmic/A64/config.h>
+
+namespace Dynarmic {
+namespace A64 {
+
+class Jit;
+
+/// Runs several Jit instances on a pool of host threads, giving each core a quantum of ticks at a time.
+/// Each host thread has its own run queue with its own lock, and idle host threads steal runnable cores
+/// from busy ones. Cores which wait for an interrupt or event are parked until woken.
+///
+/// The scheduler relies on the embedder forwarding the following from each core's UserCallbacks:
+/// AddTicks, GetTicksRemaining and ExceptionRaised (See the member functions of the same names).
+class MultiCoreScheduler final {
+public:
+    /**
+     * @param cores The cores to run. Core i is identified by core_index i in the member functions below.
+     * @param host_thread_count The number of host threads to run the cores on.
+     * @param quantum The number of ticks a core executes before it yields its host thread.
+     */
+    MultiCoreScheduler(std::vector<Jit*> cores, std::size_t host_thread_count, std::uint64_t quantum);
+    ~MultiCoreScheduler();
+
+    MultiCoreScheduler(const MultiCoreScheduler&) = delete;
+    MultiCoreScheduler& operator=(const MultiCoreScheduler&) = delete;
+
+    /**
+     * Runs the cores until Stop is called. Blocks the calling thread.
+     */
+    void Run();
+
+    /**
+     * Requests that Run returns once every running core has reached a safepoint.
+     * Can be called from any thread, including from within callbacks.
+     */
+    void Stop();
+
+    /**
+     * Wakes a core that is waiting for an interrupt or an event. If the core is not waiting, its next
+     * WFI or WFE completes immediately. Can be called from any thread.
+     */
+    void SignalInterrupt(std::size_t core_index);
+
+    /// To be called from UserCallbacks::AddTicks of core core_index.
+    void AddTicks(std::size_t core_index, std::uint64_t ticks);
+    /// To be called from UserCallbacks::GetTicksRemaining of core core_index.
+    std::uint64_t GetTicksRemaining(std::size_t core_index) const;
+
+    /**
+     * To be called from UserCallbacks::ExceptionRaised of core core_index.
+     * Handles WaitForInterrupt, WaitForEvent, SendEvent, SendEventLocal and Yield.
+     * @returns false if the exception was not handled, in which case the embedder should handle it.
+     */
+    bool ExceptionRaised(std::size_t core_index, Exception exception);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace A64
+} // namespace Dynarmic
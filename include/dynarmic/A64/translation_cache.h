@@ -0,0 +1,56 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Dynarmic {
+namespace A64 {
+
+class Jit;
+
+/// A cache of translated guest code, shared by the Jit instances of an emulated system
+/// (See: UserConfig::translation_cache).
+///
+/// Blocks translated by one Jit are reused by every other Jit which shares the cache,
+/// skipping decoding and optimization. Each Jit still emits its own host code.
+///
+/// All Jit instances sharing a cache must have equivalent configurations (only processor_id
+/// and callbacks may differ), and their callbacks must present the same guest code.
+///
+/// Only the translations are shared; the memory each Jit uses for host code is unaffected.
+class TranslationCache final {
+public:
+    /// @param max_size Maximum amount of memory (in bytes) used by the translations held. All
+    ///                 translations are discarded when this is reached, as a Jit does with its
+    ///                 host code when its code cache is full.
+    explicit TranslationCache(std::size_t max_size = 64 * 1024 * 1024);
+    ~TranslationCache();
+
+    TranslationCache(const TranslationCache&) = delete;
+    TranslationCache& operator=(const TranslationCache&) = delete;
+
+    /**
+     * Invalidates the cached translations of code within a range of addresses, and queues the same
+     * invalidation on every Jit sharing this cache (See: Jit::QueueInvalidateCacheRange).
+     * Can be called from any thread.
+     * @param start_address The starting address of the range to invalidate.
+     * @param length The length (in bytes) of the range to invalidate.
+     */
+    void InvalidateCacheRange(std::uint64_t start_address, std::size_t length);
+
+private:
+    friend class Jit;
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace A64
+} // namespace Dynarmic
@@ -0,0 +1,113 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Dynarmic {
+
+/// A global exclusive monitor shared by all processors of an emulated system.
+/// This may be used by both A32 and A64 processors.
+class ExclusiveMonitor {
+public:
+    using VAddr = std::uint64_t;
+
+    static constexpr VAddr RESERVATION_GRANULE_MASK = 0xFFFF'FFFF'FFFF'FFF0ull;
+    static constexpr VAddr INVALID_EXCLUSIVE_ADDRESS = 0xDEAD'DEAD'DEAD'DEADull;
+    /// Exclusive operations on a reservation granule are serialised by one of LOCK_COUNT locks,
+    /// selected by (granule >> 4) % LOCK_COUNT.
+    static constexpr size_t LOCK_COUNT = 64;
+
+    /// @param processor_count Maximum number of processors using this global
+    ///                        exclusive monitor. Each processor must have a
+    ///                        unique id.
+    explicit ExclusiveMonitor(size_t processor_count);
+
+    size_t GetProcessorCount() const;
+
+    /// Marks a region containing [address, address+size) to be exclusive to
+    /// processor processor_id.
+    void Mark(size_t processor_id, VAddr address, size_t size);
+
+    /// Checks to see if processor processor_id has exclusive access to the
+    /// specified region. If it does, executes the operation then clears
+    /// the exclusive state for processors if their exclusive region(s)
+    /// contain [address, address+size).
+    template <typename Function>
+    bool DoExclusiveOperation(size_t processor_id, VAddr address, size_t size, Function op) {
+        if (!CheckAndClear(processor_id, address, size)) {
+            return false;
+        }
+
+        op();
+
+        Unlock(address);
+        return true;
+    }
+
+    /// Unmark everything.
+    void Clear();
+
+    /// Sets the event register of every processor, as a SEV instruction does.
+    /// This may be used to wake processors waiting in WFE when UserConfig::inline_event_handling is enabled.
+    void SendEvent();
+
+    /// Clears the event register of processor processor_id, returning whether it was set.
+    bool ClearEventRegister(size_t processor_id);
+
+    /// Pointer to the event register of processor processor_id, for use by emitted code.
+    std::atomic<std::uint8_t>* GetEventRegisterPointer(size_t processor_id);
+
+    /// Pointer to a flag which is set when a processor may be waiting for an event, for use by emitted code.
+    std::atomic<std::uint8_t>* GetWaitingForEventPointer();
+
+    /// Pointer to the reserved granule of processor processor_id, for use by emitted code.
+    /// Emitted code which writes to a granule must replace reservations of that granule with
+    /// INVALID_EXCLUSIVE_ADDRESS using an atomic compare-and-swap.
+    std::atomic<VAddr>* GetExclusiveAddressPointer(size_t processor_id);
+
+    /// Pointer to lock lock_index, for use by emitted code. A lock is held while it is non-zero:
+    /// emitted code acquires it by exchanging 1 into it, and releases it by storing 0.
+    std::atomic<std::uint8_t>* GetLockPointer(size_t lock_index);
+
+private:
+    bool CheckAndClear(size_t processor_id, VAddr address, size_t size);
+
+    void Lock(VAddr address);
+    void Unlock(VAddr address);
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // Each processor's reservation lives on its own cache line so that marking does not
+    // invalidate the lines of other processors.
+    struct alignas(CACHE_LINE_SIZE) ExclusiveAddress {
+        std::atomic<VAddr> address;
+    };
+    static_assert(sizeof(std::atomic<VAddr>) == sizeof(VAddr));
+    // Each granule lock lives on its own cache line, so unrelated granules do not contend.
+    struct alignas(CACHE_LINE_SIZE) GranuleLock {
+        std::atomic<std::uint8_t> is_locked;
+    };
+
+    // Each processor repeatedly consumes its own event register in WFE, so these are also kept on
+    // separate cache lines.
+    struct alignas(CACHE_LINE_SIZE) EventRegister {
+        std::atomic<std::uint8_t> is_set;
+    };
+    static_assert(sizeof(std::atomic<std::uint8_t>) == 1);
+
+    std::array<GranuleLock, LOCK_COUNT> locks;
+    std::vector<ExclusiveAddress> exclusive_addresses;
+    std::vector<EventRegister> event_registers;
+    std::atomic<std::uint8_t> waiting_for_event{0};
+};
+
+} // namespace Dynarmic
@@ -12,6 +12,7 @@
 #include <fmt/ostream.h>
 
 #include <dynarmic/A32/coprocessor.h>
+#include <dynarmic/exclusive_monitor.h>
 
 #include "backend/x64/a32_emit_x64.h"
 #include "backend/x64/a32_jitstate.h"
@@ -98,6 +99,10 @@ A32EmitX64::BlockDescriptor A32EmitX64::Emit(IR::Block& block) {
     // Start emitting.
     EmitCondPrelude(block);
 
+    if (BlockUsesGuestMxcsr(block)) {
+        code.SwitchMxcsrOnEntry();
+    }
+
     RegAlloc reg_alloc{code, A32JitState::SpillCount, SpillToOpArg<A32JitState>};
     A32EmitContext ctx{reg_alloc, block};
 
@@ -242,10 +247,17 @@ void A32EmitX64::GenTerminalHandlers() {
         code.or_(rbx, rcx);
     };
 
+    // Indirect branches do not pass through a block link, so a pending halt request is checked here.
+    const auto check_halt = [this] {
+        code.cmp(dword[r15 + offsetof(A32JitState, halt_requested)], 0);
+        code.jne(code.GetForceReturnFromRunCodeAddress());
+    };
+
     Xbyak::Label fast_dispatch_cache_miss, rsb_cache_miss;
 
     code.align();
     terminal_handler_pop_rsb_hint = code.getCurr<const void*>();
+    check_halt();
     calculate_location_descriptor();
     code.mov(eax, dword[r15 + offsetof(A32JitState, rsb_ptr)]);
     code.sub(eax, 1);
@@ -264,6 +276,7 @@ void A32EmitX64::GenTerminalHandlers() {
     if (config.enable_fast_dispatch) {
         code.align();
         terminal_handler_fast_dispatch_hint = code.getCurr<const void*>();
+        check_halt();
         calculate_location_descriptor();
         code.L(rsb_cache_miss);
         code.mov(r12, reinterpret_cast<u64>(fast_dispatch_table.data()));
@@ -692,7 +705,9 @@ void A32EmitX64::EmitA32CallSupervisor(A32EmitContext& ctx, IR::Inst* inst) {
     Devirtualize<&A32::UserCallbacks::GetTicksRemaining>(config.callbacks).EmitCall(code);
     code.mov(qword[r15 + offsetof(A32JitState, cycles_to_run)], code.ABI_RETURN);
     code.mov(qword[r15 + offsetof(A32JitState, cycles_remaining)], code.ABI_RETURN);
-    code.SwitchMxcsrOnEntry();
+    if (BlockUsesGuestMxcsr(ctx.block)) {
+        code.SwitchMxcsrOnEntry();
+    }
 }
 
 void A32EmitX64::EmitA32ExceptionRaised(A32EmitContext& ctx, IR::Inst* inst) {
@@ -754,15 +769,142 @@ void A32EmitX64::EmitA32ClearExclusive(A32EmitContext&, IR::Inst*) {
     code.mov(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(0));
 }
 
+// Acquires the global monitor's lock for granule, leaving a pointer to the lock in lock.
+static void EmitLockGranule(BlockOfCode& code, ExclusiveMonitor& monitor, Xbyak::Reg64 granule, Xbyak::Reg64 lock, Xbyak::Reg64 tmp) {
+    static_assert((ExclusiveMonitor::LOCK_COUNT & (ExclusiveMonitor::LOCK_COUNT - 1)) == 0);
+    const auto first_lock = reinterpret_cast<u64>(monitor.GetLockPointer(0));
+    const auto lock_stride = static_cast<u32>(reinterpret_cast<u64>(monitor.GetLockPointer(1)) - first_lock);
+
+    Xbyak::Label acquire, contended;
+
+    code.mov(lock.cvt32(), granule.cvt32());
+    code.shr(lock.cvt32(), 4);
+    code.and_(lock.cvt32(), u32(ExclusiveMonitor::LOCK_COUNT - 1));
+    code.imul(lock.cvt32(), lock.cvt32(), lock_stride);
+    code.mov(tmp, first_lock);
+    code.add(lock, tmp);
+    code.L(acquire);
+    code.mov(tmp.cvt32(), u32(1));
+    code.xchg(code.byte[lock], tmp.cvt8());
+    code.test(tmp.cvt8(), tmp.cvt8());
+    code.jnz(contended, code.T_NEAR);
+
+    // The lock is only held for a handful of instructions, so waiters spin as the monitor does.
+    code.SwitchToFarCode();
+    code.L(contended);
+    code.pause();
+    code.cmp(code.byte[lock], u8(0));
+    code.jne(contended);
+    code.jmp(acquire, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+static void EmitUnlockGranule(BlockOfCode& code, Xbyak::Reg64 lock) {
+    code.mov(code.byte[lock], u8(0));
+}
+
 void A32EmitX64::EmitA32SetExclusive(A32EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
     ASSERT(args[1].IsImmediate());
+
+    if (config.global_monitor && config.page_table && config.inline_exclusive_access) {
+        Xbyak::Reg32 address = ctx.reg_alloc.UseGpr(args[0]).cvt32();
+        Xbyak::Reg64 granule = ctx.reg_alloc.ScratchGpr();
+        Xbyak::Reg64 lock = ctx.reg_alloc.ScratchGpr();
+        Xbyak::Reg64 tmp = ctx.reg_alloc.ScratchGpr();
+
+        code.mov(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(1));
+        code.mov(dword[r15 + offsetof(A32JitState, exclusive_address)], address);
+        // This is ExclusiveMonitor::Mark.
+        code.mov(granule.cvt32(), address);
+        code.and_(granule.cvt32(), static_cast<u32>(ExclusiveMonitor::RESERVATION_GRANULE_MASK & 0xFFFF'FFFF));
+        EmitLockGranule(code, *config.global_monitor, granule, lock, tmp);
+        code.mov(tmp, reinterpret_cast<u64>(config.global_monitor->GetExclusiveAddressPointer(config.processor_id)));
+        code.mov(qword[tmp], granule);
+        EmitUnlockGranule(code, lock);
+
+        return;
+    }
+
+    if (config.global_monitor) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1]);
+
+        // The local reservation is also kept so that exclusive writes which cannot succeed fail without a call.
+        code.mov(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(1));
+        code.mov(dword[r15 + offsetof(A32JitState, exclusive_address)], code.ABI_PARAM2.cvt32());
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&config));
+        code.CallFunction(static_cast<void(*)(const A32::UserConfig&, u32, u8)>(
+            [](const A32::UserConfig& config, u32 vaddr, u8 size) {
+                config.global_monitor->Mark(config.processor_id, vaddr, size);
+            }
+        ));
+
+        return;
+    }
+
     Xbyak::Reg32 address = ctx.reg_alloc.UseGpr(args[0]).cvt32();
 
     code.mov(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(1));
     code.mov(dword[r15 + offsetof(A32JitState, exclusive_address)], address);
 }
 
+static void EmitPageLookup(BlockOfCode& code, const A32::UserConfig& config, Xbyak::Label& abort, Xbyak::Reg32 vaddr, Xbyak::Reg64 page, Xbyak::Reg64 page_index, Xbyak::Reg64 tmp) {
+    const auto walk_page_table = [&] {
+        code.mov(page, reinterpret_cast<u64>(config.page_table));
+        code.mov(page, qword[page + page_index * 8]);
+        code.test(page, page);
+        code.jz(abort, code.T_NEAR);
+    };
+
+    code.mov(page_index.cvt32(), vaddr);
+    code.shr(page_index.cvt32(), 12);
+
+    if (!config.enable_tlb) {
+        walk_page_table();
+        return;
+    }
+
+    // The TLB is direct-mapped and indexed by the low bits of the virtual page number.
+    // Misses walk the page table in far code and refill the entry.
+    constexpr size_t offsetof_tlb_vpage = offsetof(A32JitState, tlb) + offsetof(A32JitState::TLBEntry, vpage);
+    constexpr size_t offsetof_tlb_host_page = offsetof(A32JitState, tlb) + offsetof(A32JitState::TLBEntry, host_page);
+
+    Xbyak::Label tlb_miss, tlb_hit;
+
+    code.mov(tmp.cvt32(), page_index.cvt32());
+    code.and_(tmp.cvt32(), u32(A32JitState::TLBIndexMask));
+    code.shl(tmp.cvt32(), 4);
+    code.cmp(page_index, qword[r15 + tmp + offsetof_tlb_vpage]);
+    code.jne(tlb_miss, code.T_NEAR);
+    code.mov(page, qword[r15 + tmp + offsetof_tlb_host_page]);
+    code.L(tlb_hit);
+
+    code.SwitchToFarCode();
+    code.L(tlb_miss);
+    walk_page_table();
+    code.mov(qword[r15 + tmp + offsetof_tlb_vpage], page_index);
+    code.mov(qword[r15 + tmp + offsetof_tlb_host_page], page);
+    code.jmp(tlb_hit, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+// Clobbers rax, page_index and mask.
+static void EmitMarkPageDirty(BlockOfCode& code, const A32::UserConfig& config, Xbyak::Reg64 page_index, Xbyak::Reg64 mask) {
+    Xbyak::Label already_dirty;
+
+    code.xor_(mask.cvt32(), mask.cvt32());
+    code.bts(mask, page_index);
+    code.shr(page_index.cvt32(), 6);
+    code.mov(rax, reinterpret_cast<u64>(config.dirty_page_bitmap));
+    // Other threads may be marking pages in the same word, so the bit is set with a locked or.
+    // Usually the page is already dirty, so the locked instruction is skipped if the bit is set.
+    code.test(qword[rax + page_index * 8], mask);
+    code.jnz(already_dirty);
+    code.lock();
+    code.or_(qword[rax + page_index * 8], mask);
+    code.L(already_dirty);
+}
+
 template <typename T, T (A32::UserCallbacks::*raw_fn)(A32::VAddr)>
 static void ReadMemory(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* inst, const A32::UserConfig& config, const CodePtr wrapped_fn) {
     constexpr size_t bit_size = Common::BitSize<T>();
@@ -783,12 +925,7 @@ static void ReadMemory(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* inst, c
 
     Xbyak::Label abort, end;
 
-    code.mov(result, reinterpret_cast<u64>(config.page_table));
-    code.mov(page_index.cvt32(), vaddr);
-    code.shr(page_index.cvt32(), 12);
-    code.mov(result, qword[result + page_index * 8]);
-    code.test(result, result);
-    code.jz(abort);
+    EmitPageLookup(code, config, abort, vaddr, result, page_index, page_offset);
     code.mov(page_offset.cvt32(), vaddr);
     code.and_(page_offset.cvt32(), 4095);
     switch (bit_size) {
@@ -838,12 +975,7 @@ static void WriteMemory(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* inst,
 
     Xbyak::Label abort, end;
 
-    code.mov(rax, reinterpret_cast<u64>(config.page_table));
-    code.mov(page_index.cvt32(), vaddr);
-    code.shr(page_index.cvt32(), 12);
-    code.mov(rax, qword[rax + page_index * 8]);
-    code.test(rax, rax);
-    code.jz(abort);
+    EmitPageLookup(code, config, abort, vaddr, rax, page_index, page_offset);
     code.mov(page_offset.cvt32(), vaddr);
     code.and_(page_offset.cvt32(), 4095);
     switch (bit_size) {
@@ -863,6 +995,9 @@ static void WriteMemory(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* inst,
         ASSERT_MSG(false, "Invalid bit_size");
         break;
     }
+    if (config.dirty_page_bitmap) {
+        EmitMarkPageDirty(code, config, page_index, page_offset);
+    }
     code.jmp(end);
     code.L(abort);
     code.call(wrapped_fn);
@@ -901,8 +1036,142 @@ void A32EmitX64::EmitA32WriteMemory64(A32EmitContext& ctx, IR::Inst* inst) {
     WriteMemory<u64, &A32::UserCallbacks::MemoryWrite64>(code, ctx.reg_alloc, inst, config, write_memory_64);
 }
 
+static void EmitCrossPageCheck(BlockOfCode& code, Xbyak::Label& abort, Xbyak::Reg32 vaddr, Xbyak::Reg32 tmp, size_t bytesize) {
+    code.mov(tmp, vaddr);
+    code.and_(tmp, 4095);
+    code.cmp(tmp, u32(4096 - bytesize));
+    code.ja(abort, code.T_NEAR);
+}
+
+void A32EmitX64::EmitA32ReadMemory32x2(A32EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    if (!config.page_table) {
+        ctx.reg_alloc.HostCall(inst, {}, args[0]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(config.callbacks));
+        code.CallFunction(static_cast<u64(*)(A32::UserCallbacks*, u32)>(
+            [](A32::UserCallbacks* cb, u32 vaddr) -> u64 {
+                const u64 lo = cb->MemoryRead32(vaddr);
+                const u64 hi = cb->MemoryRead32(vaddr + 4);
+                return lo | (hi << 32);
+            }
+        ));
+        return;
+    }
+
+    ctx.reg_alloc.UseScratch(args[0], ABI_PARAM2);
+
+    Xbyak::Reg64 result = ctx.reg_alloc.ScratchGpr({ABI_RETURN});
+    Xbyak::Reg32 vaddr = code.ABI_PARAM2.cvt32();
+    Xbyak::Reg64 page_index = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 page_offset = ctx.reg_alloc.ScratchGpr();
+
+    Xbyak::Label abort, end;
+
+    EmitCrossPageCheck(code, abort, vaddr, page_offset.cvt32(), 8);
+    EmitPageLookup(code, config, abort, vaddr, result, page_index, page_offset);
+    code.mov(page_offset.cvt32(), vaddr);
+    code.and_(page_offset.cvt32(), 4095);
+    code.mov(result, qword[result + page_offset]);
+    code.jmp(end);
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.L(abort);
+    code.call(read_memory_32);
+    code.mov(page_index.cvt32(), result.cvt32());
+    code.add(vaddr, 4);
+    code.call(read_memory_32);
+    code.shl(result, 32);
+    code.or_(result, page_index);
+    code.L(end);
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
+void A32EmitX64::EmitA32WriteMemory32x2(A32EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    if (!config.page_table) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(config.callbacks));
+        code.CallFunction(static_cast<void(*)(A32::UserCallbacks*, u32, u64)>(
+            [](A32::UserCallbacks* cb, u32 vaddr, u64 value) {
+                cb->MemoryWrite32(vaddr, static_cast<u32>(value));
+                cb->MemoryWrite32(vaddr + 4, static_cast<u32>(value >> 32));
+            }
+        ));
+        return;
+    }
+
+    ctx.reg_alloc.ScratchGpr({ABI_RETURN});
+    ctx.reg_alloc.UseScratch(args[0], ABI_PARAM2);
+    ctx.reg_alloc.UseScratch(args[1], ABI_PARAM3);
+
+    Xbyak::Reg32 vaddr = code.ABI_PARAM2.cvt32();
+    Xbyak::Reg64 value = code.ABI_PARAM3;
+    Xbyak::Reg64 page_index = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 page_offset = ctx.reg_alloc.ScratchGpr();
+
+    Xbyak::Label abort, end;
+
+    EmitCrossPageCheck(code, abort, vaddr, page_offset.cvt32(), 8);
+    EmitPageLookup(code, config, abort, vaddr, rax, page_index, page_offset);
+    code.mov(page_offset.cvt32(), vaddr);
+    code.and_(page_offset.cvt32(), 4095);
+    code.mov(qword[rax + page_offset], value);
+    if (config.dirty_page_bitmap) {
+        EmitMarkPageDirty(code, config, page_index, page_offset);
+    }
+    code.jmp(end);
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.L(abort);
+    code.call(write_memory_32);
+    code.add(vaddr, 4);
+    code.shr(value, 32);
+    code.call(write_memory_32);
+    code.L(end);
+}
+
+// Clears the reservations of every processor which hold granule, as ExclusiveMonitor::CheckAndClear does.
+// Clobbers rax.
+static void EmitClearGlobalReservations(BlockOfCode& code, ExclusiveMonitor& monitor, Xbyak::Reg64 granule, Xbyak::Reg64 invalid, Xbyak::Reg64 ptr) {
+    const auto first_address = reinterpret_cast<u64>(monitor.GetExclusiveAddressPointer(0));
+
+    code.mov(invalid, ExclusiveMonitor::INVALID_EXCLUSIVE_ADDRESS);
+    code.mov(ptr, first_address);
+    for (size_t i = 0; i < monitor.GetProcessorCount(); i++) {
+        const auto offset = static_cast<u32>(reinterpret_cast<u64>(monitor.GetExclusiveAddressPointer(i)) - first_address);
+        Xbyak::Label next;
+        code.cmp(qword[ptr + offset], granule);
+        code.jne(next);
+        code.mov(rax, granule);
+        code.lock();
+        code.cmpxchg(qword[ptr + offset], invalid);
+        code.L(next);
+    }
+}
+
+template <typename T>
+static void EmitStoreToHostMemory(BlockOfCode& code, Xbyak::Reg64 dest, Xbyak::Reg64 value) {
+    switch (Common::BitSize<T>()) {
+    case 8:
+        code.mov(code.byte[dest], value.cvt8());
+        break;
+    case 16:
+        code.mov(word[dest], value.cvt16());
+        break;
+    case 32:
+        code.mov(dword[dest], value.cvt32());
+        break;
+    case 64:
+        code.mov(qword[dest], value);
+        break;
+    }
+}
+
 template <typename T, void (A32::UserCallbacks::*fn)(A32::VAddr, T)>
 static void ExclusiveWrite(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* inst, const A32::UserConfig& config, bool prepend_high_word) {
+    const bool inline_store = config.page_table && config.inline_exclusive_access;
+
     auto args = reg_alloc.GetArgumentInfo(inst);
     if (prepend_high_word) {
         reg_alloc.HostCall(nullptr, {}, args[0], args[1], args[2]);
@@ -911,24 +1180,90 @@ static void ExclusiveWrite(BlockOfCode& code, RegAlloc& reg_alloc, IR::Inst* ins
     }
     Xbyak::Reg32 passed = reg_alloc.ScratchGpr().cvt32();
     Xbyak::Reg32 tmp = code.ABI_RETURN.cvt32(); // Use one of the unusued HostCall registers.
+    Xbyak::Reg64 page, granule, lock, scratch;
+    if (inline_store) {
+        page = reg_alloc.ScratchGpr();
+        granule = reg_alloc.ScratchGpr();
+        scratch = reg_alloc.ScratchGpr();
+        if (config.global_monitor) {
+            lock = reg_alloc.ScratchGpr();
+        }
+    }
 
     Xbyak::Label end;
 
     code.mov(passed, u32(1));
     code.cmp(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(0));
-    code.je(end);
+    code.je(end, code.T_NEAR);
     code.mov(tmp, code.ABI_PARAM2);
     code.xor_(tmp, dword[r15 + offsetof(A32JitState, exclusive_address)]);
     code.test(tmp, A32JitState::RESERVATION_GRANULE_MASK);
-    code.jne(end);
+    code.jne(end, code.T_NEAR);
     code.mov(code.byte[r15 + offsetof(A32JitState, exclusive_state)], u8(0));
     if (prepend_high_word) {
         code.mov(code.ABI_PARAM3.cvt32(), code.ABI_PARAM3.cvt32()); // zero extend to 64-bits
         code.shl(code.ABI_PARAM4, 32);
         code.or_(code.ABI_PARAM3, code.ABI_PARAM4);
     }
-    Devirtualize<fn>(config.callbacks).EmitCall(code);
-    code.xor_(passed, passed);
+    if (inline_store) {
+        const Xbyak::Reg32 vaddr = code.ABI_PARAM2.cvt32();
+        const Xbyak::Reg64 value = code.ABI_PARAM3;
+        Xbyak::Label fallback, reservation_lost;
+
+        if (sizeof(T) > 1) {
+            EmitCrossPageCheck(code, fallback, vaddr, scratch.cvt32(), sizeof(T));
+        }
+        EmitPageLookup(code, config, fallback, vaddr, page, granule, scratch);
+        code.mov(scratch.cvt32(), vaddr);
+        code.and_(scratch.cvt32(), 4095);
+        code.add(page, scratch);
+
+        if (config.global_monitor) {
+            // This is ExclusiveMonitor::DoExclusiveOperation, with the store as the operation.
+            code.mov(granule.cvt32(), vaddr);
+            code.and_(granule.cvt32(), static_cast<u32>(ExclusiveMonitor::RESERVATION_GRANULE_MASK & 0xFFFF'FFFF));
+            EmitLockGranule(code, *config.global_monitor, granule, lock, scratch);
+            code.mov(scratch, reinterpret_cast<u64>(config.global_monitor->GetExclusiveAddressPointer(config.processor_id)));
+            code.cmp(qword[scratch], granule);
+            code.jne(reservation_lost, code.T_NEAR);
+            // passed is known to be one here, so it can hold the invalid address until it is cleared.
+            EmitClearGlobalReservations(code, *config.global_monitor, granule, passed.cvt64(), scratch);
+            EmitStoreToHostMemory<T>(code, page, value);
+            EmitUnlockGranule(code, lock);
+        } else {
+            EmitStoreToHostMemory<T>(code, page, value);
+        }
+        code.xor_(passed, passed);
+        if (config.dirty_page_bitmap) {
+            code.mov(granule.cvt32(), vaddr);
+            code.shr(granule.cvt32(), 12);
+            EmitMarkPageDirty(code, config, granule, scratch);
+        }
+        code.jmp(end, code.T_NEAR);
+
+        if (config.global_monitor) {
+            code.L(reservation_lost);
+            EmitUnlockGranule(code, lock);
+            code.jmp(end, code.T_NEAR);
+        }
+
+        // Stores which miss the page table or cross a page boundary are not done inline.
+        code.L(fallback);
+    }
+    if (config.global_monitor) {
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&config));
+        code.CallFunction(static_cast<u32(*)(const A32::UserConfig&, A32::VAddr, T)>(
+            [](const A32::UserConfig& config, A32::VAddr vaddr, T value) -> u32 {
+                return config.global_monitor->DoExclusiveOperation(config.processor_id, vaddr, sizeof(T), [&]{
+                    (config.callbacks->*fn)(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        code.mov(passed, code.ABI_RETURN.cvt32());
+    } else {
+        Devirtualize<fn>(config.callbacks).EmitCall(code);
+        code.xor_(passed, passed);
+    }
     code.L(end);
 
     reg_alloc.DefineValue(inst, passed);
@@ -1252,7 +1587,11 @@ void A32EmitX64::EmitTerminalImpl(IR::Term::LinkBlock terminal, IR::LocationDesc
         code.mov(dword[r15 + offsetof(A32JitState, CPSR_et)], CalculateCpsr_et(terminal.next));
     }
 
-    code.cmp(qword[r15 + offsetof(A32JitState, cycles_remaining)], 0);
+    Xbyak::Label dest;
+
+    code.cmp(dword[r15 + offsetof(A32JitState, halt_requested)], 0);
+    code.jne(dest, Xbyak::CodeGenerator::T_NEAR);
+    code.CompareCyclesRemaining();
 
     patch_information[terminal.next].jg.emplace_back(code.getCurr());
     if (auto next_bb = GetBasicBlock(terminal.next)) {
@@ -1260,7 +1599,6 @@ void A32EmitX64::EmitTerminalImpl(IR::Term::LinkBlock terminal, IR::LocationDesc
     } else {
         EmitPatchJg(terminal.next);
     }
-    Xbyak::Label dest;
     code.jmp(dest, Xbyak::CodeGenerator::T_NEAR);
 
     code.SwitchToFarCode();
@@ -1309,7 +1647,7 @@ void A32EmitX64::EmitTerminalImpl(IR::Term::CheckBit, IR::LocationDescriptor) {
 }
 
 void A32EmitX64::EmitTerminalImpl(IR::Term::CheckHalt terminal, IR::LocationDescriptor initial_location) {
-    code.cmp(code.byte[r15 + offsetof(A32JitState, halt_requested)], u8(0));
+    code.cmp(dword[r15 + offsetof(A32JitState, halt_requested)], 0);
     code.jne(code.GetForceReturnFromRunCodeAddress());
     EmitTerminal(terminal.else_, initial_location);
 }
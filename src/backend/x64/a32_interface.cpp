@@ -16,8 +16,11 @@
 #include "backend/x64/devirtualize.h"
 #include "backend/x64/jitstate_info.h"
 #include "common/assert.h"
+#include "common/atomic.h"
+#include "common/bit_util.h"
 #include "common/common_types.h"
 #include "common/llvm_disassemble.h"
+#include "common/mpsc_queue.h"
 #include "common/scope_exit.h"
 #include "dynarmic/A32/a32.h"
 #include "dynarmic/A32/context.h"
@@ -56,6 +59,8 @@ struct Jit::Impl {
     size_t invalid_cache_generation = 0;
     boost::icl::interval_set<u32> invalid_cache_ranges;
     bool invalidate_entire_cache = false;
+    // Invalidations requested by other threads, performed by the thread that runs this Jit.
+    Common::MPSCQueue<boost::icl::discrete_interval<u32>> queued_cache_invalidations;
 
     void Execute() {
         const u32 new_rsb_ptr = (jit_state.rsb_ptr - 1) & A32JitState::RSBPtrMask;
@@ -75,6 +80,8 @@ struct Jit::Impl {
     }
 
     void PerformCacheInvalidation() {
+        queued_cache_invalidations.Drain([this](const auto& range) { invalid_cache_ranges.add(range); });
+
         if (invalidate_entire_cache) {
             jit_state.ResetRSB();
             block_of_code.ClearCache();
@@ -98,7 +105,7 @@ struct Jit::Impl {
 
     void RequestCacheInvalidation() {
         if (jit_interface->is_executing) {
-            jit_state.halt_requested = true;
+            Atomic::Or(&jit_state.halt_requested, A32JitState::HALT_EXECUTION);
             return;
         }
 
@@ -151,9 +158,20 @@ void Jit::Run() {
     is_executing = true;
     SCOPE_EXIT { this->is_executing = false; };
 
-    impl->jit_state.halt_requested = false;
+    while (true) {
+        impl->PerformCacheInvalidation();
+
+        impl->Execute();
+
+        // A request which arrives after the guest has stopped is satisfied by this return.
+        const u32 halt_reason = Atomic::Exchange(&impl->jit_state.halt_requested, 0);
 
-    impl->Execute();
+        // Invalidations queued by other threads are not visible to our caller: execution resumes once
+        // they have been performed.
+        if (halt_reason != A32JitState::HALT_FOR_QUEUED_INVALIDATION || impl->jit_state.cycles_remaining <= 0) {
+            break;
+        }
+    }
 
     impl->PerformCacheInvalidation();
 }
@@ -168,13 +186,46 @@ void Jit::InvalidateCacheRange(std::uint32_t start_address, std::size_t length)
     impl->RequestCacheInvalidation();
 }
 
+void Jit::QueueInvalidateCacheRange(std::uint32_t start_address, std::size_t length) {
+    impl->queued_cache_invalidations.Push(boost::icl::discrete_interval<u32>::closed(start_address, static_cast<u32>(start_address + length - 1)));
+    Atomic::Or(&impl->jit_state.halt_requested, A32JitState::HALT_FOR_QUEUED_INVALIDATION);
+}
+
+void Jit::InvalidateTLB() {
+    impl->jit_state.ResetTLB();
+}
+
+std::vector<u32> Jit::HarvestDirtyPages() {
+    ASSERT(!is_executing);
+
+    std::vector<u32> result;
+    if (!impl->config.dirty_page_bitmap) {
+        return result;
+    }
+
+    constexpr size_t word_count = A32::UserConfig::NUM_PAGE_TABLE_ENTRIES / 64;
+    for (size_t i = 0; i < word_count; i++) {
+        // Other Jits sharing the bitmap may be setting bits concurrently.
+        if (impl->config.dirty_page_bitmap[i] == 0) {
+            continue;
+        }
+        u64 word = Atomic::Exchange(&impl->config.dirty_page_bitmap[i], 0);
+        while (word != 0) {
+            const size_t bit = Common::LowestSetBit(word);
+            result.emplace_back(u32(i * 64 + bit) << A32::UserConfig::PAGE_BITS);
+            word &= word - 1;
+        }
+    }
+    return result;
+}
+
 void Jit::Reset() {
     ASSERT(!is_executing);
     impl->jit_state = {};
 }
 
 void Jit::HaltExecution() {
-    impl->jit_state.halt_requested = true;
+    Atomic::Or(&impl->jit_state.halt_requested, A32JitState::HALT_EXECUTION);
 }
 
 std::array<u32, 16>& Jit::Regs() {
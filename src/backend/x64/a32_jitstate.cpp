@@ -93,6 +93,10 @@ void A32JitState::ResetRSB() {
     rsb_codeptrs.fill(0);
 }
 
+void A32JitState::ResetTLB() {
+    tlb.fill({0xFFFFFFFFFFFFFFFFull, 0});
+}
+
 /**
  * Comparing MXCSR and FPSCR
  * =========================
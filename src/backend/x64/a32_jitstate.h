@@ -24,7 +24,7 @@ class BlockOfCode;
 struct A32JitState {
     using ProgramCounterType = u32;
 
-    A32JitState() { ResetRSB(); }
+    A32JitState() { ResetRSB(); ResetTLB(); }
 
     std::array<u32, 16> Reg{}; // Current register file.
     // TODO: Mode-specific register sets unimplemented.
@@ -50,9 +50,14 @@ struct A32JitState {
     // For internal use (See: BlockOfCode::RunCode)
     u32 guest_MXCSR = 0x00001f80;
     u32 save_host_MXCSR = 0;
+    bool guest_MXCSR_loaded = false;
     s64 cycles_to_run = 0;
     s64 cycles_remaining = 0;
-    bool halt_requested = false;
+    // Non-zero requests that emitted code returns from RunCode at its next safepoint.
+    // May be set from another thread (See: common/atomic.h).
+    static constexpr u32 HALT_EXECUTION = 1 << 0;
+    static constexpr u32 HALT_FOR_QUEUED_INVALIDATION = 1 << 1;
+    volatile u32 halt_requested = 0;
 
     // Exclusive state
     static constexpr u32 RESERVATION_GRANULE_MASK = 0xFFFFFFF8;
@@ -66,6 +71,17 @@ struct A32JitState {
     std::array<u64, RSBSize> rsb_codeptrs;
     void ResetRSB();
 
+    // Software TLB (See: UserConfig::enable_tlb)
+    static constexpr size_t TLBSize = 128; // MUST be a power of 2.
+    static constexpr size_t TLBIndexMask = TLBSize - 1;
+    struct TLBEntry {
+        u64 vpage;
+        u64 host_page;
+    };
+    static_assert(sizeof(TLBEntry) == 16);
+    std::array<TLBEntry, TLBSize> tlb;
+    void ResetTLB();
+
     u32 fpsr_exc = 0;
     u32 fpsr_qc = 0; // Dummy value
     u32 FPSCR_IDC = 0;
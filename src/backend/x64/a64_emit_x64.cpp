@@ -4,8 +4,10 @@
  * General Public License version 2 or any later version.
  */
 
+#include <cstring>
 #include <initializer_list>
 
+#include <boost/variant/get.hpp>
 #include <dynarmic/A64/exclusive_monitor.h>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -63,6 +65,68 @@ bool A64EmitContext::AccurateNaN() const {
     return conf.floating_point_nan_accuracy == A64::UserConfig::NaNAccuracy::Accurate;
 }
 
+// Callee-saved registers which the dispatcher and terminal handlers leave untouched.
+static constexpr std::array<HostLoc, 4> pinnable_host_locations{HostLoc::R13, HostLoc::R14, HostLoc::R12, HostLoc::RBP};
+
+static size_t PinnedRegisterOffset(size_t index) {
+    return index == 31 ? offsetof(A64JitState, sp) : offsetof(A64JitState, reg) + sizeof(u64) * index;
+}
+
+std::vector<std::pair<Xbyak::Reg64, size_t>> A64EmitX64::PinnedRegisterMap(const A64::UserConfig& conf) {
+    ASSERT_MSG(conf.pinned_registers.size() <= pinnable_host_locations.size(), "Too many pinned registers");
+
+    std::vector<std::pair<Xbyak::Reg64, size_t>> result;
+    for (size_t i = 0; i < conf.pinned_registers.size(); i++) {
+        const size_t index = conf.pinned_registers[i];
+        ASSERT_MSG(index <= 31, "Invalid pinned register {}", index);
+        ASSERT_MSG(std::count(conf.pinned_registers.begin(), conf.pinned_registers.end(), index) == 1, "Register {} pinned twice", index);
+        result.emplace_back(HostLocToReg64(pinnable_host_locations[i]), PinnedRegisterOffset(index));
+    }
+    return result;
+}
+
+// Emitters of these instructions leave the host flags intact, so guest NZCV held in the host
+// flags survives them. Any register allocation they do only emits moves.
+static bool PreservesHostFlags(const IR::Inst* inst) {
+    switch (inst->GetOpcode()) {
+    case IR::Opcode::Identity:
+    case IR::Opcode::A64GetW:
+    case IR::Opcode::A64GetX:
+    case IR::Opcode::A64GetS:
+    case IR::Opcode::A64GetD:
+    case IR::Opcode::A64GetQ:
+    case IR::Opcode::A64GetSP:
+    case IR::Opcode::A64SetW:
+    case IR::Opcode::A64SetX:
+    case IR::Opcode::A64SetS:
+    case IR::Opcode::A64SetD:
+    case IR::Opcode::A64SetQ:
+    case IR::Opcode::A64SetSP:
+    case IR::Opcode::A64SetPC:
+    case IR::Opcode::A64SetNZCV:
+    case IR::Opcode::ConditionalSelect32:
+    case IR::Opcode::ConditionalSelect64:
+    case IR::Opcode::ConditionalSelectNZCV:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Whether a block writes NZCV before anything in it can read it. Such a block makes the value of
+// NZCV on entry to it dead.
+static bool OverwritesNZCVBeforeReading(const IR::Block& block) {
+    for (const auto& inst : block) {
+        if (inst.GetOpcode() == IR::Opcode::A64SetNZCV) {
+            return true;
+        }
+        if (inst.ReadsFromCPSR() || inst.CausesCPUException()) {
+            return false;
+        }
+    }
+    return false;
+}
+
 A64EmitX64::A64EmitX64(BlockOfCode& code, A64::UserConfig conf, A64::Jit* jit_interface)
         : EmitX64(code), conf(conf), jit_interface{jit_interface} {
     GenMemory128Accessors();
@@ -84,12 +148,34 @@ A64EmitX64::BlockDescriptor A64EmitX64::Emit(IR::Block& block) {
     // Start emitting.
     EmitCondPrelude(block);
 
-    RegAlloc reg_alloc{code, A64JitState::SpillCount, SpillToOpArg<A64JitState>};
+    if (BlockUsesGuestMxcsr(block)) {
+        code.SwitchMxcsrOnEntry();
+    }
+
+    RegAlloc reg_alloc{code, A64JitState::SpillCount, SpillToOpArg<A64JitState>, PinnedHostLocations()};
     A64EmitContext ctx{conf, reg_alloc, block};
 
+    const bool overwrites_nzcv = OverwritesNZCVBeforeReading(block);
+    std::vector<IR::LocationDescriptor> nzcv_successors;
+    IR::Inst* const deferred_nzcv = conf.enable_cross_block_nzcv_elimination ? FindDeferrableSetNZCV(block, overwrites_nzcv, nzcv_successors) : nullptr;
+    nzcv_deferred_in_edx = false;
+
+    if (conf.enable_liveness_register_allocation) {
+        reg_alloc.AnalyzeLiveness(block, [this](const IR::Inst* inst) { return IsHostCall(inst); });
+    }
+
     for (auto iter = block.begin(); iter != block.end(); ++iter) {
         IR::Inst* inst = &*iter;
 
+        if (inst == deferred_nzcv) {
+            continue;
+        }
+
+        reg_alloc.BeginInstruction(inst);
+        if (!PreservesHostFlags(inst)) {
+            reg_alloc.ClobberHostFlags();
+        }
+
         // Call the relevant Emit* member function.
         switch (inst->GetOpcode()) {
 
@@ -112,22 +198,55 @@ A64EmitX64::BlockDescriptor A64EmitX64::Emit(IR::Block& block) {
             break;
         }
 
+        if (reg_alloc.MadeHostCall()) {
+            host_call_opcodes.set(static_cast<size_t>(inst->GetOpcode()));
+        }
+
+        ctx.reg_alloc.EndOfAllocScope();
+    }
+
+    if (deferred_nzcv) {
+        EmitDeferredSetNZCV(ctx, deferred_nzcv);
         ctx.reg_alloc.EndOfAllocScope();
     }
 
     reg_alloc.AssertNoMoreUses();
 
-    EmitAddCycles(block.CycleCount());
-    EmitX64::EmitTerminal(block.GetTerminal(), block.Location());
+    const IR::Terminal terminal = block.GetTerminal();
+    const auto* if_terminal = boost::get<IR::Term::If>(&terminal);
+    if (if_terminal && if_terminal->if_ != IR::Cond::AL && if_terminal->if_ != IR::Cond::NV && reg_alloc.IsGuestNZCVInHostFlags()) {
+        // Branch before cycle accounting clobbers the host flags.
+        Xbyak::Label pass = EmitCondFromHostFlags(if_terminal->if_);
+        EmitAddCycles(block.CycleCount());
+        EmitTerminal(if_terminal->else_, block.Location());
+        code.L(pass);
+        EmitAddCycles(block.CycleCount());
+        EmitTerminal(if_terminal->then_, block.Location());
+    } else {
+        EmitAddCycles(block.CycleCount());
+        EmitX64::EmitTerminal(terminal, block.Location());
+    }
     code.int3();
 
     const size_t size = static_cast<size_t>(code.getCurr() - entrypoint);
+    spill_count += reg_alloc.SpillCount();
+    move_count += reg_alloc.MoveCount();
 
     const A64::LocationDescriptor descriptor{block.Location()};
     const A64::LocationDescriptor end_location{block.EndLocation()};
 
     const auto range = boost::icl::discrete_interval<u64>::closed(descriptor.PC(), end_location.PC() - 1);
     block_ranges.AddRange(range, descriptor);
+    if (nzcv_deferred_in_edx) {
+        // This block relies on its successors overwriting NZCV, so it must be retranslated with them.
+        for (const auto& successor : nzcv_successors) {
+            block_ranges.AddRange(nzcv_overwriting_blocks.at(successor), descriptor);
+        }
+    }
+    if (overwrites_nzcv) {
+        nzcv_overwriting_blocks.insert_or_assign(descriptor, range);
+    }
+    nzcv_deferred_in_edx = false;
 
     return RegisterBlock(descriptor, entrypoint, size);
 }
@@ -135,11 +254,18 @@ A64EmitX64::BlockDescriptor A64EmitX64::Emit(IR::Block& block) {
 void A64EmitX64::ClearCache() {
     EmitX64::ClearCache();
     block_ranges.ClearCache();
+    nzcv_overwriting_blocks.clear();
     ClearFastDispatchTable();
+    spill_count = 0;
+    move_count = 0;
 }
 
 void A64EmitX64::InvalidateCacheRanges(const boost::icl::interval_set<u64>& ranges) {
-    InvalidateBasicBlocks(block_ranges.InvalidateRanges(ranges));
+    const auto locations = block_ranges.InvalidateRanges(ranges);
+    for (const auto& location : locations) {
+        nzcv_overwriting_blocks.erase(location);
+    }
+    InvalidateBasicBlocks(locations);
     ClearFastDispatchTable();
 }
 
@@ -149,6 +275,105 @@ void A64EmitX64::ClearFastDispatchTable() {
     }
 }
 
+bool A64EmitX64::LinksOnlyToNZCVOverwritingBlocks(const IR::Terminal& terminal, const IR::LocationDescriptor& self, bool self_overwrites_nzcv,
+                                                  std::vector<IR::LocationDescriptor>& successors) const {
+    const auto overwrites_nzcv = [&](const IR::LocationDescriptor& next) {
+        if (next == self) {
+            return self_overwrites_nzcv;
+        }
+        if (nzcv_overwriting_blocks.count(next) == 0) {
+            return false;
+        }
+        successors.emplace_back(next);
+        return true;
+    };
+
+    if (const auto* link_block = boost::get<IR::Term::LinkBlock>(&terminal)) {
+        return overwrites_nzcv(link_block->next);
+    }
+    if (const auto* link_block_fast = boost::get<IR::Term::LinkBlockFast>(&terminal)) {
+        return overwrites_nzcv(link_block_fast->next);
+    }
+    if (const auto* if_terminal = boost::get<IR::Term::If>(&terminal)) {
+        return LinksOnlyToNZCVOverwritingBlocks(if_terminal->then_, self, self_overwrites_nzcv, successors)
+            && LinksOnlyToNZCVOverwritingBlocks(if_terminal->else_, self, self_overwrites_nzcv, successors);
+    }
+    if (const auto* check_bit = boost::get<IR::Term::CheckBit>(&terminal)) {
+        return LinksOnlyToNZCVOverwritingBlocks(check_bit->then_, self, self_overwrites_nzcv, successors)
+            && LinksOnlyToNZCVOverwritingBlocks(check_bit->else_, self, self_overwrites_nzcv, successors);
+    }
+    // Every other terminal may return to the dispatcher, which expects NZCV to be up to date.
+    return false;
+}
+
+IR::Inst* A64EmitX64::FindDeferrableSetNZCV(IR::Block& block, bool overwrites_nzcv, std::vector<IR::LocationDescriptor>& successors) const {
+    IR::Inst* last_set = nullptr;
+    for (auto& inst : block) {
+        if (inst.GetOpcode() == IR::Opcode::A64SetNZCV) {
+            last_set = &inst;
+        } else if (inst.ReadsFromCPSR() || inst.CausesCPUException()) {
+            last_set = nullptr;
+        }
+    }
+
+    if (!last_set || !LinksOnlyToNZCVOverwritingBlocks(block.GetTerminal(), block.Location(), overwrites_nzcv, successors)) {
+        successors.clear();
+        return nullptr;
+    }
+    return last_set;
+}
+
+void A64EmitX64::EmitDeferredSetNZCV(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const IR::Terminal terminal = ctx.block.GetTerminal();
+    const auto* if_terminal = boost::get<IR::Term::If>(&terminal);
+    const bool terminal_reads_nzcv = if_terminal && if_terminal->if_ != IR::Cond::AL && if_terminal->if_ != IR::Cond::NV;
+    const bool in_host_flags = args[0].IsInHostFlags();
+
+    if (terminal_reads_nzcv && !in_host_flags) {
+        // The terminal condition is evaluated from memory.
+        EmitA64SetNZCV(ctx, inst);
+        return;
+    }
+
+    // Keep the unpacked value in edx until the terminal, which stores it on paths that return to the dispatcher.
+    ctx.reg_alloc.Use(args[0], HostLoc::RDX);
+    if (in_host_flags) {
+        ctx.reg_alloc.SetGuestNZCVInHostFlags();
+    }
+    nzcv_deferred_in_edx = true;
+}
+
+void A64EmitX64::EmitStoreDeferredNZCV() {
+    code.and_(edx, 0b11000001'00000001);
+    code.imul(edx, edx, 0b00010000'00100001);
+    code.shl(edx, 16);
+    code.and_(edx, 0xF0000000);
+    code.mov(dword[r15 + offsetof(A64JitState, CPSR_nzcv)], edx);
+}
+
+boost::optional<Xbyak::Reg64> A64EmitX64::PinnedRegister(size_t index) const {
+    const auto iter = std::find(conf.pinned_registers.begin(), conf.pinned_registers.end(), index);
+    if (iter == conf.pinned_registers.end()) {
+        return boost::none;
+    }
+    return HostLocToReg64(pinnable_host_locations[iter - conf.pinned_registers.begin()]);
+}
+
+std::vector<HostLoc> A64EmitX64::PinnedHostLocations() const {
+    return {pinnable_host_locations.begin(), pinnable_host_locations.begin() + conf.pinned_registers.size()};
+}
+
+bool A64EmitX64::IsHostCall(const IR::Inst* inst) const {
+    // Memory accesses are the most common host calls, so they are recognised before their first
+    // emission. Without a page table every access goes through the memory callbacks.
+    if (inst->IsMemoryReadOrWrite() && (!conf.page_table || inst->IsExclusiveMemoryRead() || inst->IsExclusiveMemoryWrite())) {
+        return true;
+    }
+    return host_call_opcodes.test(static_cast<size_t>(inst->GetOpcode()));
+}
+
 void A64EmitX64::GenMemory128Accessors() {
     code.align();
     memory_read_128 = code.getCurr<void(*)()>();
@@ -217,6 +442,23 @@ void A64EmitX64::GenFastmemFallbacks() {
         {64, Devirtualize<&A64::UserCallbacks::MemoryWrite64>(conf.callbacks)},
     };
 
+    std::map<size_t, void(*)()> mmio_read_dispatch;
+    std::map<size_t, void(*)()> mmio_write_dispatch;
+    if (conf.mmio_page_table) {
+        for (auto& [bitsize, callback] : read_callbacks) {
+            code.align();
+            mmio_read_dispatch[bitsize] = code.getCurr<void(*)()>();
+            GenMMIODispatch(bitsize, callback, offsetof(A64::MMIOHandler, read), code.ABI_PARAM3);
+            PerfMapRegister(mmio_read_dispatch[bitsize], code.getCurr(), fmt::format("a64_mmio_read_dispatch_{}", bitsize));
+        }
+        for (auto& [bitsize, callback] : write_callbacks) {
+            code.align();
+            mmio_write_dispatch[bitsize] = code.getCurr<void(*)()>();
+            GenMMIODispatch(bitsize, callback, offsetof(A64::MMIOHandler, write), code.ABI_PARAM4);
+            PerfMapRegister(mmio_write_dispatch[bitsize], code.getCurr(), fmt::format("a64_mmio_write_dispatch_{}", bitsize));
+        }
+    }
+
     for (int vaddr_idx : idxes) {
         if (vaddr_idx == 4 || vaddr_idx == 15) {
             continue;
@@ -262,7 +504,11 @@ void A64EmitX64::GenFastmemFallbacks() {
                 if (vaddr_idx != code.ABI_PARAM2.getIdx()) {
                     code.mov(code.ABI_PARAM2, Xbyak::Reg64{vaddr_idx});
                 }
-                callback.EmitCall(code);
+                if (conf.mmio_page_table) {
+                    code.call(mmio_read_dispatch[bitsize]);
+                } else {
+                    callback.EmitCall(code);
+                }
                 if (value_idx != code.ABI_RETURN.getIdx()) {
                     code.mov(Xbyak::Reg64{value_idx}, code.ABI_RETURN);
                 }
@@ -290,7 +536,11 @@ void A64EmitX64::GenFastmemFallbacks() {
                         code.mov(code.ABI_PARAM2, Xbyak::Reg64{vaddr_idx});
                     }
                 }
-                callback.EmitCall(code);
+                if (conf.mmio_page_table) {
+                    code.call(mmio_write_dispatch[bitsize]);
+                } else {
+                    callback.EmitCall(code);
+                }
                 ABI_PopCallerSaveRegistersAndAdjustStack(code);
                 code.ret();
                 PerfMapRegister(write_fallbacks[std::make_tuple(bitsize, vaddr_idx, value_idx)], code.getCurr(), fmt::format("a64_write_fallback_{}", bitsize));
@@ -299,24 +549,86 @@ void A64EmitX64::GenFastmemFallbacks() {
     }
 }
 
+// Values narrower than 64 bits may have garbage in the upper bits of their register. The memory
+// callbacks take arguments of the access size, but MMIO handlers take the value as a u64.
+static void EmitZeroExtendMMIOValue(BlockOfCode& code, size_t bitsize, Xbyak::Reg64 value) {
+    switch (bitsize) {
+    case 8:
+        code.movzx(value.cvt32(), value.cvt8());
+        break;
+    case 16:
+        code.movzx(value.cvt32(), value.cvt16());
+        break;
+    case 32:
+        code.mov(value.cvt32(), value.cvt32());
+        break;
+    }
+}
+
+void A64EmitX64::GenMMIODispatch(size_t bitsize, const Callback& callback, size_t handler_offset, Xbyak::Reg64 bytesize_param) {
+    // Called with the callback's arguments already in place. Tail-calls the MMIO handler of the
+    // page containing the address in ABI_PARAM2 if there is one, otherwise calls the callback.
+    constexpr size_t page_bits = 12;
+    const size_t valid_page_index_bits = conf.page_table_address_space_bits - page_bits;
+    const size_t unused_top_bits = 64 - conf.page_table_address_space_bits;
+
+    Xbyak::Label not_mmio;
+
+    code.mov(rax, code.ABI_PARAM2);
+    if (unused_top_bits == 0) {
+        code.shr(rax, int(page_bits));
+    } else if (conf.silently_mirror_page_table) {
+        code.shl(rax, int(unused_top_bits));
+        code.shr(rax, int(unused_top_bits + page_bits));
+    } else {
+        code.shr(rax, int(page_bits));
+        code.mov(r11, u64(1) << valid_page_index_bits);
+        code.cmp(rax, r11);
+        code.jae(not_mmio);
+    }
+    code.mov(r11, reinterpret_cast<u64>(conf.mmio_page_table));
+    code.mov(rax, qword[r11 + rax * sizeof(void*)]);
+    code.test(rax, rax);
+    code.jz(not_mmio);
+    code.mov(code.ABI_PARAM1, qword[rax + offsetof(A64::MMIOHandler, context)]);
+    if (handler_offset == offsetof(A64::MMIOHandler, write)) {
+        EmitZeroExtendMMIOValue(code, bitsize, code.ABI_PARAM3);
+    }
+    code.mov(bytesize_param, bitsize / 8);
+    code.jmp(qword[rax + handler_offset]);
+
+    code.L(not_mmio);
+    code.sub(rsp, 8 + ABI_SHADOW_SPACE);
+    callback.EmitCall(code);
+    code.add(rsp, 8 + ABI_SHADOW_SPACE);
+    code.ret();
+}
+
 void A64EmitX64::GenTerminalHandlers() {
-    // PC ends up in rbp, location_descriptor ends up in rbx
+    // PC ends up in rdx, location_descriptor ends up in rbx
     const auto calculate_location_descriptor = [this] {
         // This calculation has to match up with A64::LocationDescriptor::UniqueHash
         // TODO: Optimization is available here based on known state of FPSCR_mode and CPSR_et.
-        code.mov(rbp, qword[r15 + offsetof(A64JitState, pc)]);
+        code.mov(rdx, qword[r15 + offsetof(A64JitState, pc)]);
         code.mov(rcx, A64::LocationDescriptor::PC_MASK);
-        code.and_(rcx, rbp);
+        code.and_(rcx, rdx);
         code.mov(ebx, dword[r15 + offsetof(A64JitState, fpcr)]);
         code.and_(ebx, A64::LocationDescriptor::FPCR_MASK);
         code.shl(ebx, 37);
         code.or_(rbx, rcx);
     };
 
+    // Indirect branches do not pass through a block link, so a pending halt request is checked here.
+    const auto check_halt = [this] {
+        code.cmp(dword[r15 + offsetof(A64JitState, halt_requested)], 0);
+        code.jne(code.GetForceReturnFromRunCodeAddress());
+    };
+
     Xbyak::Label fast_dispatch_cache_miss, rsb_cache_miss;
 
     code.align();
     terminal_handler_pop_rsb_hint = code.getCurr<const void*>();
+    check_halt();
     calculate_location_descriptor();
     code.mov(eax, dword[r15 + offsetof(A64JitState, rsb_ptr)]);
     code.sub(eax, 1);
@@ -335,21 +647,27 @@ void A64EmitX64::GenTerminalHandlers() {
     if (conf.enable_fast_dispatch) {
         code.align();
         terminal_handler_fast_dispatch_hint = code.getCurr<const void*>();
+        check_halt();
         calculate_location_descriptor();
         code.L(rsb_cache_miss);
-        code.mov(r12, reinterpret_cast<u64>(fast_dispatch_table.data()));
+        code.mov(rcx, reinterpret_cast<u64>(fast_dispatch_table.data()));
         if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE42)) {
-            code.crc32(rbp, r12d);
+            code.crc32(rdx, ecx);
         }
-        code.and_(ebp, fast_dispatch_table_mask);
-        code.lea(rbp, ptr[r12 + rbp]);
-        code.cmp(rbx, qword[rbp + offsetof(FastDispatchEntry, location_descriptor)]);
+        code.and_(edx, fast_dispatch_table_mask);
+        code.lea(rdx, ptr[rcx + rdx]);
+        code.cmp(rbx, qword[rdx + offsetof(FastDispatchEntry, location_descriptor)]);
         code.jne(fast_dispatch_cache_miss);
-        code.jmp(ptr[rbp + offsetof(FastDispatchEntry, code_ptr)]);
+        code.jmp(ptr[rdx + offsetof(FastDispatchEntry, code_ptr)]);
         code.L(fast_dispatch_cache_miss);
-        code.mov(qword[rbp + offsetof(FastDispatchEntry, location_descriptor)], rbx);
+        code.mov(qword[rdx + offsetof(FastDispatchEntry, location_descriptor)], rbx);
+        // The entry pointer is kept on the stack rather than in a callee-saved register, as those may be pinned.
+        code.push(rdx);
+        code.sub(rsp, 8);
         code.LookupBlock();
-        code.mov(ptr[rbp + offsetof(FastDispatchEntry, code_ptr)], rax);
+        code.add(rsp, 8);
+        code.pop(rdx);
+        code.mov(ptr[rdx + offsetof(FastDispatchEntry, code_ptr)], rax);
         code.jmp(rax);
         PerfMapRegister(terminal_handler_fast_dispatch_hint, code.getCurr(), "a64_terminal_handler_fast_dispatch_hint");
     }
@@ -371,19 +689,39 @@ void A64EmitX64::EmitA64GetCFlag(A64EmitContext& ctx, IR::Inst* inst) {
 
 void A64EmitX64::EmitA64SetNZCV(A64EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    // If the host flags hold this value, pack it without modifying them so that later
+    // conditional selects and branches can use the host flags directly.
+    if (args[0].IsInHostFlags() && code.DoesCpuSupport(Xbyak::util::Cpu::tBMI2)) {
+        Xbyak::Reg32 to_store = ctx.reg_alloc.UseScratchGpr(args[0]).cvt32();
+        Xbyak::Reg32 tmp = ctx.reg_alloc.ScratchGpr().cvt32();
+        code.mov(tmp, 0b11000001'00000001);
+        code.pext(to_store, to_store, tmp);
+        code.mov(tmp, 28);
+        code.shlx(to_store, to_store, tmp);
+        code.mov(dword[r15 + offsetof(A64JitState, CPSR_nzcv)], to_store);
+        ctx.reg_alloc.SetGuestNZCVInHostFlags();
+        return;
+    }
+
     Xbyak::Reg32 to_store = ctx.reg_alloc.UseScratchGpr(args[0]).cvt32();
     code.and_(to_store, 0b11000001'00000001);
     code.imul(to_store, to_store, 0b00010000'00100001);
     code.shl(to_store, 16);
     code.and_(to_store, 0xF0000000);
     code.mov(dword[r15 + offsetof(A64JitState, CPSR_nzcv)], to_store);
+    ctx.reg_alloc.ClobberHostFlags();
 }
 
 void A64EmitX64::EmitA64GetW(A64EmitContext& ctx, IR::Inst* inst) {
     A64::Reg reg = inst->GetArg(0).GetA64RegRef();
 
     Xbyak::Reg32 result = ctx.reg_alloc.ScratchGpr().cvt32();
-    code.mov(result, dword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)]);
+    if (const auto pinned = PinnedRegister(static_cast<size_t>(reg))) {
+        code.mov(result, pinned->cvt32());
+    } else {
+        code.mov(result, dword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)]);
+    }
     ctx.reg_alloc.DefineValue(inst, result);
 }
 
@@ -391,7 +729,11 @@ void A64EmitX64::EmitA64GetX(A64EmitContext& ctx, IR::Inst* inst) {
     A64::Reg reg = inst->GetArg(0).GetA64RegRef();
 
     Xbyak::Reg64 result = ctx.reg_alloc.ScratchGpr();
-    code.mov(result, qword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)]);
+    if (const auto pinned = PinnedRegister(static_cast<size_t>(reg))) {
+        code.mov(result, *pinned);
+    } else {
+        code.mov(result, qword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)]);
+    }
     ctx.reg_alloc.DefineValue(inst, result);
 }
 
@@ -424,7 +766,11 @@ void A64EmitX64::EmitA64GetQ(A64EmitContext& ctx, IR::Inst* inst) {
 
 void A64EmitX64::EmitA64GetSP(A64EmitContext& ctx, IR::Inst* inst) {
     Xbyak::Reg64 result = ctx.reg_alloc.ScratchGpr();
-    code.mov(result, qword[r15 + offsetof(A64JitState, sp)]);
+    if (const auto pinned = PinnedRegister(31)) {
+        code.mov(result, *pinned);
+    } else {
+        code.mov(result, qword[r15 + offsetof(A64JitState, sp)]);
+    }
     ctx.reg_alloc.DefineValue(inst, result);
 }
 
@@ -445,9 +791,29 @@ void A64EmitX64::EmitA64GetFPSR(A64EmitContext& ctx, IR::Inst* inst) {
     code.CallFunction(GetFPSRImpl);
 }
 
+void A64EmitX64::EmitSetPinnedRegister(A64EmitContext& ctx, Xbyak::Reg64 pinned, Argument& arg) {
+    if (arg.IsImmediate()) {
+        code.mov(pinned, arg.GetImmediateU64());
+    } else if (arg.IsInXmm()) {
+        code.movq(pinned, ctx.reg_alloc.UseXmm(arg));
+    } else {
+        code.mov(pinned, ctx.reg_alloc.UseGpr(arg));
+    }
+}
+
 void A64EmitX64::EmitA64SetW(A64EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
     A64::Reg reg = inst->GetArg(0).GetA64RegRef();
+    if (const auto pinned = PinnedRegister(static_cast<size_t>(reg))) {
+        // Writes to 32-bit registers zero the upper half.
+        if (args[1].IsImmediate()) {
+            code.mov(pinned->cvt32(), args[1].GetImmediateU32());
+        } else {
+            code.mov(pinned->cvt32(), ctx.reg_alloc.UseGpr(args[1]).cvt32());
+        }
+        return;
+    }
+
     auto addr = qword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)];
     if (args[1].FitsInImmediateS32()) {
         code.mov(addr, args[1].GetImmediateS32());
@@ -462,6 +828,11 @@ void A64EmitX64::EmitA64SetW(A64EmitContext& ctx, IR::Inst* inst) {
 void A64EmitX64::EmitA64SetX(A64EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
     A64::Reg reg = inst->GetArg(0).GetA64RegRef();
+    if (const auto pinned = PinnedRegister(static_cast<size_t>(reg))) {
+        EmitSetPinnedRegister(ctx, *pinned, args[1]);
+        return;
+    }
+
     auto addr = qword[r15 + offsetof(A64JitState, reg) + sizeof(u64) * static_cast<size_t>(reg)];
     if (args[1].FitsInImmediateS32()) {
         code.mov(addr, args[1].GetImmediateS32());
@@ -508,6 +879,11 @@ void A64EmitX64::EmitA64SetQ(A64EmitContext& ctx, IR::Inst* inst) {
 
 void A64EmitX64::EmitA64SetSP(A64EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    if (const auto pinned = PinnedRegister(31)) {
+        EmitSetPinnedRegister(ctx, *pinned, args[0]);
+        return;
+    }
+
     auto addr = qword[r15 + offsetof(A64JitState, sp)];
     if (args[0].FitsInImmediateS32()) {
         code.mov(addr, args[0].GetImmediateS32());
@@ -605,6 +981,95 @@ void A64EmitX64::EmitA64DataCacheOperationRaised(A64EmitContext& ctx, IR::Inst*
     Devirtualize<&A64::UserCallbacks::DataCacheOperationRaised>(conf.callbacks).EmitCall(code);
 }
 
+// RegAlloc::HostCall cannot be used here: it spills and moves registers at the point of emission and
+// records that state for the rest of the block, but far code is only reached on some paths. Instead
+// every caller-saved register is preserved around the call, which leaves the allocator's state valid
+// when far code jumps back into the block.
+void A64EmitX64::EmitExceptionRaisedFromFarCode(u64 pc, A64::Exception exception) {
+    // The ABI helpers expect the stack to be misaligned by a return address.
+    code.sub(rsp, 8);
+    ABI_PushCallerSaveRegistersAndAdjustStack(code);
+    Devirtualize<&A64::UserCallbacks::ExceptionRaised>(conf.callbacks).EmitCall(code,
+        [&](RegList param) {
+            code.mov(param[0], pc);
+            code.mov(param[1], static_cast<u64>(exception));
+        });
+    ABI_PopCallerSaveRegistersAndAdjustStack(code);
+    code.add(rsp, 8);
+}
+
+void A64EmitX64::EmitA64WaitForEvent(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    ASSERT(args[0].IsImmediate());
+    const u64 pc = args[0].GetImmediateU64();
+    const Xbyak::Reg64 ptr = ctx.reg_alloc.ScratchGpr();
+    const Xbyak::Reg32 was_set = ctx.reg_alloc.ScratchGpr().cvt32();
+
+    const auto event_register = reinterpret_cast<u64>(conf.global_monitor->GetEventRegisterPointer(conf.processor_id));
+    const auto waiting_for_event = reinterpret_cast<u64>(conf.global_monitor->GetWaitingForEventPointer());
+
+    Xbyak::Label maybe_wait, end;
+
+    code.mov(ptr, event_register);
+    code.xor_(was_set, was_set);
+    code.xchg(byte[ptr], was_set.cvt8());
+    code.test(was_set, was_set);
+    code.jz(maybe_wait, code.T_NEAR);
+    code.L(end);
+
+    code.SwitchToFarCode();
+    code.L(maybe_wait);
+    // Announce the wait before checking the event register again: a concurrent SEV either sets the
+    // register before we check it, or observes the announcement and reports itself.
+    code.mov(ptr, waiting_for_event);
+    code.mov(was_set, 1);
+    code.xchg(byte[ptr], was_set.cvt8());
+    code.mov(ptr, event_register);
+    code.xor_(was_set, was_set);
+    code.xchg(byte[ptr], was_set.cvt8());
+    code.test(was_set, was_set);
+    code.jnz(end, code.T_NEAR);
+    EmitExceptionRaisedFromFarCode(pc, A64::Exception::WaitForEvent);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+void A64EmitX64::EmitA64SendEvent(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    ASSERT(args[0].IsImmediate());
+    const u64 pc = args[0].GetImmediateU64();
+    const Xbyak::Reg64 ptr = ctx.reg_alloc.ScratchGpr();
+
+    const auto first_event_register = reinterpret_cast<u64>(conf.global_monitor->GetEventRegisterPointer(0));
+    const auto waiting_for_event = reinterpret_cast<u64>(conf.global_monitor->GetWaitingForEventPointer());
+
+    Xbyak::Label report, end;
+
+    code.mov(ptr, first_event_register);
+    for (size_t i = 0; i < conf.global_monitor->GetProcessorCount(); i++) {
+        const auto offset = static_cast<u32>(reinterpret_cast<u64>(conf.global_monitor->GetEventRegisterPointer(i)) - first_event_register);
+        code.mov(byte[ptr + offset], 1);
+    }
+    code.mfence();
+    code.mov(ptr, waiting_for_event);
+    code.cmp(byte[ptr], 0);
+    code.jne(report, code.T_NEAR);
+    code.L(end);
+
+    code.SwitchToFarCode();
+    code.L(report);
+    code.mov(byte[ptr], 0);
+    EmitExceptionRaisedFromFarCode(pc, A64::Exception::SendEvent);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+void A64EmitX64::EmitA64SendEventLocal(A64EmitContext& ctx, IR::Inst*) {
+    const Xbyak::Reg64 ptr = ctx.reg_alloc.ScratchGpr();
+    code.mov(ptr, reinterpret_cast<u64>(conf.global_monitor->GetEventRegisterPointer(conf.processor_id)));
+    code.mov(byte[ptr], 1);
+}
+
 void A64EmitX64::EmitA64DataSynchronizationBarrier(A64EmitContext&, IR::Inst*) {
     code.mfence();
 }
@@ -684,10 +1149,15 @@ void A64EmitX64::EmitA64ClearExclusive(A64EmitContext&, IR::Inst*) {
 
 void A64EmitX64::EmitA64SetExclusive(A64EmitContext& ctx, IR::Inst* inst) {
     if (conf.global_monitor) {
+        // Even with inline_exclusive_access, only the store side is done inline: marking the
+        // global monitor still takes its lock through this call.
         auto args = ctx.reg_alloc.GetArgumentInfo(inst);
         ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1]);
 
         code.mov(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(1));
+        if (conf.page_table && conf.inline_exclusive_access) {
+            code.mov(qword[r15 + offsetof(A64JitState, exclusive_address)], code.ABI_PARAM2);
+        }
         code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
         code.CallFunction(static_cast<void(*)(A64::UserConfig&, u64, u8)>(
             [](A64::UserConfig& conf, u64 vaddr, u8 size) {
@@ -706,15 +1176,12 @@ void A64EmitX64::EmitA64SetExclusive(A64EmitContext& ctx, IR::Inst* inst) {
     code.mov(qword[r15 + offsetof(A64JitState, exclusive_address)], address);
 }
 
-static Xbyak::RegExp EmitVAddrLookup(BlockOfCode& code, A64EmitContext& ctx, Xbyak::Label& abort, Xbyak::Reg64 vaddr, boost::optional<Xbyak::Reg64> arg_scratch = {}) {
+static void EmitPageTableWalk(BlockOfCode& code, A64EmitContext& ctx, Xbyak::Label& abort, Xbyak::Reg64 vaddr, Xbyak::Reg64 page, Xbyak::Reg64 tmp) {
     constexpr size_t page_bits = 12;
-    constexpr size_t page_size = 1 << page_bits;
     const size_t valid_page_index_bits = ctx.conf.page_table_address_space_bits - page_bits;
     const size_t unused_top_bits = 64 - ctx.conf.page_table_address_space_bits;
 
-    Xbyak::Reg64 page_table = arg_scratch.value_or_eval([&]{ return ctx.reg_alloc.ScratchGpr(); });
-    Xbyak::Reg64 tmp = ctx.reg_alloc.ScratchGpr();
-    code.mov(page_table, reinterpret_cast<u64>(ctx.conf.page_table));
+    code.mov(page, reinterpret_cast<u64>(ctx.conf.page_table));
     code.mov(tmp, vaddr);
     if (unused_top_bits == 0) {
         code.shr(tmp, int(page_bits));
@@ -732,18 +1199,156 @@ static Xbyak::RegExp EmitVAddrLookup(BlockOfCode& code, A64EmitContext& ctx, Xby
         code.test(tmp, u32(-(1 << valid_page_index_bits)));
         code.jnz(abort, code.T_NEAR);
     }
-    code.mov(page_table, qword[page_table + tmp * sizeof(void*)]);
-    code.test(page_table, page_table);
+    code.mov(page, qword[page + tmp * sizeof(void*)]);
+    code.test(page, page);
     code.jz(abort, code.T_NEAR);
+}
+
+struct VAddrLookupScratch {
+    Xbyak::Reg64 page;
+    Xbyak::Reg64 tmp;
+    boost::optional<Xbyak::Reg64> entry;
+};
+
+// Allocates the registers EmitVAddrLookup needs, using arg_scratch (if provided) to hold the page.
+// This must happen before any branches are emitted, as allocation may spill.
+static VAddrLookupScratch AllocateVAddrLookupScratch(A64EmitContext& ctx, boost::optional<Xbyak::Reg64> arg_scratch = {}) {
+    VAddrLookupScratch scratch{arg_scratch.value_or_eval([&]{ return ctx.reg_alloc.ScratchGpr(); }), ctx.reg_alloc.ScratchGpr(), boost::none};
+    if (ctx.conf.enable_tlb) {
+        scratch.entry = ctx.reg_alloc.ScratchGpr();
+    }
+    return scratch;
+}
+
+static Xbyak::RegExp EmitVAddrLookup(BlockOfCode& code, A64EmitContext& ctx, Xbyak::Label& abort, Xbyak::Reg64 vaddr, const VAddrLookupScratch& scratch) {
+    constexpr size_t page_bits = 12;
+    constexpr size_t page_size = 1 << page_bits;
+
+    const Xbyak::Reg64 page = scratch.page;
+    const Xbyak::Reg64 tmp = scratch.tmp;
+
+    if (ctx.conf.enable_tlb) {
+        // The TLB is direct-mapped and indexed by the low bits of the virtual page number.
+        // Misses walk the page table in far code and refill the entry.
+        constexpr size_t offsetof_tlb_vpage = offsetof(A64JitState, tlb) + offsetof(A64JitState::TLBEntry, vpage);
+        constexpr size_t offsetof_tlb_host_page = offsetof(A64JitState, tlb) + offsetof(A64JitState::TLBEntry, host_page);
+
+        const Xbyak::Reg64 entry = *scratch.entry;
+        Xbyak::Label tlb_miss, tlb_hit;
+
+        code.mov(tmp, vaddr);
+        code.shr(tmp, int(page_bits));
+        code.mov(entry.cvt32(), tmp.cvt32());
+        code.and_(entry.cvt32(), u32(A64JitState::TLBIndexMask));
+        code.shl(entry.cvt32(), 4);
+        code.cmp(tmp, qword[r15 + entry + offsetof_tlb_vpage]);
+        code.jne(tlb_miss, code.T_NEAR);
+        code.mov(page, qword[r15 + entry + offsetof_tlb_host_page]);
+        code.L(tlb_hit);
+
+        code.SwitchToFarCode();
+        code.L(tlb_miss);
+        EmitPageTableWalk(code, ctx, abort, vaddr, page, tmp);
+        code.mov(tmp, vaddr);
+        code.shr(tmp, int(page_bits));
+        code.mov(qword[r15 + entry + offsetof_tlb_vpage], tmp);
+        code.mov(qword[r15 + entry + offsetof_tlb_host_page], page);
+        code.jmp(tlb_hit, code.T_NEAR);
+        code.SwitchToNearCode();
+    } else {
+        EmitPageTableWalk(code, ctx, abort, vaddr, page, tmp);
+    }
+
     code.mov(tmp, vaddr);
     code.and_(tmp, static_cast<u32>(page_size - 1));
-    return page_table + tmp;
+    return page + tmp;
+}
+
+static Xbyak::RegExp EmitVAddrLookup(BlockOfCode& code, A64EmitContext& ctx, Xbyak::Label& abort, Xbyak::Reg64 vaddr, boost::optional<Xbyak::Reg64> arg_scratch = {}) {
+    return EmitVAddrLookup(code, ctx, abort, vaddr, AllocateVAddrLookupScratch(ctx, arg_scratch));
+}
+
+static const A64::MMIOHandler* LookupMMIOHandler(const A64::UserConfig& conf, u64 vaddr) {
+    constexpr size_t page_bits = 12;
+    const size_t unused_top_bits = 64 - conf.page_table_address_space_bits;
+
+    if (!conf.mmio_page_table) {
+        return nullptr;
+    }
+
+    u64 page_index = vaddr >> page_bits;
+    if (unused_top_bits != 0) {
+        if (conf.silently_mirror_page_table) {
+            page_index = (vaddr << unused_top_bits) >> (unused_top_bits + page_bits);
+        } else if ((page_index >> (conf.page_table_address_space_bits - page_bits)) != 0) {
+            return nullptr;
+        }
+    }
+    return conf.mmio_page_table[page_index];
+}
+
+struct DirtyPageScratch {
+    Xbyak::Reg64 bitmap;
+    Xbyak::Reg64 index;
+    Xbyak::Reg64 mask;
+};
+
+// Allocates the registers EmitMarkPageDirty needs, if the dirty page bitmap is enabled.
+// This must happen before any branches are emitted, as allocation may spill.
+static boost::optional<DirtyPageScratch> AllocateDirtyPageScratch(A64EmitContext& ctx) {
+    if (!ctx.conf.dirty_page_bitmap) {
+        return boost::none;
+    }
+    return DirtyPageScratch{ctx.reg_alloc.ScratchGpr(), ctx.reg_alloc.ScratchGpr(), ctx.reg_alloc.ScratchGpr()};
+}
+
+static void EmitMarkPageDirty(BlockOfCode& code, A64EmitContext& ctx, Xbyak::Reg64 vaddr, const boost::optional<DirtyPageScratch>& scratch) {
+    if (!scratch) {
+        return;
+    }
+
+    constexpr size_t page_bits = 12;
+    const size_t unused_top_bits = 64 - ctx.conf.page_table_address_space_bits;
+    const Xbyak::Reg64 bitmap = scratch->bitmap;
+    const Xbyak::Reg64 index = scratch->index;
+    const Xbyak::Reg64 mask = scratch->mask;
+
+    Xbyak::Label already_dirty;
+
+    code.mov(index, vaddr);
+    if (unused_top_bits == 0) {
+        code.shr(index, int(page_bits));
+    } else {
+        code.shl(index, int(unused_top_bits));
+        code.shr(index, int(unused_top_bits + page_bits));
+    }
+    code.xor_(mask.cvt32(), mask.cvt32());
+    code.bts(mask, index);
+    code.shr(index, 6);
+    code.mov(bitmap, reinterpret_cast<u64>(ctx.conf.dirty_page_bitmap));
+    // Other threads may be marking pages in the same word, so the bit is set with a locked or.
+    // Usually the page is already dirty, so the locked instruction is skipped if the bit is set.
+    code.test(qword[bitmap + index * 8], mask);
+    code.jnz(already_dirty);
+    code.lock();
+    code.or_(qword[bitmap + index * 8], mask);
+    code.L(already_dirty);
 }
 
 void A64EmitX64::EmitDirectPageTableMemoryRead(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
     Xbyak::Label abort, end;
 
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    if (args[0].IsImmediate()) {
+        if (const auto* handler = LookupMMIOHandler(conf, args[0].GetImmediateU64())) {
+            ctx.reg_alloc.HostCall(inst, {}, args[0]);
+            code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(handler->context));
+            code.mov(code.ABI_PARAM3, bitsize / 8);
+            code.CallFunction(handler->read);
+            return;
+        }
+    }
+
     Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
     Xbyak::Reg64 value = ctx.reg_alloc.ScratchGpr();
 
@@ -777,8 +1382,20 @@ void A64EmitX64::EmitDirectPageTableMemoryWrite(A64EmitContext& ctx, IR::Inst* i
     Xbyak::Label abort, end;
 
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    if (args[0].IsImmediate()) {
+        if (const auto* handler = LookupMMIOHandler(conf, args[0].GetImmediateU64())) {
+            ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1]);
+            EmitZeroExtendMMIOValue(code, bitsize, code.ABI_PARAM3);
+            code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(handler->context));
+            code.mov(code.ABI_PARAM4, bitsize / 8);
+            code.CallFunction(handler->write);
+            return;
+        }
+    }
+
     Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
     Xbyak::Reg64 value = ctx.reg_alloc.UseGpr(args[1]);
+    const auto dirty_scratch = AllocateDirtyPageScratch(ctx);
 
     auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
     switch (bitsize) {
@@ -795,6 +1412,7 @@ void A64EmitX64::EmitDirectPageTableMemoryWrite(A64EmitContext& ctx, IR::Inst* i
         code.mov(qword[dest_ptr], value);
         break;
     }
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
     code.L(end);
 
     code.SwitchToFarCode();
@@ -927,9 +1545,11 @@ void A64EmitX64::EmitA64WriteMemory128(A64EmitContext& ctx, IR::Inst* inst) {
         auto args = ctx.reg_alloc.GetArgumentInfo(inst);
         Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
         Xbyak::Xmm value = ctx.reg_alloc.UseXmm(args[1]);
+        const auto dirty_scratch = AllocateDirtyPageScratch(ctx);
 
         auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
         code.movups(xword[dest_ptr], value);
+        EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
         code.L(end);
 
         code.SwitchToFarCode();
@@ -948,77 +1568,774 @@ void A64EmitX64::EmitA64WriteMemory128(A64EmitContext& ctx, IR::Inst* inst) {
     code.CallFunction(memory_write_128);
 }
 
-void A64EmitX64::EmitExclusiveWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
-    if (conf.global_monitor) {
-        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+static void EmitCrossPageCheck(BlockOfCode& code, Xbyak::Label& abort, Xbyak::Reg64 vaddr, Xbyak::Reg64 tmp, size_t bytesize) {
+    constexpr size_t page_size = 1 << 12;
 
-        if (bitsize != 128) {
-            ctx.reg_alloc.HostCall(inst, {}, args[0], args[1]);
-        } else {
-            ctx.reg_alloc.Use(args[0], ABI_PARAM2);
-            ctx.reg_alloc.Use(args[1], HostLoc::XMM1);
-            ctx.reg_alloc.EndOfAllocScope();
-            ctx.reg_alloc.HostCall(inst);
-        }
+    code.mov(tmp.cvt32(), vaddr.cvt32());
+    code.and_(tmp.cvt32(), static_cast<u32>(page_size - 1));
+    code.cmp(tmp.cvt32(), static_cast<u32>(page_size - bytesize));
+    code.ja(abort, code.T_NEAR);
+}
 
-        Xbyak::Label end;
+void A64EmitX64::EmitA64ReadMemory32x2(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
 
-        code.mov(code.ABI_RETURN, u32(1));
-        code.cmp(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
-        code.je(end);
-        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
-        switch (bitsize) {
-        case 8:
-            code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u8)>(
-                [](A64::UserConfig& conf, u64 vaddr, u8 value) -> u32 {
-                    return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 1, [&]{
-                        conf.callbacks->MemoryWrite8(vaddr, value);
-                    }) ? 0 : 1;
-                }
-            ));
-            break;
-        case 16:
-            code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u16)>(
-                [](A64::UserConfig& conf, u64 vaddr, u16 value) -> u32 {
-                    return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 2, [&]{
-                        conf.callbacks->MemoryWrite16(vaddr, value);
-                    }) ? 0 : 1;
-                }
-            ));
-            break;
-        case 32:
-            code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u32)>(
-                [](A64::UserConfig& conf, u64 vaddr, u32 value) -> u32 {
-                    return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 4, [&]{
-                        conf.callbacks->MemoryWrite32(vaddr, value);
-                    }) ? 0 : 1;
-                }
-            ));
-            break;
-        case 64:
-            code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u64)>(
-                [](A64::UserConfig& conf, u64 vaddr, u64 value) -> u32 {
-                    return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 8, [&]{
-                        conf.callbacks->MemoryWrite64(vaddr, value);
-                    }) ? 0 : 1;
-                }
-            ));
-            break;
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(inst, {}, args[0]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(conf.callbacks));
+        code.CallFunction(static_cast<u64(*)(A64::UserCallbacks*, u64)>(
+            [](A64::UserCallbacks* cb, u64 vaddr) -> u64 {
+                const u64 lo = cb->MemoryRead32(vaddr);
+                const u64 hi = cb->MemoryRead32(vaddr + 4);
+                return lo | (hi << 32);
+            }
+        ));
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Reg64 value = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 tmp = ctx.reg_alloc.ScratchGpr();
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx, value);
+
+    EmitCrossPageCheck(code, abort, vaddr, tmp, 8);
+    auto src_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.mov(value, qword[src_ptr]);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.call(read_fallbacks[std::make_tuple(32, vaddr.getIdx(), value.getIdx())]);
+    code.lea(tmp, ptr[vaddr + 4]);
+    code.call(read_fallbacks[std::make_tuple(32, tmp.getIdx(), tmp.getIdx())]);
+    code.mov(value.cvt32(), value.cvt32());
+    code.shl(tmp, 32);
+    code.or_(value, tmp);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, value);
+}
+
+template <size_t bitsize>
+static u64 ReadMemoryCallback(A64::UserCallbacks* cb, u64 vaddr) {
+    if constexpr (bitsize == 8) {
+        return cb->MemoryRead8(vaddr);
+    } else if constexpr (bitsize == 16) {
+        return cb->MemoryRead16(vaddr);
+    } else if constexpr (bitsize == 32) {
+        return cb->MemoryRead32(vaddr);
+    } else {
+        return cb->MemoryRead64(vaddr);
+    }
+}
+
+template <size_t bitsize>
+static void WriteMemoryCallback(A64::UserCallbacks* cb, u64 vaddr, u64 value) {
+    if constexpr (bitsize == 8) {
+        cb->MemoryWrite8(vaddr, static_cast<u8>(value));
+    } else if constexpr (bitsize == 16) {
+        cb->MemoryWrite16(vaddr, static_cast<u16>(value));
+    } else if constexpr (bitsize == 32) {
+        cb->MemoryWrite32(vaddr, static_cast<u32>(value));
+    } else {
+        cb->MemoryWrite64(vaddr, value);
+    }
+}
+
+template <typename FunctionPointer>
+static FunctionPointer SelectBySize(size_t bitsize, FunctionPointer fn8, FunctionPointer fn16, FunctionPointer fn32, FunctionPointer fn64) {
+    switch (bitsize) {
+    case 8:
+        return fn8;
+    case 16:
+        return fn16;
+    case 32:
+        return fn32;
+    case 64:
+        return fn64;
+    default:
+        UNREACHABLE();
+        return nullptr;
+    }
+}
+
+// The element accesses of a 64x2 access which falls back are made at the element size given by
+// the instruction, so that the memory callbacks and MMIO handlers see the same accesses as they
+// would for the individual elements.
+template <size_t esize>
+static void ReadMemory64x2Fallback(A64::UserConfig& conf, u64 vaddr, A64::Vector& result) {
+    constexpr size_t ebytes = esize / 8;
+    for (size_t i = 0; i < 16; i += ebytes) {
+        const u64 element_vaddr = vaddr + i;
+        const A64::MMIOHandler* handler = conf.page_table ? LookupMMIOHandler(conf, element_vaddr) : nullptr;
+        const u64 value = handler ? handler->read(handler->context, element_vaddr, ebytes) : ReadMemoryCallback<esize>(conf.callbacks, element_vaddr);
+        std::memcpy(reinterpret_cast<u8*>(result.data()) + i, &value, ebytes);
+    }
+}
+
+template <size_t esize>
+static void WriteMemory64x2Fallback(A64::UserConfig& conf, u64 vaddr, const A64::Vector& value) {
+    constexpr size_t ebytes = esize / 8;
+    for (size_t i = 0; i < 16; i += ebytes) {
+        const u64 element_vaddr = vaddr + i;
+        u64 element = 0;
+        std::memcpy(&element, reinterpret_cast<const u8*>(value.data()) + i, ebytes);
+        if (const A64::MMIOHandler* handler = conf.page_table ? LookupMMIOHandler(conf, element_vaddr) : nullptr) {
+            handler->write(handler->context, element_vaddr, element, ebytes);
+        } else {
+            WriteMemoryCallback<esize>(conf.callbacks, element_vaddr, element);
+        }
+    }
+}
+
+void A64EmitX64::EmitA64ReadMemory64x2(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const size_t esize = args[1].GetImmediateU8();
+    const auto fallback = SelectBySize(esize, &ReadMemory64x2Fallback<8>, &ReadMemory64x2Fallback<16>,
+                                       &ReadMemory64x2Fallback<32>, &ReadMemory64x2Fallback<64>);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.CallFunction(fallback);
+        code.movups(xmm1, xword[rsp + ABI_SHADOW_SPACE]);
+        code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        ctx.reg_alloc.DefineValue(inst, xmm1);
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Xmm value = ctx.reg_alloc.ScratchXmm();
+    Xbyak::Reg64 lo = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 hi = ctx.reg_alloc.ScratchGpr();
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx);
+
+    EmitCrossPageCheck(code, abort, vaddr, hi, 16);
+    auto src_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.movups(value, xword[src_ptr]);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into elements.
+    code.SwitchToFarCode();
+    code.L(abort);
+    if (esize == 64) {
+        code.call(read_fallbacks[std::make_tuple(64, vaddr.getIdx(), lo.getIdx())]);
+        code.lea(hi, ptr[vaddr + 8]);
+        code.call(read_fallbacks[std::make_tuple(64, hi.getIdx(), hi.getIdx())]);
+        code.movq(value, lo);
+        code.sub(rsp, 8);
+        code.mov(qword[rsp], hi);
+        code.movhps(value, qword[rsp]);
+        code.add(rsp, 8);
+    } else {
+        // The ABI helpers expect the stack to be misaligned by a return address.
+        code.sub(rsp, 8);
+        ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(value.getIdx()));
+        code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+        code.mov(code.ABI_PARAM2, vaddr);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.CallFunction(fallback);
+        code.movaps(value, xword[rsp + ABI_SHADOW_SPACE]);
+        code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(value.getIdx()));
+        code.add(rsp, 8);
+    }
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, value);
+}
+
+void A64EmitX64::EmitA64ReadMemory64Pair(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const auto second_inst = inst->GetAssociatedPseudoOperation(IR::Opcode::GetSecondFromOp);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(conf.callbacks));
+        code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.CallFunction(static_cast<u64(*)(A64::UserCallbacks*, u64, u64&)>(
+            [](A64::UserCallbacks* cb, u64 vaddr, u64& second) -> u64 {
+                const u64 first = cb->MemoryRead64(vaddr);
+                second = cb->MemoryRead64(vaddr + 8);
+                return first;
+            }
+        ));
+        code.mov(code.ABI_PARAM1, qword[rsp + ABI_SHADOW_SPACE]);
+        code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        // Erasing the pseudo-operation changes the use count of inst, so it is defined first.
+        if (second_inst) {
+            ctx.reg_alloc.DefineValue(second_inst, code.ABI_PARAM1);
+            ctx.EraseInstruction(second_inst);
+        }
+        ctx.reg_alloc.DefineValue(inst, code.ABI_RETURN);
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Reg64 first = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 second = ctx.reg_alloc.ScratchGpr();
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx, first);
+
+    EmitCrossPageCheck(code, abort, vaddr, second, 16);
+    auto src_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.mov(second, qword[src_ptr + 8]);
+    code.mov(first, qword[src_ptr]);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.call(read_fallbacks[std::make_tuple(64, vaddr.getIdx(), first.getIdx())]);
+    code.lea(second, ptr[vaddr + 8]);
+    code.call(read_fallbacks[std::make_tuple(64, second.getIdx(), second.getIdx())]);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    if (second_inst) {
+        ctx.reg_alloc.DefineValue(second_inst, second);
+        ctx.EraseInstruction(second_inst);
+    }
+    ctx.reg_alloc.DefineValue(inst, first);
+}
+
+void A64EmitX64::EmitA64WriteMemory32x2(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(conf.callbacks));
+        code.CallFunction(static_cast<void(*)(A64::UserCallbacks*, u64, u64)>(
+            [](A64::UserCallbacks* cb, u64 vaddr, u64 value) {
+                cb->MemoryWrite32(vaddr, static_cast<u32>(value));
+                cb->MemoryWrite32(vaddr + 4, static_cast<u32>(value >> 32));
+            }
+        ));
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Reg64 value = ctx.reg_alloc.UseGpr(args[1]);
+    Xbyak::Reg64 tmp_vaddr = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 tmp_value = ctx.reg_alloc.ScratchGpr();
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        dirty_scratch = DirtyPageScratch{tmp_vaddr, tmp_value, ctx.reg_alloc.ScratchGpr()};
+    }
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx);
+
+    EmitCrossPageCheck(code, abort, vaddr, tmp_vaddr, 8);
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.mov(qword[dest_ptr], value);
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.call(write_fallbacks[std::make_tuple(32, vaddr.getIdx(), value.getIdx())]);
+    code.lea(tmp_vaddr, ptr[vaddr + 4]);
+    code.mov(tmp_value, value);
+    code.shr(tmp_value, 32);
+    code.call(write_fallbacks[std::make_tuple(32, tmp_vaddr.getIdx(), tmp_value.getIdx())]);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+void A64EmitX64::EmitA64WriteMemory64x2(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const size_t esize = args[2].GetImmediateU8();
+    const auto fallback = SelectBySize(esize, &WriteMemory64x2Fallback<8>, &WriteMemory64x2Fallback<16>,
+                                       &WriteMemory64x2Fallback<32>, &WriteMemory64x2Fallback<64>);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.Use(args[0], ABI_PARAM2);
+        ctx.reg_alloc.Use(args[1], HostLoc::XMM1);
+        ctx.reg_alloc.EndOfAllocScope();
+        ctx.reg_alloc.HostCall(nullptr);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.movaps(xword[code.ABI_PARAM3], xmm1);
+        code.CallFunction(fallback);
+        code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Xmm value = ctx.reg_alloc.UseXmm(args[1]);
+    Xbyak::Reg64 tmp_vaddr = ctx.reg_alloc.ScratchGpr();
+    Xbyak::Reg64 tmp_value = ctx.reg_alloc.ScratchGpr();
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        dirty_scratch = DirtyPageScratch{tmp_vaddr, tmp_value, ctx.reg_alloc.ScratchGpr()};
+    }
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx);
+
+    EmitCrossPageCheck(code, abort, vaddr, tmp_vaddr, 16);
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.movups(xword[dest_ptr], value);
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into elements.
+    code.SwitchToFarCode();
+    code.L(abort);
+    if (esize == 64) {
+        code.movq(tmp_value, value);
+        code.call(write_fallbacks[std::make_tuple(64, vaddr.getIdx(), tmp_value.getIdx())]);
+        code.lea(tmp_vaddr, ptr[vaddr + 8]);
+        code.sub(rsp, 8);
+        code.movhps(qword[rsp], value);
+        code.pop(tmp_value);
+        code.call(write_fallbacks[std::make_tuple(64, tmp_vaddr.getIdx(), tmp_value.getIdx())]);
+    } else {
+        // The ABI helpers expect the stack to be misaligned by a return address.
+        code.sub(rsp, 8);
+        ABI_PushCallerSaveRegistersAndAdjustStack(code);
+        code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+        code.movaps(xword[rsp + ABI_SHADOW_SPACE], value);
+        code.mov(code.ABI_PARAM2, vaddr);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.CallFunction(fallback);
+        code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        ABI_PopCallerSaveRegistersAndAdjustStack(code);
+        code.add(rsp, 8);
+    }
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+void A64EmitX64::EmitA64WriteMemory64Pair(A64EmitContext& ctx, IR::Inst* inst) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(nullptr, {}, args[0], args[1], args[2]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(conf.callbacks));
+        code.CallFunction(static_cast<void(*)(A64::UserCallbacks*, u64, u64, u64)>(
+            [](A64::UserCallbacks* cb, u64 vaddr, u64 first, u64 second) {
+                cb->MemoryWrite64(vaddr, first);
+                cb->MemoryWrite64(vaddr + 8, second);
+            }
+        ));
+        return;
+    }
+
+    Xbyak::Label abort, end;
+
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Reg64 first = ctx.reg_alloc.UseGpr(args[1]);
+    Xbyak::Reg64 second = ctx.reg_alloc.UseGpr(args[2]);
+    Xbyak::Reg64 tmp_vaddr = ctx.reg_alloc.ScratchGpr();
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        dirty_scratch = DirtyPageScratch{tmp_vaddr, ctx.reg_alloc.ScratchGpr(), ctx.reg_alloc.ScratchGpr()};
+    }
+
+    const auto lookup_scratch = AllocateVAddrLookupScratch(ctx);
+
+    EmitCrossPageCheck(code, abort, vaddr, tmp_vaddr, 16);
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, lookup_scratch);
+    code.mov(qword[dest_ptr], first);
+    code.mov(qword[dest_ptr + 8], second);
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    // Accesses which cross a page boundary (or miss the page table) are split into two.
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.call(write_fallbacks[std::make_tuple(64, vaddr.getIdx(), first.getIdx())]);
+    code.lea(tmp_vaddr, ptr[vaddr + 8]);
+    code.call(write_fallbacks[std::make_tuple(64, tmp_vaddr.getIdx(), second.getIdx())]);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+}
+
+// Calls into the global monitor to perform an exclusive write. Expects ABI_PARAM1 to hold &conf,
+// ABI_PARAM2 to hold vaddr and ABI_PARAM3 to hold the value (or a pointer to it for 128-bit writes).
+static void EmitGlobalMonitorExclusiveWrite(BlockOfCode& code, size_t bitsize) {
+    switch (bitsize) {
+    case 8:
+        code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u8)>(
+            [](A64::UserConfig& conf, u64 vaddr, u8 value) -> u32 {
+                return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 1, [&]{
+                    conf.callbacks->MemoryWrite8(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        break;
+    case 16:
+        code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u16)>(
+            [](A64::UserConfig& conf, u64 vaddr, u16 value) -> u32 {
+                return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 2, [&]{
+                    conf.callbacks->MemoryWrite16(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        break;
+    case 32:
+        code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u32)>(
+            [](A64::UserConfig& conf, u64 vaddr, u32 value) -> u32 {
+                return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 4, [&]{
+                    conf.callbacks->MemoryWrite32(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        break;
+    case 64:
+        code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, u64)>(
+            [](A64::UserConfig& conf, u64 vaddr, u64 value) -> u32 {
+                return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 8, [&]{
+                    conf.callbacks->MemoryWrite64(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        break;
+    case 128:
+        code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, A64::Vector&)>(
+            [](A64::UserConfig& conf, u64 vaddr, A64::Vector& value) -> u32 {
+                return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 16, [&]{
+                    conf.callbacks->MemoryWrite128(vaddr, value);
+                }) ? 0 : 1;
+            }
+        ));
+        break;
+    default:
+        UNREACHABLE();
+    }
+}
+
+// A store which succeeds outside of the global monitor must still invalidate the reservations other
+// processors hold on its granule, as ExclusiveMonitor::DoExclusiveOperation does.
+static void EmitClearGlobalReservations(BlockOfCode& code, A64::ExclusiveMonitor& monitor, Xbyak::Reg64 vaddr, Xbyak::Reg64 granule, Xbyak::Reg64 invalid, Xbyak::Reg64 ptr) {
+    const auto first_address = reinterpret_cast<u64>(monitor.GetExclusiveAddressPointer(0));
+
+    code.mov(granule, vaddr);
+    code.and_(granule, static_cast<u32>(A64::ExclusiveMonitor::RESERVATION_GRANULE_MASK & 0xFFFF'FFFF));
+    code.mov(invalid, A64::ExclusiveMonitor::INVALID_EXCLUSIVE_ADDRESS);
+    code.mov(ptr, first_address);
+    for (size_t i = 0; i < monitor.GetProcessorCount(); i++) {
+        const auto offset = static_cast<u32>(reinterpret_cast<u64>(monitor.GetExclusiveAddressPointer(i)) - first_address);
+        Xbyak::Label next;
+        // Only reservations which still hold this granule are cleared, so the common case takes no lock.
+        code.cmp(qword[ptr + offset], granule);
+        code.jne(next);
+        code.mov(rax, granule);
+        code.lock();
+        code.cmpxchg(qword[ptr + offset], invalid);
+        code.L(next);
+    }
+}
+
+void A64EmitX64::EmitExclusiveRead(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
+    if (!conf.page_table || !conf.inline_exclusive_access) {
+        switch (bitsize) {
+        case 8:
+            EmitA64ReadMemory8(ctx, inst);
+            return;
+        case 16:
+            EmitA64ReadMemory16(ctx, inst);
+            return;
+        case 32:
+            EmitA64ReadMemory32(ctx, inst);
+            return;
+        case 64:
+            EmitA64ReadMemory64(ctx, inst);
+            return;
         case 128:
+            EmitA64ReadMemory128(ctx, inst);
+            return;
+        default:
+            UNREACHABLE();
+        }
+    }
+
+    // The loaded value is recorded so that the exclusive write can compare-and-swap against it.
+    Xbyak::Label abort, end;
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+
+    if (bitsize == 128) {
+        Xbyak::Xmm value = ctx.reg_alloc.ScratchXmm();
+
+        auto src_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
+        code.movups(value, xword[src_ptr]);
+        code.L(end);
+        code.movups(xword[r15 + offsetof(A64JitState, exclusive_value)], value);
+
+        code.SwitchToFarCode();
+        code.L(abort);
+        code.call(read_fallbacks[std::make_tuple(128, vaddr.getIdx(), value.getIdx())]);
+        code.jmp(end, code.T_NEAR);
+        code.SwitchToNearCode();
+
+        ctx.reg_alloc.DefineValue(inst, value);
+        return;
+    }
+
+    Xbyak::Reg64 value = ctx.reg_alloc.ScratchGpr();
+
+    auto src_ptr = EmitVAddrLookup(code, ctx, abort, vaddr, value);
+    switch (bitsize) {
+    case 8:
+        code.movzx(value.cvt32(), code.byte[src_ptr]);
+        break;
+    case 16:
+        code.movzx(value.cvt32(), word[src_ptr]);
+        break;
+    case 32:
+        code.mov(value.cvt32(), dword[src_ptr]);
+        break;
+    case 64:
+        code.mov(value, qword[src_ptr]);
+        break;
+    }
+    code.L(end);
+    code.mov(qword[r15 + offsetof(A64JitState, exclusive_value)], value);
+
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.call(read_fallbacks[std::make_tuple(bitsize, vaddr.getIdx(), value.getIdx())]);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, value);
+}
+
+void A64EmitX64::EmitA64ExclusiveReadMemory8(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitExclusiveRead(ctx, inst, 8);
+}
+
+void A64EmitX64::EmitA64ExclusiveReadMemory16(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitExclusiveRead(ctx, inst, 16);
+}
+
+void A64EmitX64::EmitA64ExclusiveReadMemory32(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitExclusiveRead(ctx, inst, 32);
+}
+
+void A64EmitX64::EmitA64ExclusiveReadMemory64(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitExclusiveRead(ctx, inst, 64);
+}
+
+void A64EmitX64::EmitA64ExclusiveReadMemory128(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitExclusiveRead(ctx, inst, 128);
+}
+
+void A64EmitX64::EmitInlineExclusiveWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
+    constexpr size_t offsetof_exclusive_value = offsetof(A64JitState, exclusive_value);
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    // cmpxchg compares against rax (rdx:rax), and cmpxchg16b stores rcx:rbx.
+    ctx.reg_alloc.ScratchGpr({HostLoc::RAX});
+    if (bitsize == 128) {
+        ctx.reg_alloc.ScratchGpr({HostLoc::RBX});
+        ctx.reg_alloc.ScratchGpr({HostLoc::RCX});
+        ctx.reg_alloc.ScratchGpr({HostLoc::RDX});
+    }
+    Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    Xbyak::Reg64 value;
+    Xbyak::Xmm xmm_value, xmm_tmp;
+    if (bitsize == 128) {
+        xmm_value = ctx.reg_alloc.UseXmm(args[1]);
+        if (!code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+            xmm_tmp = ctx.reg_alloc.ScratchXmm();
+        }
+    } else if (conf.global_monitor) {
+        // The value is dead once stored, so it doubles as scratch when clearing reservations.
+        value = ctx.reg_alloc.UseScratchGpr(args[1]);
+    } else {
+        value = ctx.reg_alloc.UseGpr(args[1]);
+    }
+    Xbyak::Reg32 passed = ctx.reg_alloc.ScratchGpr().cvt32();
+    Xbyak::Reg64 invalid;
+    if (conf.global_monitor && bitsize != 128) {
+        invalid = ctx.reg_alloc.ScratchGpr();
+    }
+    // The page is marked dirty after the compare-and-swap, so the registers it reserved are reused
+    // rather than adding to the pressure of this instruction (which may run out with pinned registers).
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        if (bitsize == 128) {
+            dirty_scratch = DirtyPageScratch{rbx, rcx, rdx};
+        } else {
+            dirty_scratch = DirtyPageScratch{rax, conf.global_monitor ? invalid : ctx.reg_alloc.ScratchGpr(), ctx.reg_alloc.ScratchGpr()};
+        }
+    }
+
+    Xbyak::Label abort, end;
+
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
+    if (bitsize == 128) {
+        // cmpxchg16b faults on unaligned addresses.
+        code.test(vaddr, 15);
+        code.jnz(abort, code.T_NEAR);
+    }
+    code.mov(passed, u32(1));
+    code.cmp(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
+    code.je(end, code.T_NEAR);
+    code.mov(rax, vaddr);
+    code.xor_(rax, qword[r15 + offsetof(A64JitState, exclusive_address)]);
+    code.test(rax, static_cast<u32>(A64JitState::RESERVATION_GRANULE_MASK & 0xFFFF'FFFF));
+    code.jne(end, code.T_NEAR);
+    code.mov(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
+    code.mov(rax, qword[r15 + offsetof_exclusive_value]);
+    switch (bitsize) {
+    case 8:
+        code.lock();
+        code.cmpxchg(code.byte[dest_ptr], value.cvt8());
+        break;
+    case 16:
+        code.lock();
+        code.cmpxchg(word[dest_ptr], value.cvt16());
+        break;
+    case 32:
+        code.lock();
+        code.cmpxchg(dword[dest_ptr], value.cvt32());
+        break;
+    case 64:
+        code.lock();
+        code.cmpxchg(qword[dest_ptr], value);
+        break;
+    case 128:
+        code.mov(rdx, qword[r15 + offsetof_exclusive_value + 8]);
+        code.movq(rbx, xmm_value);
+        if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+            code.pextrq(rcx, xmm_value, 1);
+        } else {
+            code.movhlps(xmm_tmp, xmm_value);
+            code.movq(rcx, xmm_tmp);
+        }
+        code.lock();
+        code.cmpxchg16b(xword[dest_ptr]);
+        break;
+    default:
+        UNREACHABLE();
+    }
+    code.setnz(passed.cvt8());
+    if (conf.global_monitor) {
+        // passed is known to be zero here, so it can hold the reservation pointer until restored.
+        Xbyak::Label store_failed;
+        code.jnz(store_failed, code.T_NEAR);
+        if (bitsize == 128) {
+            EmitClearGlobalReservations(code, *conf.global_monitor, vaddr, rbx, rcx, passed.cvt64());
+        } else {
+            EmitClearGlobalReservations(code, *conf.global_monitor, vaddr, value, invalid, passed.cvt64());
+        }
+        code.xor_(passed, passed);
+        code.L(store_failed);
+    }
+    if (dirty_scratch) {
+        // Nothing was written if the store failed, so the page is left clean.
+        code.test(passed, passed);
+        code.jnz(end, code.T_NEAR);
+    }
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    // Accesses which miss the page table behave as they would without inline exclusive access.
+    code.SwitchToFarCode();
+    code.L(abort);
+    code.mov(passed, u32(1));
+    code.cmp(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
+    code.je(end, code.T_NEAR);
+    if (conf.global_monitor) {
+        // The ABI helpers expect the stack to be misaligned by a return address.
+        code.sub(rsp, 8);
+        ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLocRegIdx(passed.getIdx()));
+        if (bitsize == 128) {
+            code.mov(code.ABI_PARAM2, vaddr);
+            code.sub(rsp, 16 + ABI_SHADOW_SPACE);
+            code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+            code.movaps(xword[code.ABI_PARAM3], xmm_value);
+        } else if (vaddr.getIdx() == code.ABI_PARAM3.getIdx() && value.getIdx() == code.ABI_PARAM2.getIdx()) {
+            code.xchg(code.ABI_PARAM2, code.ABI_PARAM3);
+        } else if (vaddr.getIdx() == code.ABI_PARAM3.getIdx()) {
+            code.mov(code.ABI_PARAM2, vaddr);
+            code.mov(code.ABI_PARAM3, value);
+        } else {
+            code.mov(code.ABI_PARAM3, value);
+            code.mov(code.ABI_PARAM2, vaddr);
+        }
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        EmitGlobalMonitorExclusiveWrite(code, bitsize);
+        if (bitsize == 128) {
+            code.add(rsp, 16 + ABI_SHADOW_SPACE);
+        }
+        code.mov(passed, code.ABI_RETURN.cvt32());
+        ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLocRegIdx(passed.getIdx()));
+        code.add(rsp, 8);
+    } else {
+        code.mov(rax, vaddr);
+        code.xor_(rax, qword[r15 + offsetof(A64JitState, exclusive_address)]);
+        code.test(rax, static_cast<u32>(A64JitState::RESERVATION_GRANULE_MASK & 0xFFFF'FFFF));
+        code.jne(end, code.T_NEAR);
+        code.mov(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
+        const int value_idx = bitsize == 128 ? xmm_value.getIdx() : value.getIdx();
+        code.call(write_fallbacks[std::make_tuple(bitsize, vaddr.getIdx(), value_idx)]);
+        code.xor_(passed, passed);
+    }
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, passed);
+}
+
+void A64EmitX64::EmitExclusiveWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
+    if (conf.page_table && conf.inline_exclusive_access) {
+        EmitInlineExclusiveWrite(ctx, inst, bitsize);
+        return;
+    }
+
+    if (conf.global_monitor) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+        if (bitsize != 128) {
+            ctx.reg_alloc.HostCall(inst, {}, args[0], args[1]);
+        } else {
+            ctx.reg_alloc.Use(args[0], ABI_PARAM2);
+            ctx.reg_alloc.Use(args[1], HostLoc::XMM1);
+            ctx.reg_alloc.EndOfAllocScope();
+            ctx.reg_alloc.HostCall(inst);
+        }
+
+        Xbyak::Label end;
+
+        code.mov(code.ABI_RETURN, u32(1));
+        code.cmp(code.byte[r15 + offsetof(A64JitState, exclusive_state)], u8(0));
+        code.je(end);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        if (bitsize == 128) {
             code.sub(rsp, 16 + ABI_SHADOW_SPACE);
             code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
             code.movaps(xword[code.ABI_PARAM3], xmm1);
-            code.CallFunction(static_cast<u32(*)(A64::UserConfig&, u64, A64::Vector&)>(
-                [](A64::UserConfig& conf, u64 vaddr, A64::Vector& value) -> u32 {
-                    return conf.global_monitor->DoExclusiveOperation(conf.processor_id, vaddr, 16, [&]{
-                        conf.callbacks->MemoryWrite128(vaddr, value);
-                    }) ? 0 : 1;
-                }
-            ));
+            EmitGlobalMonitorExclusiveWrite(code, bitsize);
             code.add(rsp, 16 + ABI_SHADOW_SPACE);
-            break;
-        default:
-            UNREACHABLE();
+        } else {
+            EmitGlobalMonitorExclusiveWrite(code, bitsize);
         }
         code.L(end);
 
@@ -1070,6 +2387,464 @@ void A64EmitX64::EmitA64ExclusiveWriteMemory128(A64EmitContext& ctx, IR::Inst* i
     EmitExclusiveWrite(ctx, inst, 128);
 }
 
+template <size_t bitsize>
+static u64 ComputeAtomicOperation(A64::AtomicOp op, u64 old_value, u64 value) {
+    constexpr size_t shift = 64 - bitsize;
+    const u64 mask = Common::Ones<u64>(bitsize);
+    old_value &= mask;
+    value &= mask;
+    const s64 signed_old_value = static_cast<s64>(old_value << shift) >> shift;
+    const s64 signed_value = static_cast<s64>(value << shift) >> shift;
+
+    switch (op) {
+    case A64::AtomicOp::ADD:
+        return (old_value + value) & mask;
+    case A64::AtomicOp::CLR:
+        return old_value & ~value;
+    case A64::AtomicOp::EOR:
+        return old_value ^ value;
+    case A64::AtomicOp::SET:
+        return old_value | value;
+    case A64::AtomicOp::SMAX:
+        return signed_old_value > signed_value ? old_value : value;
+    case A64::AtomicOp::SMIN:
+        return signed_old_value < signed_value ? old_value : value;
+    case A64::AtomicOp::UMAX:
+        return std::max(old_value, value);
+    case A64::AtomicOp::UMIN:
+        return std::min(old_value, value);
+    case A64::AtomicOp::SWP:
+        return value;
+    }
+    UNREACHABLE();
+    return 0;
+}
+
+// Accesses which miss the page table are performed through the memory callbacks. These are only
+// atomic with respect to other processors if the embedder serializes its callbacks.
+template <size_t bitsize>
+static u64 AtomicMemoryOperationFallback(A64::UserConfig& conf, u64 vaddr, u64 value, u64 op) {
+    const u64 old_value = ReadMemoryCallback<bitsize>(conf.callbacks, vaddr);
+    WriteMemoryCallback<bitsize>(conf.callbacks, vaddr, ComputeAtomicOperation<bitsize>(static_cast<A64::AtomicOp>(op), old_value, value));
+    return old_value;
+}
+
+template <size_t bitsize>
+static u64 CompareAndSwapMemoryFallback(A64::UserConfig& conf, u64 vaddr, u64 expected, u64 desired) {
+    const u64 old_value = ReadMemoryCallback<bitsize>(conf.callbacks, vaddr);
+    if (old_value == (expected & Common::Ones<u64>(bitsize))) {
+        WriteMemoryCallback<bitsize>(conf.callbacks, vaddr, desired);
+    }
+    return old_value;
+}
+
+static void CompareAndSwapMemory128Fallback(A64::UserConfig& conf, u64 vaddr, A64::Vector& expected, const A64::Vector& desired) {
+    const A64::Vector old_value = conf.callbacks->MemoryRead128(vaddr);
+    if (old_value == expected) {
+        conf.callbacks->MemoryWrite128(vaddr, desired);
+    }
+    expected = old_value;
+}
+
+// Moves a into ABI_PARAM2 and b into ABI_PARAM3, regardless of which registers a and b occupy.
+static void EmitMoveToParam2And3(BlockOfCode& code, Xbyak::Reg64 a, Xbyak::Reg64 b) {
+    code.push(b);
+    code.push(a);
+    code.pop(code.ABI_PARAM2);
+    code.pop(code.ABI_PARAM3);
+}
+
+// Locked instructions on x64 are sequentially consistent, so the acquire and release semantics of the
+// guest instruction need no additional fencing.
+void A64EmitX64::EmitAtomicMemoryOperation(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    ASSERT(args[2].IsImmediate());
+    const auto op = static_cast<A64::AtomicOp>(args[2].GetImmediateU8());
+    const auto fallback = SelectBySize(bitsize,
+                                       &AtomicMemoryOperationFallback<8>,
+                                       &AtomicMemoryOperationFallback<16>,
+                                       &AtomicMemoryOperationFallback<32>,
+                                       &AtomicMemoryOperationFallback<64>);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(inst, {}, args[0], args[1]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.mov(code.ABI_PARAM4, static_cast<u64>(op));
+        code.CallFunction(fallback);
+        return;
+    }
+
+    const bool is_signed = op == A64::AtomicOp::SMAX || op == A64::AtomicOp::SMIN;
+    const bool is_minmax = is_signed || op == A64::AtomicOp::UMAX || op == A64::AtomicOp::UMIN;
+
+    // lock xadd and xchg return the old value in rax; the remaining operations loop on lock cmpxchg,
+    // which compares against rax.
+    const Xbyak::Reg64 result = ctx.reg_alloc.ScratchGpr({HostLoc::RAX});
+    const Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    const Xbyak::Reg64 value = ctx.reg_alloc.UseGpr(args[1]);
+    Xbyak::Reg64 new_value, extended_value;
+    if (op != A64::AtomicOp::ADD && op != A64::AtomicOp::SWP) {
+        new_value = ctx.reg_alloc.ScratchGpr();
+    }
+    if (is_minmax) {
+        extended_value = ctx.reg_alloc.ScratchGpr();
+    }
+    // The page is marked dirty after the compare-and-swap loop, so the registers the loop used are
+    // reused rather than adding to the pressure of this instruction (which may run out with pinned registers).
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        if (is_minmax) {
+            dirty_scratch = DirtyPageScratch{new_value, extended_value, ctx.reg_alloc.ScratchGpr()};
+        } else if (op != A64::AtomicOp::ADD && op != A64::AtomicOp::SWP) {
+            dirty_scratch = DirtyPageScratch{new_value, ctx.reg_alloc.ScratchGpr(), ctx.reg_alloc.ScratchGpr()};
+        } else {
+            dirty_scratch = AllocateDirtyPageScratch(ctx);
+        }
+    }
+
+    const auto extend = [&](Xbyak::Reg64 to, Xbyak::Reg64 from) {
+        switch (bitsize) {
+        case 8:
+            is_signed ? code.movsx(to, from.cvt8()) : code.movzx(to.cvt32(), from.cvt8());
+            break;
+        case 16:
+            is_signed ? code.movsx(to, from.cvt16()) : code.movzx(to.cvt32(), from.cvt16());
+            break;
+        case 32:
+            is_signed ? code.movsxd(to, from.cvt32()) : code.mov(to.cvt32(), from.cvt32());
+            break;
+        case 64:
+            code.mov(to, from);
+            break;
+        }
+    };
+    const auto operand = [&](Xbyak::Reg64 reg) -> Xbyak::Reg {
+        switch (bitsize) {
+        case 8:
+            return reg.cvt8();
+        case 16:
+            return reg.cvt16();
+        case 32:
+            return reg.cvt32();
+        default:
+            return reg;
+        }
+    };
+
+    Xbyak::Label abort, end;
+
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
+    const Xbyak::Address dest = bitsize == 8 ? code.byte[dest_ptr]
+                              : bitsize == 16 ? code.word[dest_ptr]
+                              : bitsize == 32 ? code.dword[dest_ptr]
+                              : code.qword[dest_ptr];
+
+    switch (op) {
+    case A64::AtomicOp::ADD:
+        code.mov(result, value);
+        code.lock();
+        code.xadd(dest, operand(result));
+        break;
+    case A64::AtomicOp::SWP:
+        code.mov(result, value);
+        code.xchg(dest, operand(result));
+        break;
+    default: {
+        Xbyak::Label loop;
+
+        if (is_minmax) {
+            extend(extended_value, value);
+        }
+        switch (bitsize) {
+        case 8:
+            code.movzx(result.cvt32(), code.byte[dest_ptr]);
+            break;
+        case 16:
+            code.movzx(result.cvt32(), code.word[dest_ptr]);
+            break;
+        case 32:
+            code.mov(result.cvt32(), code.dword[dest_ptr]);
+            break;
+        case 64:
+            code.mov(result, code.qword[dest_ptr]);
+            break;
+        }
+        code.L(loop);
+        switch (op) {
+        case A64::AtomicOp::CLR:
+            code.mov(new_value, value);
+            code.not_(new_value);
+            code.and_(new_value, result);
+            break;
+        case A64::AtomicOp::EOR:
+            code.mov(new_value, value);
+            code.xor_(new_value, result);
+            break;
+        case A64::AtomicOp::SET:
+            code.mov(new_value, value);
+            code.or_(new_value, result);
+            break;
+        case A64::AtomicOp::SMAX:
+            extend(new_value, result);
+            code.cmp(new_value, extended_value);
+            code.cmovl(new_value, extended_value);
+            break;
+        case A64::AtomicOp::SMIN:
+            extend(new_value, result);
+            code.cmp(new_value, extended_value);
+            code.cmovg(new_value, extended_value);
+            break;
+        case A64::AtomicOp::UMAX:
+            extend(new_value, result);
+            code.cmp(new_value, extended_value);
+            code.cmovb(new_value, extended_value);
+            break;
+        case A64::AtomicOp::UMIN:
+            extend(new_value, result);
+            code.cmp(new_value, extended_value);
+            code.cmova(new_value, extended_value);
+            break;
+        default:
+            UNREACHABLE();
+        }
+        code.lock();
+        code.cmpxchg(dest, operand(new_value));
+        code.jnz(loop);
+        break;
+    }
+    }
+    if (bitsize < 32 && (op == A64::AtomicOp::ADD || op == A64::AtomicOp::SWP)) {
+        code.movzx(result.cvt32(), operand(result));
+    }
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    code.SwitchToFarCode();
+    code.L(abort);
+    // The ABI helpers expect the stack to be misaligned by a return address.
+    code.sub(rsp, 8);
+    ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLoc::RAX);
+    EmitMoveToParam2And3(code, vaddr, value);
+    code.mov(code.ABI_PARAM4, static_cast<u64>(op));
+    code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+    code.CallFunction(fallback);
+    ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLoc::RAX);
+    code.add(rsp, 8);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
+void A64EmitX64::EmitCompareAndSwapMemory(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const auto fallback = SelectBySize(bitsize,
+                                       &CompareAndSwapMemoryFallback<8>,
+                                       &CompareAndSwapMemoryFallback<16>,
+                                       &CompareAndSwapMemoryFallback<32>,
+                                       &CompareAndSwapMemoryFallback<64>);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.HostCall(inst, {}, args[0], args[1], args[2]);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.CallFunction(fallback);
+        return;
+    }
+
+    // lock cmpxchg compares against rax, and leaves the old value in rax.
+    const Xbyak::Reg64 result = ctx.reg_alloc.ScratchGpr({HostLoc::RAX});
+    const Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    const Xbyak::Reg64 expected = ctx.reg_alloc.UseGpr(args[1]);
+    const Xbyak::Reg64 desired = ctx.reg_alloc.UseGpr(args[2]);
+    const auto dirty_scratch = AllocateDirtyPageScratch(ctx);
+
+    Xbyak::Label abort, end;
+
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
+    code.mov(result, expected);
+    code.lock();
+    switch (bitsize) {
+    case 8:
+        code.cmpxchg(code.byte[dest_ptr], desired.cvt8());
+        code.movzx(result.cvt32(), result.cvt8());
+        break;
+    case 16:
+        code.cmpxchg(word[dest_ptr], desired.cvt16());
+        code.movzx(result.cvt32(), result.cvt16());
+        break;
+    case 32:
+        code.cmpxchg(dword[dest_ptr], desired.cvt32());
+        break;
+    case 64:
+        code.cmpxchg(qword[dest_ptr], desired);
+        break;
+    default:
+        UNREACHABLE();
+    }
+    if (dirty_scratch) {
+        // Nothing was written if the comparison failed, so the page is left clean.
+        code.jnz(end, code.T_NEAR);
+    }
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    code.SwitchToFarCode();
+    code.L(abort);
+    // The ABI helpers expect the stack to be misaligned by a return address.
+    code.sub(rsp, 8);
+    ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLoc::RAX);
+    code.push(desired);
+    EmitMoveToParam2And3(code, vaddr, expected);
+    code.pop(code.ABI_PARAM4);
+    code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+    code.CallFunction(fallback);
+    ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLoc::RAX);
+    code.add(rsp, 8);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
+void A64EmitX64::EmitCompareAndSwapMemory128(A64EmitContext& ctx, IR::Inst* inst) {
+    constexpr size_t stack_size = 2 * 16 + ABI_SHADOW_SPACE;
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    if (!conf.page_table) {
+        ctx.reg_alloc.Use(args[0], ABI_PARAM2);
+        ctx.reg_alloc.Use(args[1], HostLoc::XMM1);
+        ctx.reg_alloc.Use(args[2], HostLoc::XMM2);
+        ctx.reg_alloc.EndOfAllocScope();
+        ctx.reg_alloc.HostCall(nullptr);
+
+        code.sub(rsp, stack_size);
+        code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+        code.lea(code.ABI_PARAM4, ptr[rsp + ABI_SHADOW_SPACE + 16]);
+        code.movaps(xword[code.ABI_PARAM3], xmm1);
+        code.movaps(xword[code.ABI_PARAM4], xmm2);
+        code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+        code.CallFunction(&CompareAndSwapMemory128Fallback);
+        code.movaps(xmm1, xword[rsp + ABI_SHADOW_SPACE]);
+        code.add(rsp, stack_size);
+
+        ctx.reg_alloc.DefineValue(inst, xmm1);
+        return;
+    }
+
+    // cmpxchg16b compares against rdx:rax, stores rcx:rbx, and leaves the old value in rdx:rax.
+    ctx.reg_alloc.ScratchGpr({HostLoc::RAX});
+    ctx.reg_alloc.ScratchGpr({HostLoc::RBX});
+    ctx.reg_alloc.ScratchGpr({HostLoc::RCX});
+    ctx.reg_alloc.ScratchGpr({HostLoc::RDX});
+    const Xbyak::Reg64 vaddr = ctx.reg_alloc.UseGpr(args[0]);
+    const Xbyak::Xmm expected = ctx.reg_alloc.UseXmm(args[1]);
+    const Xbyak::Xmm desired = ctx.reg_alloc.UseXmm(args[2]);
+    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+    Xbyak::Xmm xmm_tmp;
+    if (!code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        xmm_tmp = ctx.reg_alloc.ScratchXmm();
+    }
+    // The page is marked dirty after the compare-and-swap, when the old value has been moved out of
+    // rdx:rax. cmpxchg16b no longer needs rbx, rcx and rdx at that point, so the dirty marking reuses them.
+    boost::optional<DirtyPageScratch> dirty_scratch;
+    if (conf.dirty_page_bitmap) {
+        dirty_scratch = DirtyPageScratch{rbx, rcx, rdx};
+    }
+
+    Xbyak::Label abort, end;
+
+    auto dest_ptr = EmitVAddrLookup(code, ctx, abort, vaddr);
+    // cmpxchg16b faults on unaligned addresses.
+    code.test(vaddr, 15);
+    code.jnz(abort, code.T_NEAR);
+    code.movq(rax, expected);
+    code.movq(rbx, desired);
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        code.pextrq(rdx, expected, 1);
+        code.pextrq(rcx, desired, 1);
+    } else {
+        code.movhlps(xmm_tmp, expected);
+        code.movq(rdx, xmm_tmp);
+        code.movhlps(xmm_tmp, desired);
+        code.movq(rcx, xmm_tmp);
+    }
+    code.lock();
+    code.cmpxchg16b(xword[dest_ptr]);
+    code.movq(result, rax);
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        code.pinsrq(result, rdx, 1);
+    } else {
+        code.movq(xmm_tmp, rdx);
+        code.punpcklqdq(result, xmm_tmp);
+    }
+    if (dirty_scratch) {
+        // Nothing was written if the comparison failed, so the page is left clean.
+        // None of the moves above affect the flags set by cmpxchg16b.
+        code.jnz(end, code.T_NEAR);
+    }
+    EmitMarkPageDirty(code, ctx, vaddr, dirty_scratch);
+    code.L(end);
+
+    code.SwitchToFarCode();
+    code.L(abort);
+    // The ABI helpers expect the stack to be misaligned by a return address.
+    code.sub(rsp, 8);
+    ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+    code.sub(rsp, stack_size);
+    code.movaps(xword[rsp + ABI_SHADOW_SPACE], expected);
+    code.movaps(xword[rsp + ABI_SHADOW_SPACE + 16], desired);
+    code.mov(code.ABI_PARAM2, vaddr);
+    code.lea(code.ABI_PARAM3, ptr[rsp + ABI_SHADOW_SPACE]);
+    code.lea(code.ABI_PARAM4, ptr[rsp + ABI_SHADOW_SPACE + 16]);
+    code.mov(code.ABI_PARAM1, reinterpret_cast<u64>(&conf));
+    code.CallFunction(&CompareAndSwapMemory128Fallback);
+    code.movaps(result, xword[rsp + ABI_SHADOW_SPACE]);
+    code.add(rsp, stack_size);
+    ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+    code.add(rsp, 8);
+    code.jmp(end, code.T_NEAR);
+    code.SwitchToNearCode();
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
+void A64EmitX64::EmitA64AtomicMemoryOperation8(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitAtomicMemoryOperation(ctx, inst, 8);
+}
+
+void A64EmitX64::EmitA64AtomicMemoryOperation16(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitAtomicMemoryOperation(ctx, inst, 16);
+}
+
+void A64EmitX64::EmitA64AtomicMemoryOperation32(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitAtomicMemoryOperation(ctx, inst, 32);
+}
+
+void A64EmitX64::EmitA64AtomicMemoryOperation64(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitAtomicMemoryOperation(ctx, inst, 64);
+}
+
+void A64EmitX64::EmitA64CompareAndSwapMemory8(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitCompareAndSwapMemory(ctx, inst, 8);
+}
+
+void A64EmitX64::EmitA64CompareAndSwapMemory16(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitCompareAndSwapMemory(ctx, inst, 16);
+}
+
+void A64EmitX64::EmitA64CompareAndSwapMemory32(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitCompareAndSwapMemory(ctx, inst, 32);
+}
+
+void A64EmitX64::EmitA64CompareAndSwapMemory64(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitCompareAndSwapMemory(ctx, inst, 64);
+}
+
+void A64EmitX64::EmitA64CompareAndSwapMemory128(A64EmitContext& ctx, IR::Inst* inst) {
+    EmitCompareAndSwapMemory128(ctx, inst);
+}
+
 std::string A64EmitX64::LocationDescriptorToFriendlyName(const IR::LocationDescriptor& ir_descriptor) const {
     const A64::LocationDescriptor descriptor{ir_descriptor};
     return fmt::format("a64_{:016X}_fpcr{:08X}",
@@ -1093,7 +2868,11 @@ void A64EmitX64::EmitTerminalImpl(IR::Term::ReturnToDispatch, IR::LocationDescri
 }
 
 void A64EmitX64::EmitTerminalImpl(IR::Term::LinkBlock terminal, IR::LocationDescriptor) {
-    code.cmp(qword[r15 + offsetof(A64JitState, cycles_remaining)], 0);
+    Xbyak::Label halt;
+
+    code.cmp(dword[r15 + offsetof(A64JitState, halt_requested)], 0);
+    code.jne(halt);
+    code.CompareCyclesRemaining();
 
     patch_information[terminal.next].jg.emplace_back(code.getCurr());
     if (auto next_bb = GetBasicBlock(terminal.next)) {
@@ -1101,6 +2880,10 @@ void A64EmitX64::EmitTerminalImpl(IR::Term::LinkBlock terminal, IR::LocationDesc
     } else {
         EmitPatchJg(terminal.next);
     }
+    code.L(halt);
+    if (nzcv_deferred_in_edx) {
+        EmitStoreDeferredNZCV();
+    }
     code.mov(rax, A64::LocationDescriptor{terminal.next}.PC());
     code.mov(qword[r15 + offsetof(A64JitState, pc)], rax);
     code.ForceReturnFromRunCode();
@@ -1152,7 +2935,7 @@ void A64EmitX64::EmitTerminalImpl(IR::Term::CheckBit terminal, IR::LocationDescr
 }
 
 void A64EmitX64::EmitTerminalImpl(IR::Term::CheckHalt terminal, IR::LocationDescriptor initial_location) {
-    code.cmp(code.byte[r15 + offsetof(A64JitState, halt_requested)], u8(0));
+    code.cmp(dword[r15 + offsetof(A64JitState, halt_requested)], 0);
     code.jne(code.GetForceReturnFromRunCodeAddress());
     EmitTerminal(terminal.else_, initial_location);
 }
@@ -6,20 +6,30 @@
 
 #pragma once
 
+#include <bitset>
 #include <map>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
 
 #include "backend/x64/a64_jitstate.h"
 #include "backend/x64/block_range_information.h"
 #include "backend/x64/emit_x64.h"
+#include "backend/x64/hostloc.h"
 #include "dynarmic/A64/a64.h"
 #include "dynarmic/A64/config.h"
 #include "frontend/A64/location_descriptor.h"
+#include "frontend/ir/opcodes.h"
 #include "frontend/ir/terminal.h"
 
 namespace Dynarmic::BackendX64 {
 
+class Callback;
 class RegAlloc;
+struct Argument;
 
 struct A64EmitContext final : public EmitContext {
     A64EmitContext(const A64::UserConfig& conf, RegAlloc& reg_alloc, IR::Block& block);
@@ -46,12 +56,22 @@ public:
 
     void ClearCache() override;
 
+    /// Host registers which hold pinned guest registers, paired with their offsets in A64JitState.
+    static std::vector<std::pair<Xbyak::Reg64, size_t>> PinnedRegisterMap(const A64::UserConfig& conf);
+
     void InvalidateCacheRanges(const boost::icl::interval_set<u64>& ranges);
 
+    /// Number of spill slot accesses the register allocator emitted since the cache was last cleared.
+    size_t SpillCount() const { return spill_count; }
+    /// Number of register moves the register allocator emitted since the cache was last cleared.
+    size_t MoveCount() const { return move_count; }
+
 protected:
     const A64::UserConfig conf;
     A64::Jit* jit_interface;
     BlockRangeInformation<u64> block_ranges;
+    size_t spill_count = 0;
+    size_t move_count = 0;
 
     struct FastDispatchEntry {
         u64 location_descriptor;
@@ -63,6 +83,28 @@ protected:
     std::array<FastDispatchEntry, fast_dispatch_table_size> fast_dispatch_table;
     void ClearFastDispatchTable();
 
+    /// Guest code ranges of translated blocks which overwrite NZCV before reading it.
+    std::unordered_map<IR::LocationDescriptor, boost::icl::discrete_interval<u64>> nzcv_overwriting_blocks;
+    /// Set while emitting a block whose final NZCV write has been deferred to its exits.
+    bool nzcv_deferred_in_edx = false;
+    bool LinksOnlyToNZCVOverwritingBlocks(const IR::Terminal& terminal, const IR::LocationDescriptor& self, bool self_overwrites_nzcv,
+                                          std::vector<IR::LocationDescriptor>& successors) const;
+    IR::Inst* FindDeferrableSetNZCV(IR::Block& block, bool overwrites_nzcv, std::vector<IR::LocationDescriptor>& successors) const;
+    void EmitDeferredSetNZCV(A64EmitContext& ctx, IR::Inst* inst);
+    void EmitStoreDeferredNZCV();
+
+    /// Opcodes whose emitters have called RegAlloc::HostCall. Whether an opcode calls into the host
+    /// depends on the configuration and host CPU features, both of which are fixed for the lifetime
+    /// of the emitter, so it is learnt from emission instead of listed by hand. Apart from memory
+    /// accesses, an opcode is only known to call once it has been emitted, so the first block
+    /// containing it is allocated as if it did not.
+    std::bitset<IR::OpcodeCount> host_call_opcodes;
+    bool IsHostCall(const IR::Inst* inst) const;
+
+    boost::optional<Xbyak::Reg64> PinnedRegister(size_t index) const;
+    std::vector<HostLoc> PinnedHostLocations() const;
+    void EmitSetPinnedRegister(A64EmitContext& ctx, Xbyak::Reg64 pinned, Argument& arg);
+
     void (*memory_read_128)();
     void (*memory_write_128)();
     void GenMemory128Accessors();
@@ -70,6 +112,7 @@ protected:
     std::map<std::tuple<size_t, int, int>, void(*)()> read_fallbacks;
     std::map<std::tuple<size_t, int, int>, void(*)()> write_fallbacks;
     void GenFastmemFallbacks();
+    void GenMMIODispatch(size_t bitsize, const Callback& callback, size_t handler_offset, Xbyak::Reg64 bytesize_param);
 
     const void* terminal_handler_pop_rsb_hint;
     const void* terminal_handler_fast_dispatch_hint = nullptr;
@@ -77,7 +120,13 @@ protected:
 
     void EmitDirectPageTableMemoryRead(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
     void EmitDirectPageTableMemoryWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
+    void EmitExclusiveRead(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
     void EmitExclusiveWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
+    void EmitInlineExclusiveWrite(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
+    void EmitAtomicMemoryOperation(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
+    void EmitCompareAndSwapMemory(A64EmitContext& ctx, IR::Inst* inst, size_t bitsize);
+    void EmitCompareAndSwapMemory128(A64EmitContext& ctx, IR::Inst* inst);
+    void EmitExceptionRaisedFromFarCode(u64 pc, A64::Exception exception);
 
     // Microinstruction emitters
 #define OPCODE(...)
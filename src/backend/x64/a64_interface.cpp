@@ -11,11 +11,15 @@
 
 #include "backend/x64/a64_emit_x64.h"
 #include "backend/x64/a64_jitstate.h"
+#include "backend/x64/a64_translation_cache.h"
 #include "backend/x64/block_of_code.h"
 #include "backend/x64/devirtualize.h"
 #include "backend/x64/jitstate_info.h"
 #include "common/assert.h"
+#include "common/atomic.h"
+#include "common/bit_util.h"
 #include "common/llvm_disassemble.h"
+#include "common/mpsc_queue.h"
 #include "common/scope_exit.h"
 #include "dynarmic/A64/a64.h"
 #include "frontend/A64/translate/translate.h"
@@ -26,46 +30,74 @@ namespace Dynarmic::A64 {
 
 using namespace BackendX64;
 
-static RunCodeCallbacks GenRunCodeCallbacks(A64::UserCallbacks* cb, CodePtr (*LookupBlock)(void* lookup_block_arg), void* arg) {
+static_assert(sizeof(std::atomic<u64>) == sizeof(u64));
+
+static RunCodeCallbacks GenRunCodeCallbacks(const A64::UserConfig& conf, CodePtr (*LookupBlock)(void* lookup_block_arg), void* arg) {
     return RunCodeCallbacks{
         std::make_unique<ArgCallback>(LookupBlock, reinterpret_cast<u64>(arg)),
-        std::make_unique<ArgCallback>(Devirtualize<&A64::UserCallbacks::AddTicks>(cb)),
-        std::make_unique<ArgCallback>(Devirtualize<&A64::UserCallbacks::GetTicksRemaining>(cb)),
+        std::make_unique<ArgCallback>(Devirtualize<&A64::UserCallbacks::AddTicks>(conf.callbacks)),
+        std::make_unique<ArgCallback>(Devirtualize<&A64::UserCallbacks::GetTicksRemaining>(conf.callbacks)),
+        conf.cycle_counter,
+        reinterpret_cast<const u64*>(conf.cycle_deadline),
+        A64EmitX64::PinnedRegisterMap(conf),
     };
 }
 
 struct Jit::Impl final {
 public:
     Impl(Jit* jit, UserConfig conf)
-        : conf(conf) 
-        , block_of_code(GenRunCodeCallbacks(conf.callbacks, &GetCurrentBlockThunk, this), JitStateInfo{jit_state})
+        : jit_interface(jit)
+        , conf(conf)
+        , block_of_code(GenRunCodeCallbacks(conf, &GetCurrentBlockThunk, this), JitStateInfo{jit_state})
         , emitter(block_of_code, conf, jit)
     {
         ASSERT(conf.page_table_address_space_bits >= 12 && conf.page_table_address_space_bits <= 64);
+        ASSERT(!conf.cycle_counter || conf.cycle_deadline);
     }
 
-    ~Impl() = default;
+    ~Impl() {
+        // Registration happens in Jit::Jit, once the Jit is able to accept queued invalidations.
+        if (conf.translation_cache) {
+            conf.translation_cache->impl->Unregister(jit_interface);
+        }
+    }
 
     void Run() {
         ASSERT(!is_executing);
         is_executing = true;
         SCOPE_EXIT { this->is_executing = false; };
-        jit_state.halt_requested = false;
 
         // TODO: Check code alignment
 
-        const u32 new_rsb_ptr = (jit_state.rsb_ptr - 1) & A64JitState::RSBPtrMask;
-        if (jit_state.GetUniqueHash() == jit_state.rsb_location_descriptors[new_rsb_ptr]) {
-            jit_state.rsb_ptr = new_rsb_ptr;
-            block_of_code.RunCodeFrom(&jit_state, reinterpret_cast<CodePtr>(jit_state.rsb_codeptrs[new_rsb_ptr]));
-        } else {
-            block_of_code.RunCode(&jit_state);
+        while (true) {
+            PerformRequestedCacheInvalidation();
+
+            const u32 new_rsb_ptr = (jit_state.rsb_ptr - 1) & A64JitState::RSBPtrMask;
+            if (jit_state.GetUniqueHash() == jit_state.rsb_location_descriptors[new_rsb_ptr]) {
+                jit_state.rsb_ptr = new_rsb_ptr;
+                block_of_code.RunCodeFrom(&jit_state, reinterpret_cast<CodePtr>(jit_state.rsb_codeptrs[new_rsb_ptr]));
+            } else {
+                block_of_code.RunCode(&jit_state);
+            }
+
+            // A request which arrives after the guest has stopped is satisfied by this return.
+            const u32 halt_reason = Atomic::Exchange(&jit_state.halt_requested, 0);
+
+            // Invalidations queued by other threads are not visible to our caller: execution resumes once
+            // they have been performed.
+            if (halt_reason != A64JitState::HALT_FOR_QUEUED_INVALIDATION || !HasCyclesRemaining()) {
+                break;
+            }
         }
 
         PerformRequestedCacheInvalidation();
     }
 
     void ClearCache() {
+        if (conf.translation_cache) {
+            conf.translation_cache->impl->ClearTranslations();
+        }
+
         invalidate_entire_cache = true;
         RequestCacheInvalidation();
     }
@@ -73,17 +105,56 @@ public:
     void InvalidateCacheRange(u64 start_address, size_t length) {
         const auto end_address = static_cast<u64>(start_address + length - 1);
         const auto range = boost::icl::discrete_interval<u64>::closed(start_address, end_address);
+        if (conf.translation_cache) {
+            conf.translation_cache->impl->InvalidateTranslations(boost::icl::interval_set<u64>{range});
+        }
+
         invalid_cache_ranges.add(range);
         RequestCacheInvalidation();
     }
 
+    void QueueInvalidateCacheRange(u64 start_address, size_t length) {
+        const auto end_address = static_cast<u64>(start_address + length - 1);
+        queued_cache_invalidations.Push(boost::icl::discrete_interval<u64>::closed(start_address, end_address));
+        Atomic::Or(&jit_state.halt_requested, A64JitState::HALT_FOR_QUEUED_INVALIDATION);
+    }
+
+    void InvalidateTLB() {
+        jit_state.ResetTLB();
+    }
+
+    std::vector<u64> HarvestDirtyPages() {
+        ASSERT(!is_executing);
+
+        std::vector<u64> result;
+        if (!conf.dirty_page_bitmap) {
+            return result;
+        }
+
+        const size_t page_count = size_t(1) << (conf.page_table_address_space_bits - 12);
+        const size_t word_count = (page_count + 63) / 64;
+        for (size_t i = 0; i < word_count; i++) {
+            // Other Jits sharing the bitmap may be setting bits concurrently.
+            if (conf.dirty_page_bitmap[i] == 0) {
+                continue;
+            }
+            u64 word = Atomic::Exchange(&conf.dirty_page_bitmap[i], 0);
+            while (word != 0) {
+                const size_t bit = Common::LowestSetBit(word);
+                result.emplace_back(u64(i * 64 + bit) << 12);
+                word &= word - 1;
+            }
+        }
+        return result;
+    }
+
     void Reset() {
         ASSERT(!is_executing);
         jit_state = {};
     }
 
     void HaltExecution() {
-        jit_state.halt_requested = true;
+        Atomic::Or(&jit_state.halt_requested, A64JitState::HALT_EXECUTION);
     }
 
     u64 GetSP() const {
@@ -179,7 +250,18 @@ public:
         return Common::DisassembleX64(block_of_code.GetCodeBegin(), block_of_code.getCurr());
     }
 
+    Jit::CodeStatistics GetCodeStatistics() const {
+        return {block_of_code.GetEmittedCodeSize(), emitter.SpillCount(), emitter.MoveCount()};
+    }
+
 private:
+    bool HasCyclesRemaining() const {
+        if (conf.cycle_counter) {
+            return static_cast<s64>(*conf.cycle_counter) < static_cast<s64>(conf.cycle_deadline->load());
+        }
+        return jit_state.cycles_remaining > 0;
+    }
+
     static CodePtr GetCurrentBlockThunk(void* thisptr) {
         Jit::Impl* this_ = static_cast<Jit::Impl*>(thisptr);
         return this_->GetCurrentBlock();
@@ -198,22 +280,41 @@ private:
             PerformRequestedCacheInvalidation();
         }
 
-        // JIT Compile
+        if (!conf.translation_cache) {
+            IR::Block ir_block = TranslateBlock(current_location);
+            return emitter.Emit(ir_block).entrypoint;
+        }
+
+        TranslationCache::Impl& translation_cache = *conf.translation_cache->impl;
+        if (auto cached_block = translation_cache.Lookup(current_location)) {
+            return emitter.Emit(*cached_block).entrypoint;
+        }
+
+        const u64 generation = translation_cache.Generation();
+        IR::Block ir_block = TranslateBlock(current_location);
+        translation_cache.Insert(ir_block, generation);
+        return emitter.Emit(ir_block).entrypoint;
+    }
+
+    IR::Block TranslateBlock(IR::LocationDescriptor location) {
         const auto get_code = [this](u64 vaddr) { return conf.callbacks->MemoryReadCode(vaddr); };
-        IR::Block ir_block = A64::Translate(A64::LocationDescriptor{current_location}, get_code, {conf.define_unpredictable_behaviour});
+        const bool emit_sha_ir_instructions = conf.enable_host_sha_instructions && block_of_code.DoesCpuSupport(Xbyak::util::Cpu::tSHA);
+        IR::Block ir_block = A64::Translate(A64::LocationDescriptor{location}, get_code, {conf.define_unpredictable_behaviour, emit_sha_ir_instructions});
         Optimization::A64CallbackConfigPass(ir_block, conf);
         Optimization::A64GetSetElimination(ir_block);
         Optimization::ConstantPropagation(ir_block);
+        Optimization::A64ConstantMemoryReads(ir_block, conf.callbacks);
+        Optimization::ConstantPropagation(ir_block);
         Optimization::DeadCodeElimination(ir_block);
         Optimization::A64MergeInterpretBlocksPass(ir_block, conf.callbacks);
         // printf("%s\n", IR::DumpBlock(ir_block).c_str());
         Optimization::VerificationPass(ir_block);
-        return emitter.Emit(ir_block).entrypoint;
+        return ir_block;
     }
 
     void RequestCacheInvalidation() {
         if (is_executing) {
-            jit_state.halt_requested = true;
+            Atomic::Or(&jit_state.halt_requested, A64JitState::HALT_EXECUTION);
             return;
         }
 
@@ -221,6 +322,8 @@ private:
     }
 
     void PerformRequestedCacheInvalidation() {
+        queued_cache_invalidations.Drain([this](const auto& range) { invalid_cache_ranges.add(range); });
+
         if (!invalidate_entire_cache && invalid_cache_ranges.empty()) {
             return;
         }
@@ -238,6 +341,7 @@ private:
 
     bool is_executing = false;
 
+    Jit* jit_interface;
     UserConfig conf;
     A64JitState jit_state;
     BlockOfCode block_of_code;
@@ -245,10 +349,17 @@ private:
 
     bool invalidate_entire_cache = false;
     boost::icl::interval_set<u64> invalid_cache_ranges;
+    // Invalidations requested by other threads, performed by the thread that runs this Jit.
+    Common::MPSCQueue<boost::icl::discrete_interval<u64>> queued_cache_invalidations;
 };
 
 Jit::Jit(UserConfig conf)
-    : impl(std::make_unique<Jit::Impl>(this, conf)) {}
+    : impl(std::make_unique<Jit::Impl>(this, conf))
+{
+    if (conf.translation_cache) {
+        conf.translation_cache->impl->Register(this);
+    }
+}
 
 Jit::~Jit() = default;
 
@@ -264,6 +375,18 @@ void Jit::InvalidateCacheRange(u64 start_address, size_t length) {
     impl->InvalidateCacheRange(start_address, length);
 }
 
+void Jit::QueueInvalidateCacheRange(u64 start_address, size_t length) {
+    impl->QueueInvalidateCacheRange(start_address, length);
+}
+
+void Jit::InvalidateTLB() {
+    impl->InvalidateTLB();
+}
+
+std::vector<u64> Jit::HarvestDirtyPages() {
+    return impl->HarvestDirtyPages();
+}
+
 void Jit::Reset() {
     impl->Reset();
 }
@@ -356,4 +479,8 @@ std::string Jit::Disassemble() const {
     return impl->Disassemble();
 }
 
+Jit::CodeStatistics Jit::GetCodeStatistics() const {
+    return impl->GetCodeStatistics();
+}
+
 } // namespace Dynarmic::A64
@@ -24,7 +24,7 @@ class BlockOfCode;
 struct A64JitState {
     using ProgramCounterType = u64;
 
-    A64JitState() { ResetRSB(); }
+    A64JitState() { ResetRSB(); ResetTLB(); }
 
     std::array<u64, 31> reg{};
     u64 sp = 0;
@@ -51,15 +51,21 @@ struct A64JitState {
     // For internal use (See: BlockOfCode::RunCode)
     u32 guest_MXCSR = 0x00001f80;
     u32 save_host_MXCSR = 0;
+    bool guest_MXCSR_loaded = false;
     s64 cycles_to_run = 0;
     s64 cycles_remaining = 0;
-    bool halt_requested = false;
+    // Non-zero requests that emitted code returns from RunCode at its next safepoint.
+    // May be set from another thread (See: common/atomic.h).
+    static constexpr u32 HALT_EXECUTION = 1 << 0;
+    static constexpr u32 HALT_FOR_QUEUED_INVALIDATION = 1 << 1;
+    volatile u32 halt_requested = 0;
     bool check_bit = false;
 
     // Exclusive state
     static constexpr u64 RESERVATION_GRANULE_MASK = 0xFFFF'FFFF'FFFF'FFF0ull;
     u8 exclusive_state = 0;
     u64 exclusive_address = 0;
+    std::array<u64, 2> exclusive_value{}; // Only used with UserConfig::inline_exclusive_access
 
     static constexpr size_t RSBSize = 8; // MUST be a power of 2.
     static constexpr size_t RSBPtrMask = RSBSize - 1;
@@ -71,6 +77,19 @@ struct A64JitState {
         rsb_codeptrs.fill(0);
     }
 
+    // Software TLB (See: UserConfig::enable_tlb)
+    static constexpr size_t TLBSize = 128; // MUST be a power of 2.
+    static constexpr size_t TLBIndexMask = TLBSize - 1;
+    struct TLBEntry {
+        u64 vpage;
+        u64 host_page;
+    };
+    static_assert(sizeof(TLBEntry) == 16);
+    std::array<TLBEntry, TLBSize> tlb;
+    void ResetTLB() {
+        tlb.fill({0xFFFFFFFFFFFFFFFFull, 0});
+    }
+
     u32 fpsr_exc = 0;
     u32 fpsr_qc = 0;
     u32 FPSCR_IDC = 0;
@@ -0,0 +1,305 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <boost/optional.hpp>
+
+#include <dynarmic/A64/a64.h>
+#include <dynarmic/A64/multicore_scheduler.h>
+
+#include "common/assert.h"
+#include "common/common_types.h"
+
+namespace Dynarmic::A64 {
+
+struct MultiCoreScheduler::Impl final {
+    enum class CoreStatus {
+        /// Waiting in a run queue for a host thread.
+        Runnable,
+        /// Being run by a host thread.
+        Running,
+        /// Parked until woken by an interrupt or event.
+        Waiting,
+    };
+
+    enum class WaitReason {
+        None,
+        Interrupt,
+        Event,
+    };
+
+    struct Core {
+        Jit* jit = nullptr;
+        // Only changed to or from Waiting with state_mutex held.
+        std::atomic<CoreStatus> status{CoreStatus::Runnable};
+        // Only changed by the host thread running this core, or with state_mutex held while it is waiting.
+        WaitReason wait = WaitReason::None;
+        // Protected by state_mutex.
+        bool event_register = false;
+        bool interrupt_pending = false;
+        // Only accessed by the host thread running this core.
+        u64 ticks_remaining = 0;
+    };
+
+    /// Each host thread's run queue has its own lock, so threads only contend when one steals from another.
+    struct alignas(64) RunQueue {
+        std::mutex mutex;
+        std::deque<size_t> cores;
+    };
+
+    Impl(std::vector<Jit*> jits, size_t host_thread_count, u64 quantum)
+        : quantum(quantum)
+        , cores(jits.size())
+        , run_queues(host_thread_count)
+    {
+        ASSERT(host_thread_count > 0);
+        ASSERT(quantum > 0);
+
+        for (size_t i = 0; i < jits.size(); i++) {
+            cores[i].jit = jits[i];
+            Enqueue(i % host_thread_count, i);
+        }
+    }
+
+    void Run() {
+        {
+            std::lock_guard lock{state_mutex};
+            ASSERT(!is_running);
+            is_running = true;
+        }
+
+        std::vector<std::thread> host_threads;
+        for (size_t i = 1; i < run_queues.size(); i++) {
+            host_threads.emplace_back([this, i] { HostThread(i); });
+        }
+        HostThread(0);
+        for (auto& host_thread : host_threads) {
+            host_thread.join();
+        }
+
+        std::lock_guard lock{state_mutex};
+        is_running = false;
+        stop_requested = false;
+    }
+
+    void Stop() {
+        stop_requested = true;
+        for (auto& core : cores) {
+            if (core.status == CoreStatus::Running) {
+                core.jit->HaltExecution();
+            }
+        }
+
+        std::lock_guard lock{state_mutex};
+        work_available.notify_all();
+    }
+
+    void SignalInterrupt(size_t core_index) {
+        std::lock_guard lock{state_mutex};
+        cores[core_index].interrupt_pending = true;
+        Wake(core_index);
+    }
+
+    void AddTicks(size_t core_index, u64 ticks) {
+        Core& core = cores[core_index];
+        core.ticks_remaining -= std::min(ticks, core.ticks_remaining);
+    }
+
+    u64 GetTicksRemaining(size_t core_index) const {
+        return cores[core_index].ticks_remaining;
+    }
+
+    bool ExceptionRaised(size_t core_index, Exception exception) {
+        Core& core = cores[core_index];
+
+        switch (exception) {
+        case Exception::WaitForInterrupt:
+        case Exception::WaitForEvent: {
+            std::lock_guard lock{state_mutex};
+            core.wait = exception == Exception::WaitForInterrupt ? WaitReason::Interrupt : WaitReason::Event;
+            if (!ConsumeWakeup(core)) {
+                // The core is parked by its host thread once it has stopped.
+                core.jit->HaltExecution();
+            }
+            return true;
+        }
+        case Exception::SendEvent: {
+            std::lock_guard lock{state_mutex};
+            for (size_t i = 0; i < cores.size(); i++) {
+                cores[i].event_register = true;
+                Wake(i);
+            }
+            return true;
+        }
+        case Exception::SendEventLocal: {
+            std::lock_guard lock{state_mutex};
+            core.event_register = true;
+            return true;
+        }
+        case Exception::Yield:
+            core.jit->HaltExecution();
+            return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    void HostThread(size_t thread_index) {
+        while (!stop_requested) {
+            const auto core_index = PopRunnableCore(thread_index);
+            if (!core_index) {
+                WaitForWork();
+                continue;
+            }
+
+            Core& core = cores[*core_index];
+            core.status = CoreStatus::Running;
+            if (stop_requested) {
+                // Stop may have looked for running cores before this one was marked as running.
+                core.status = CoreStatus::Runnable;
+                Enqueue(thread_index, *core_index);
+                break;
+            }
+
+            core.ticks_remaining = quantum;
+            core.jit->Run();
+
+            if (core.wait != WaitReason::None) {
+                std::lock_guard lock{state_mutex};
+                if (!ConsumeWakeup(core)) {
+                    core.status = CoreStatus::Waiting;
+                    continue;
+                }
+            }
+
+            core.status = CoreStatus::Runnable;
+            Enqueue(thread_index, *core_index);
+            if (sleeping_thread_count > 0) {
+                std::lock_guard lock{state_mutex};
+                work_available.notify_one();
+            }
+        }
+    }
+
+    /// Takes the next core from this thread's own run queue, or steals one from another thread's.
+    boost::optional<size_t> PopRunnableCore(size_t thread_index) {
+        for (size_t i = 0; i < run_queues.size(); i++) {
+            auto& queue = run_queues[(thread_index + i) % run_queues.size()];
+            std::lock_guard lock{queue.mutex};
+            if (queue.cores.empty()) {
+                continue;
+            }
+
+            // Cores are stolen from the back, away from where their owner takes them.
+            size_t core_index;
+            if (i == 0) {
+                core_index = queue.cores.front();
+                queue.cores.pop_front();
+            } else {
+                core_index = queue.cores.back();
+                queue.cores.pop_back();
+            }
+            runnable_count--;
+            return core_index;
+        }
+
+        return boost::none;
+    }
+
+    void Enqueue(size_t queue_index, size_t core_index) {
+        auto& queue = run_queues[queue_index];
+        std::lock_guard lock{queue.mutex};
+        queue.cores.push_back(core_index);
+        // Counted under the queue's lock, so it never goes below zero when the core is taken straight away.
+        runnable_count++;
+    }
+
+    void WaitForWork() {
+        std::unique_lock lock{state_mutex};
+        // Paired with the check of sleeping_thread_count after a core is enqueued, so that either the
+        // enqueuing thread sees this one sleeping and notifies it, or this one sees the enqueued core.
+        sleeping_thread_count++;
+        work_available.wait(lock, [this] { return runnable_count > 0 || stop_requested; });
+        sleeping_thread_count--;
+    }
+
+    /// Consumes a pending wakeup for the reason core is waiting on, if there is one.
+    static bool ConsumeWakeup(Core& core) {
+        if (core.interrupt_pending) {
+            core.interrupt_pending = false;
+        } else if (core.wait == WaitReason::Event && core.event_register) {
+            core.event_register = false;
+        } else {
+            return false;
+        }
+
+        core.wait = WaitReason::None;
+        return true;
+    }
+
+    /// Must be called with state_mutex held.
+    void Wake(size_t core_index) {
+        Core& core = cores[core_index];
+        if (core.status != CoreStatus::Waiting || !ConsumeWakeup(core)) {
+            return;
+        }
+
+        core.status = CoreStatus::Runnable;
+        Enqueue(core_index % run_queues.size(), core_index);
+        work_available.notify_one();
+    }
+
+    const u64 quantum;
+
+    std::vector<Core> cores;
+    std::vector<RunQueue> run_queues;
+    std::atomic<size_t> runnable_count{0};
+    std::atomic<bool> stop_requested{false};
+
+    // Protects parking and waking cores, and is_running. Idle host threads sleep on work_available.
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::atomic<size_t> sleeping_thread_count{0};
+    bool is_running = false;
+};
+
+MultiCoreScheduler::MultiCoreScheduler(std::vector<Jit*> cores, size_t host_thread_count, u64 quantum)
+    : impl(std::make_unique<Impl>(std::move(cores), host_thread_count, quantum)) {}
+
+MultiCoreScheduler::~MultiCoreScheduler() = default;
+
+void MultiCoreScheduler::Run() {
+    impl->Run();
+}
+
+void MultiCoreScheduler::Stop() {
+    impl->Stop();
+}
+
+void MultiCoreScheduler::SignalInterrupt(size_t core_index) {
+    impl->SignalInterrupt(core_index);
+}
+
+void MultiCoreScheduler::AddTicks(size_t core_index, u64 ticks) {
+    impl->AddTicks(core_index, ticks);
+}
+
+u64 MultiCoreScheduler::GetTicksRemaining(size_t core_index) const {
+    return impl->GetTicksRemaining(core_index);
+}
+
+bool MultiCoreScheduler::ExceptionRaised(size_t core_index, Exception exception) {
+    return impl->ExceptionRaised(core_index, exception);
+}
+
+} // namespace Dynarmic::A64
@@ -0,0 +1,128 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include <algorithm>
+
+#include "backend/x64/a64_translation_cache.h"
+#include "common/assert.h"
+#include "dynarmic/A64/a64.h"
+#include "frontend/A64/location_descriptor.h"
+
+namespace Dynarmic::A64 {
+
+// Approximates the memory used by a cached translation. A copied block's memory pool only holds its instructions.
+static size_t TranslationSize(const IR::Block& block) {
+    return sizeof(IR::Block) + block.size() * sizeof(IR::Inst);
+}
+
+TranslationCache::Impl::Impl(size_t max_size) : max_size(max_size) {
+    ASSERT(max_size > 0);
+}
+
+boost::optional<IR::Block> TranslationCache::Impl::Lookup(IR::LocationDescriptor location) const {
+    std::shared_ptr<const IR::Block> block;
+    {
+        std::shared_lock lock{blocks_mutex};
+
+        const auto iter = blocks.find(location);
+        if (iter == blocks.end()) {
+            return boost::none;
+        }
+        block = iter->second;
+    }
+    return *block;
+}
+
+u64 TranslationCache::Impl::Generation() const {
+    std::shared_lock lock{blocks_mutex};
+    return generation;
+}
+
+void TranslationCache::Impl::Insert(const IR::Block& block, u64 block_generation) {
+    // The copy is made before locking, so that lookups by other Jits are not held up by it.
+    auto cached_block = std::make_shared<const IR::Block>(block);
+    const size_t block_size = TranslationSize(block);
+
+    std::unique_lock lock{blocks_mutex};
+
+    if (block_generation != generation) {
+        return;
+    }
+
+    if (blocks.count(block.Location()) != 0) {
+        return;
+    }
+
+    if (!blocks.empty() && size + block_size > max_size) {
+        // Discarding translations does not make in-flight translations stale, so the generation is kept.
+        blocks.clear();
+        block_ranges.ClearCache();
+        size = 0;
+    }
+
+    blocks.emplace(block.Location(), std::move(cached_block));
+    size += block_size;
+
+    const A64::LocationDescriptor descriptor{block.Location()};
+    const A64::LocationDescriptor end_location{block.EndLocation()};
+    const auto range = boost::icl::discrete_interval<u64>::closed(descriptor.PC(), end_location.PC() - 1);
+    block_ranges.AddRange(range, descriptor);
+}
+
+void TranslationCache::Impl::InvalidateTranslations(const boost::icl::interval_set<u64>& ranges) {
+    std::unique_lock lock{blocks_mutex};
+
+    generation++;
+    for (const auto& location : block_ranges.InvalidateRanges(ranges)) {
+        const auto iter = blocks.find(location);
+        if (iter != blocks.end()) {
+            size -= TranslationSize(*iter->second);
+            blocks.erase(iter);
+        }
+    }
+}
+
+void TranslationCache::Impl::ClearTranslations() {
+    std::unique_lock lock{blocks_mutex};
+
+    generation++;
+    blocks.clear();
+    block_ranges.ClearCache();
+    size = 0;
+}
+
+void TranslationCache::Impl::Register(Jit* jit) {
+    std::lock_guard lock{jits_mutex};
+    jits.emplace_back(jit);
+}
+
+void TranslationCache::Impl::Unregister(Jit* jit) {
+    std::lock_guard lock{jits_mutex};
+
+    const auto iter = std::find(jits.begin(), jits.end(), jit);
+    ASSERT(iter != jits.end());
+    jits.erase(iter);
+}
+
+void TranslationCache::Impl::QueueInvalidateCacheRange(u64 start_address, size_t length) {
+    std::lock_guard lock{jits_mutex};
+
+    const auto end_address = static_cast<u64>(start_address + length - 1);
+    InvalidateTranslations(boost::icl::interval_set<u64>{boost::icl::discrete_interval<u64>::closed(start_address, end_address)});
+    for (Jit* jit : jits) {
+        jit->QueueInvalidateCacheRange(start_address, length);
+    }
+}
+
+TranslationCache::TranslationCache(size_t max_size) : impl(std::make_unique<Impl>(max_size)) {}
+
+TranslationCache::~TranslationCache() = default;
+
+void TranslationCache::InvalidateCacheRange(u64 start_address, size_t length) {
+    impl->QueueInvalidateCacheRange(start_address, length);
+}
+
+} // namespace Dynarmic::A64
@@ -0,0 +1,62 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/icl/interval_set.hpp>
+#include <boost/optional.hpp>
+
+#include <dynarmic/A64/translation_cache.h>
+
+#include "backend/x64/block_range_information.h"
+#include "common/common_types.h"
+#include "frontend/ir/basic_block.h"
+#include "frontend/ir/location_descriptor.h"
+
+namespace Dynarmic::A64 {
+
+struct TranslationCache::Impl {
+    explicit Impl(size_t max_size);
+
+    /// Returns a copy of the cached translation of the block at location, if there is one.
+    boost::optional<IR::Block> Lookup(IR::LocationDescriptor location) const;
+
+    /// Read this before translating a block which is to be passed to Insert.
+    u64 Generation() const;
+    /// Caches a translated block. The block is discarded if any invalidation has occured since
+    /// generation was read, as it may have been translated from stale guest code.
+    void Insert(const IR::Block& block, u64 generation);
+
+    void InvalidateTranslations(const boost::icl::interval_set<u64>& ranges);
+    void ClearTranslations();
+
+    void Register(Jit* jit);
+    void Unregister(Jit* jit);
+    void QueueInvalidateCacheRange(u64 start_address, size_t length);
+
+private:
+    const size_t max_size;
+
+    mutable std::shared_mutex blocks_mutex;
+    u64 generation = 0;
+    /// Memory used by the translations in blocks, in bytes.
+    size_t size = 0;
+    // Blocks are shared so that Lookup can copy them without holding blocks_mutex.
+    std::unordered_map<IR::LocationDescriptor, std::shared_ptr<const IR::Block>> blocks;
+    BackendX64::BlockRangeInformation<u64> block_ranges;
+
+    // Always acquired before blocks_mutex.
+    std::mutex jits_mutex;
+    std::vector<Jit*> jits;
+};
+
+} // namespace Dynarmic::A64
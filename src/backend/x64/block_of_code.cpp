@@ -158,7 +158,7 @@ void BlockOfCode::ForceReturnFromRunCode(bool mxcsr_already_exited) {
 }
 
 void BlockOfCode::GenRunCode() {
-    Xbyak::Label loop, enter_mxcsr_then_loop;
+    Xbyak::Label loop;
 
     align();
     run_code_from = getCurr<RunCodeFromFuncType>();
@@ -166,14 +166,16 @@ void BlockOfCode::GenRunCode() {
     ABI_PushCalleeSaveRegistersAndAdjustStack(*this);
 
     mov(r15, ABI_PARAM1);
-    mov(r14, ABI_PARAM2); // save temporarily in non-volatile register
+    mov(rbx, ABI_PARAM2); // save temporarily in non-volatile register
+    ReloadPinnedRegisters();
 
-    cb.GetTicksRemaining->EmitCall(*this);
-    mov(qword[r15 + jsi.offsetof_cycles_to_run], ABI_RETURN);
-    mov(qword[r15 + jsi.offsetof_cycles_remaining], ABI_RETURN);
+    if (!cb.cycle_counter) {
+        cb.GetTicksRemaining->EmitCall(*this);
+        mov(qword[r15 + jsi.offsetof_cycles_to_run], ABI_RETURN);
+        mov(qword[r15 + jsi.offsetof_cycles_remaining], ABI_RETURN);
+    }
 
-    SwitchMxcsrOnEntry();
-    jmp(r14);
+    jmp(rbx);
 
     align();
     run_code = getCurr<RunCodeFuncType>();
@@ -185,34 +187,42 @@ void BlockOfCode::GenRunCode() {
     ABI_PushCalleeSaveRegistersAndAdjustStack(*this);
 
     mov(r15, ABI_PARAM1);
+    ReloadPinnedRegisters();
 
-    cb.GetTicksRemaining->EmitCall(*this);
-    mov(qword[r15 + jsi.offsetof_cycles_to_run], ABI_RETURN);
-    mov(qword[r15 + jsi.offsetof_cycles_remaining], ABI_RETURN);
+    if (!cb.cycle_counter) {
+        cb.GetTicksRemaining->EmitCall(*this);
+        mov(qword[r15 + jsi.offsetof_cycles_to_run], ABI_RETURN);
+        mov(qword[r15 + jsi.offsetof_cycles_remaining], ABI_RETURN);
+    }
 
-    L(enter_mxcsr_then_loop);
-    SwitchMxcsrOnEntry();
     L(loop);
     cb.LookupBlock->EmitCall(*this);
 
     jmp(ABI_RETURN);
 
     // Return from run code variants
-    const auto emit_return_from_run_code = [this, &loop, &enter_mxcsr_then_loop](bool mxcsr_already_exited, bool force_return){
+    const auto emit_return_from_run_code = [this, &loop](bool mxcsr_already_exited, bool force_return){
         if (!force_return) {
-            cmp(qword[r15 + jsi.offsetof_cycles_remaining], 0);
-            jg(mxcsr_already_exited ? enter_mxcsr_then_loop : loop);
+            Xbyak::Label return_to_caller;
+            cmp(dword[r15 + jsi.offsetof_halt_requested], 0);
+            jne(return_to_caller);
+            CompareCyclesRemaining();
+            jg(loop);
+            L(return_to_caller);
         }
 
         if (!mxcsr_already_exited) {
             SwitchMxcsrOnExit();
         }
 
-        cb.AddTicks->EmitCall(*this, [this](RegList param) {
-            mov(param[0], qword[r15 + jsi.offsetof_cycles_to_run]);
-            sub(param[0], qword[r15 + jsi.offsetof_cycles_remaining]);
-        });
+        if (!cb.cycle_counter) {
+            cb.AddTicks->EmitCall(*this, [this](RegList param) {
+                mov(param[0], qword[r15 + jsi.offsetof_cycles_to_run]);
+                sub(param[0], qword[r15 + jsi.offsetof_cycles_remaining]);
+            });
+        }
 
+        FlushPinnedRegisters();
         ABI_PopCalleeSaveRegistersAndAdjustStack(*this);
         ret();
     };
@@ -237,16 +247,37 @@ void BlockOfCode::GenRunCode() {
 }
 
 void BlockOfCode::SwitchMxcsrOnEntry() {
+    Xbyak::Label end;
+
+    cmp(byte[r15 + jsi.offsetof_guest_MXCSR_loaded], 0);
+    jne(end);
     stmxcsr(dword[r15 + jsi.offsetof_save_host_MXCSR]);
     ldmxcsr(dword[r15 + jsi.offsetof_guest_MXCSR]);
+    mov(byte[r15 + jsi.offsetof_guest_MXCSR_loaded], 1);
+    L(end);
 }
 
 void BlockOfCode::SwitchMxcsrOnExit() {
+    Xbyak::Label end;
+
+    cmp(byte[r15 + jsi.offsetof_guest_MXCSR_loaded], 0);
+    je(end);
     stmxcsr(dword[r15 + jsi.offsetof_guest_MXCSR]);
+    mov(byte[r15 + jsi.offsetof_guest_MXCSR_loaded], 0);
+    // ldmxcsr is expensive, so avoid it when the guest did not change the MXCSR.
+    mov(eax, dword[r15 + jsi.offsetof_guest_MXCSR]);
+    cmp(eax, dword[r15 + jsi.offsetof_save_host_MXCSR]);
+    je(end);
     ldmxcsr(dword[r15 + jsi.offsetof_save_host_MXCSR]);
+    L(end);
 }
 
 void BlockOfCode::UpdateTicks() {
+    if (cb.cycle_counter) {
+        // *cycle_counter is always up to date.
+        return;
+    }
+
     cb.AddTicks->EmitCall(*this, [this](RegList param) {
         mov(param[0], qword[r15 + jsi.offsetof_cycles_to_run]);
         sub(param[0], qword[r15 + jsi.offsetof_cycles_remaining]);
@@ -257,10 +288,46 @@ void BlockOfCode::UpdateTicks() {
     mov(qword[r15 + jsi.offsetof_cycles_remaining], ABI_RETURN);
 }
 
+void BlockOfCode::AddCycles(size_t cycles) {
+    ASSERT(cycles < std::numeric_limits<u32>::max());
+
+    if (cb.cycle_counter) {
+        mov(rax, reinterpret_cast<u64>(cb.cycle_counter));
+        add(qword[rax], static_cast<u32>(cycles));
+        return;
+    }
+
+    sub(qword[r15 + jsi.offsetof_cycles_remaining], static_cast<u32>(cycles));
+}
+
+void BlockOfCode::CompareCyclesRemaining() {
+    if (cb.cycle_counter) {
+        mov(rax, reinterpret_cast<u64>(cb.cycle_deadline));
+        mov(rax, qword[rax]);
+        mov(rcx, reinterpret_cast<u64>(cb.cycle_counter));
+        cmp(rax, qword[rcx]);
+        return;
+    }
+
+    cmp(qword[r15 + jsi.offsetof_cycles_remaining], 0);
+}
+
 void BlockOfCode::LookupBlock() {
     cb.LookupBlock->EmitCall(*this);
 }
 
+void BlockOfCode::FlushPinnedRegisters() {
+    for (const auto& [reg, offset] : cb.pinned_registers) {
+        mov(qword[r15 + offset], reg);
+    }
+}
+
+void BlockOfCode::ReloadPinnedRegisters() {
+    for (const auto& [reg, offset] : cb.pinned_registers) {
+        mov(reg, qword[r15 + offset]);
+    }
+}
+
 Xbyak::Address BlockOfCode::MConst(const Xbyak::AddressFrame& frame, u64 lower, u64 upper) {
     return constant_pool.GetConstant(frame, lower, upper);
 }
@@ -287,6 +354,13 @@ CodePtr BlockOfCode::GetCodeBegin() const {
     return near_code_begin;
 }
 
+size_t BlockOfCode::GetEmittedCodeSize() const {
+    ASSERT(prelude_complete);
+    const auto near_code_end = static_cast<const u8*>(in_far_code ? near_code_ptr : getCurr());
+    const auto far_code_end = static_cast<const u8*>(in_far_code ? getCurr() : far_code_ptr);
+    return static_cast<size_t>((near_code_end - static_cast<const u8*>(near_code_begin)) + (far_code_end - static_cast<const u8*>(far_code_begin)));
+}
+
 void* BlockOfCode::AllocateFromCodeSpace(size_t alloc_size) {
     if (size_ + alloc_size >= maxSize_) {
         throw Xbyak::Error(Xbyak::ERR_CODE_IS_TOO_BIG);
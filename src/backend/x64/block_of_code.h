@@ -9,6 +9,8 @@
 #include <array>
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <xbyak.h>
 #include <xbyak_util.h>
@@ -26,6 +28,13 @@ struct RunCodeCallbacks {
     std::unique_ptr<Callback> LookupBlock;
     std::unique_ptr<Callback> AddTicks;
     std::unique_ptr<Callback> GetTicksRemaining;
+    // If cycle_counter is not null, ticks are accounted for inline against *cycle_deadline
+    // and AddTicks and GetTicksRemaining are never called.
+    u64* cycle_counter = nullptr;
+    const u64* cycle_deadline = nullptr;
+    // Host registers which hold a piece of guest state for the whole of RunCode, paired with the
+    // offset of that state in the JitState. The JitState copy is only up to date during host calls.
+    std::vector<std::pair<Xbyak::Reg64, size_t>> pinned_registers = {};
 };
 
 class BlockOfCode final : public Xbyak::CodeGenerator {
@@ -52,16 +61,28 @@ public:
     void ReturnFromRunCode(bool mxcsr_already_exited = false);
     /// Code emitter: Returns to dispatcher, forces return to host
     void ForceReturnFromRunCode(bool mxcsr_already_exited = false);
-    /// Code emitter: Makes guest MXCSR the current MXCSR
+    /// Code emitter: Makes guest MXCSR the current MXCSR, unless it already is
+    /// @note The guest MXCSR is only switched to by blocks which need it (See: EmitX64::BlockUsesGuestMxcsr)
     void SwitchMxcsrOnEntry();
-    /// Code emitter: Makes saved host MXCSR the current MXCSR
+    /// Code emitter: Makes saved host MXCSR the current MXCSR, if the guest MXCSR was switched to
+    /// @note this clobbers eax
     void SwitchMxcsrOnExit();
     /// Code emitter: Updates cycles remaining my calling cb.AddTicks and cb.GetTicksRemaining
     /// @note this clobbers ABI caller-save registers
     void UpdateTicks();
+    /// Code emitter: Accounts for cycles having been executed
+    /// @note this clobbers rax if ticks are accounted for inline
+    void AddCycles(size_t cycles);
+    /// Code emitter: Sets flags such that jg is taken if there are cycles remaining
+    /// @note this clobbers rax and rcx if ticks are accounted for inline
+    void CompareCyclesRemaining();
     /// Code emitter: Performs a block lookup based on current state
     /// @note this clobbers ABI caller-save registers
     void LookupBlock();
+    /// Code emitter: Writes pinned registers back to the JitState
+    void FlushPinnedRegisters();
+    /// Code emitter: Loads pinned registers from the JitState
+    void ReloadPinnedRegisters();
 
     /// Code emitter: Calls the function
     template <typename FunctionPointer>
@@ -69,6 +90,9 @@ public:
         static_assert(std::is_pointer<FunctionPointer>() && std::is_function<std::remove_pointer_t<FunctionPointer>>(),
                       "Supplied type must be a pointer to a function");
 
+        // The callee may inspect or modify guest state.
+        FlushPinnedRegisters();
+
         const u64 address  = reinterpret_cast<u64>(fn);
         const u64 distance = address - (getCurr<u64>() + 5);
 
@@ -79,6 +103,8 @@ public:
         } else {
             call(fn);
         }
+
+        ReloadPinnedRegisters();
     }
 
     Xbyak::Address MConst(const Xbyak::AddressFrame& frame, u64 lower, u64 upper = 0);
@@ -89,6 +115,8 @@ public:
     void SwitchToNearCode();
 
     CodePtr GetCodeBegin() const;
+    /// Size in bytes of the near and far code emitted since the cache was last cleared.
+    size_t GetEmittedCodeSize() const;
 
     const void* GetReturnFromRunCodeAddress() const {
         return return_from_run_code[0];
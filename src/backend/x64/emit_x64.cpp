@@ -4,6 +4,7 @@
  * General Public License version 2 or any later version.
  */
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -115,6 +116,10 @@ void EmitX64::EmitGetLowerFromOp(EmitContext&, IR::Inst*) {
     ASSERT_MSG(false, "should never happen");
 }
 
+void EmitX64::EmitGetSecondFromOp(EmitContext&, IR::Inst*) {
+    ASSERT_MSG(false, "should never happen");
+}
+
 void EmitX64::EmitGetNZCVFromOp(EmitContext& ctx, IR::Inst* inst) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
 
@@ -140,6 +145,7 @@ void EmitX64::EmitGetNZCVFromOp(EmitContext& ctx, IR::Inst* inst) {
     code.lahf();
     code.seto(code.al);
     ctx.reg_alloc.DefineValue(inst, nzcv);
+    ctx.reg_alloc.DefineValueInHostFlags(inst);
 }
 
 void EmitX64::EmitNZCVFromPackedFlags(EmitContext& ctx, IR::Inst* inst) {
@@ -165,8 +171,7 @@ void EmitX64::EmitNZCVFromPackedFlags(EmitContext& ctx, IR::Inst* inst) {
 }
 
 void EmitX64::EmitAddCycles(size_t cycles) {
-    ASSERT(cycles < std::numeric_limits<u32>::max());
-    code.sub(qword[r15 + code.GetJitStateInfo().offsetof_cycles_remaining], static_cast<u32>(cycles));
+    code.AddCycles(cycles);
 }
 
 Xbyak::Label EmitX64::EmitCond(IR::Cond cond) {
@@ -281,6 +286,62 @@ Xbyak::Label EmitX64::EmitCond(IR::Cond cond) {
     return label;
 }
 
+Xbyak::Label EmitX64::EmitCondFromHostFlags(IR::Cond cond) {
+    Xbyak::Label label;
+
+    switch (cond) {
+    case IR::Cond::EQ: //z
+        code.jz(label);
+        break;
+    case IR::Cond::NE: //!z
+        code.jnz(label);
+        break;
+    case IR::Cond::CS: //c
+        code.jc(label);
+        break;
+    case IR::Cond::CC: //!c
+        code.jnc(label);
+        break;
+    case IR::Cond::MI: //n
+        code.js(label);
+        break;
+    case IR::Cond::PL: //!n
+        code.jns(label);
+        break;
+    case IR::Cond::VS: //v
+        code.jo(label);
+        break;
+    case IR::Cond::VC: //!v
+        code.jno(label);
+        break;
+    case IR::Cond::HI: //c & !z
+        code.cmc();
+        code.ja(label);
+        break;
+    case IR::Cond::LS: //!c | z
+        code.cmc();
+        code.jna(label);
+        break;
+    case IR::Cond::GE: // n == v
+        code.jge(label);
+        break;
+    case IR::Cond::LT: // n != v
+        code.jl(label);
+        break;
+    case IR::Cond::GT: // !z & (n == v)
+        code.jg(label);
+        break;
+    case IR::Cond::LE: // z | (n != v)
+        code.jle(label);
+        break;
+    default:
+        ASSERT_MSG(false, "Unknown cond {}", static_cast<size_t>(cond));
+        break;
+    }
+
+    return label;
+}
+
 void EmitX64::EmitCondPrelude(const IR::Block& block) {
     if (block.GetCondition() == IR::Cond::AL) {
         ASSERT(!block.HasConditionFailedLocation());
@@ -295,6 +356,12 @@ void EmitX64::EmitCondPrelude(const IR::Block& block) {
     code.L(pass);
 }
 
+bool EmitX64::BlockUsesGuestMxcsr(const IR::Block& block) {
+    return std::any_of(block.begin(), block.end(), [](const IR::Inst& inst) {
+        return inst.ReadsFromAndWritesToMXCSR();
+    });
+}
+
 EmitX64::BlockDescriptor EmitX64::RegisterBlock(const IR::LocationDescriptor& descriptor, CodePtr entrypoint, size_t size) {
     PerfMapRegister(entrypoint, code.getCurr(), LocationDescriptorToFriendlyName(descriptor));
     Patch(descriptor, entrypoint);
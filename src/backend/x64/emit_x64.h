@@ -89,7 +89,12 @@ protected:
     virtual std::string LocationDescriptorToFriendlyName(const IR::LocationDescriptor&) const = 0;
     void EmitAddCycles(size_t cycles);
     Xbyak::Label EmitCond(IR::Cond cond);
+    /// As EmitCond, but with the guest NZCV taken from the host flags. The host flags may be modified.
+    Xbyak::Label EmitCondFromHostFlags(IR::Cond cond);
     void EmitCondPrelude(const IR::Block& block);
+    /// Whether the block contains instructions which must run under the guest MXCSR.
+    /// Other blocks leave whichever MXCSR happens to be current untouched.
+    static bool BlockUsesGuestMxcsr(const IR::Block& block);
     BlockDescriptor RegisterBlock(const IR::LocationDescriptor& location_descriptor, CodePtr entrypoint, size_t size);
     void PushRSBHelper(Xbyak::Reg64 loc_desc_reg, Xbyak::Reg64 index_reg, IR::LocationDescriptor target);
 
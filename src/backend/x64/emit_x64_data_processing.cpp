@@ -119,17 +119,26 @@ void EmitX64::EmitTestBit(EmitContext& ctx, IR::Inst* inst) {
 
 static void EmitConditionalSelect(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, int bitsize) {
     auto args = ctx.reg_alloc.GetArgumentInfo(inst);
-    Xbyak::Reg32 nzcv = ctx.reg_alloc.ScratchGpr({HostLoc::RAX}).cvt32();
+
+    // Loading an immediate of zero may clobber the host flags.
+    const bool nzcv_in_host_flags = ctx.reg_alloc.IsGuestNZCVInHostFlags() && !args[1].IsImmediate() && !args[2].IsImmediate();
+
+    boost::optional<Xbyak::Reg32> nzcv;
+    if (!nzcv_in_host_flags) {
+        nzcv = ctx.reg_alloc.ScratchGpr({HostLoc::RAX}).cvt32();
+    }
     Xbyak::Reg then_ = ctx.reg_alloc.UseGpr(args[1]).changeBit(bitsize);
     Xbyak::Reg else_ = ctx.reg_alloc.UseScratchGpr(args[2]).changeBit(bitsize);
 
-    code.mov(nzcv, dword[r15 + code.GetJitStateInfo().offsetof_CPSR_nzcv]);
-    // TODO: Flag optimization
-    code.shr(nzcv, 28);
-    code.imul(nzcv, nzcv, 0b00010000'10000001);
-    code.and_(nzcv.cvt8(), 1);
-    code.add(nzcv.cvt8(), 0x7F); // restore OF
-    code.sahf(); // restore SF, ZF, CF
+    if (nzcv) {
+        code.mov(*nzcv, dword[r15 + code.GetJitStateInfo().offsetof_CPSR_nzcv]);
+        code.shr(*nzcv, 28);
+        code.imul(*nzcv, *nzcv, 0b00010000'10000001);
+        code.and_(nzcv->cvt8(), 1);
+        code.add(nzcv->cvt8(), 0x7F); // restore OF
+        code.sahf(); // restore SF, ZF, CF
+        ctx.reg_alloc.ClobberHostFlags();
+    }
 
     switch (args[0].GetImmediateCond()) {
     case IR::Cond::EQ: //z
@@ -159,10 +168,16 @@ static void EmitConditionalSelect(BlockOfCode& code, EmitContext& ctx, IR::Inst*
     case IR::Cond::HI: //c & !z
         code.cmc();
         code.cmova(else_, then_);
+        if (nzcv_in_host_flags) {
+            code.cmc();
+        }
         break;
     case IR::Cond::LS: //!c | z
         code.cmc();
         code.cmovna(else_, then_);
+        if (nzcv_in_host_flags) {
+            code.cmc();
+        }
         break;
     case IR::Cond::GE: // n == v
         code.cmovge(else_, then_);
@@ -793,6 +808,7 @@ static void EmitAdd(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, int bit
         code.lahf();
         code.seto(code.al);
         ctx.reg_alloc.DefineValue(nzcv_inst, nzcv);
+        ctx.reg_alloc.DefineValueInHostFlags(nzcv_inst);
         ctx.EraseInstruction(nzcv_inst);
     }
     if (carry_inst) {
@@ -870,6 +886,7 @@ static void EmitSub(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, int bit
         code.lahf();
         code.seto(code.al);
         ctx.reg_alloc.DefineValue(nzcv_inst, nzcv);
+        ctx.reg_alloc.DefineValueInHostFlags(nzcv_inst);
         ctx.EraseInstruction(nzcv_inst);
     }
     if (carry_inst) {
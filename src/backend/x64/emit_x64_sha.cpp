@@ -0,0 +1,142 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include "backend/x64/block_of_code.h"
+#include "backend/x64/emit_x64.h"
+#include "common/assert.h"
+#include "common/common_types.h"
+#include "frontend/ir/microinstruction.h"
+#include "frontend/ir/opcodes.h"
+
+// The SHA IR instructions are only emitted by the frontends when the host supports the SHA
+// extensions (see TranslationOptions::emit_sha_ir_instructions). Otherwise the frontends expand
+// the guest instructions into generic IR instructions, so there is no fallback here.
+//
+// The x86 SHA instructions hold the words of the hash state in the opposite order to the ARM
+// instructions (e.g. A is the most significant word of ABCD), so some operands are reversed.
+
+namespace Dynarmic::BackendX64 {
+
+using namespace Xbyak::util;
+
+// Reverses the order of the four words of a vector.
+constexpr u8 reverse_words = 0b00011011;
+
+static void EmitSHA1HashUpdate(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, u8 function, u32 round_constant) {
+    ASSERT(code.DoesCpuSupport(Xbyak::util::Cpu::tSHA));
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm x = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Reg32 y = ctx.reg_alloc.UseGpr(args[1]).cvt32();
+    const Xbyak::Xmm w = ctx.reg_alloc.UseScratchXmm(args[2]);
+    const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+
+    // The guest supplies W + K, while sha1rnds4 adds K itself. E is added to the first word.
+    const u64 negated_round_constant = static_cast<u32>(0 - round_constant);
+    code.movd(tmp, y);
+    code.paddd(w, tmp);
+    code.paddd(w, code.MConst(xword, negated_round_constant | (negated_round_constant << 32), negated_round_constant | (negated_round_constant << 32)));
+
+    code.pshufd(x, x, reverse_words);
+    code.pshufd(w, w, reverse_words);
+    code.sha1rnds4(x, w, function);
+    code.pshufd(x, x, reverse_words);
+
+    ctx.reg_alloc.DefineValue(inst, x);
+}
+
+void EmitX64::EmitSHA1HashUpdateChoose(EmitContext& ctx, IR::Inst* inst) {
+    EmitSHA1HashUpdate(code, ctx, inst, 0, 0x5A827999);
+}
+
+void EmitX64::EmitSHA1HashUpdateMajority(EmitContext& ctx, IR::Inst* inst) {
+    EmitSHA1HashUpdate(code, ctx, inst, 2, 0x8F1BBCDC);
+}
+
+void EmitX64::EmitSHA1HashUpdateParity(EmitContext& ctx, IR::Inst* inst) {
+    EmitSHA1HashUpdate(code, ctx, inst, 1, 0x6ED9EBA1);
+}
+
+void EmitX64::EmitSHA1ScheduleUpdate1(EmitContext& ctx, IR::Inst* inst) {
+    ASSERT(code.DoesCpuSupport(Xbyak::util::Cpu::tSHA));
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm d = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm n = ctx.reg_alloc.UseScratchXmm(args[1]);
+
+    code.pshufd(d, d, reverse_words);
+    code.pshufd(n, n, reverse_words);
+    code.sha1msg2(d, n);
+    code.pshufd(d, d, reverse_words);
+
+    ctx.reg_alloc.DefineValue(inst, d);
+}
+
+void EmitX64::EmitSHA256Hash(EmitContext& ctx, IR::Inst* inst) {
+    ASSERT(code.DoesCpuSupport(Xbyak::util::Cpu::tSHA));
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const bool part1 = args[3].GetImmediateU1();
+
+    // x = {A, B, C, D} and y = {E, F, G, H} in ascending order of words.
+    // sha256rnds2 takes the state as {F, E, B, A} and {H, G, D, C}.
+    const Xbyak::Xmm x = ctx.reg_alloc.UseXmm(args[0]);
+    const Xbyak::Xmm abef = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm w = ctx.reg_alloc.UseXmm(args[2]);
+    const Xbyak::Xmm cdgh = ctx.reg_alloc.ScratchXmm();
+
+    code.movaps(cdgh, abef);
+    code.shufps(cdgh, x, 0b10111011);
+    code.shufps(abef, x, 0b00010001);
+
+    // Each sha256rnds2 performs two rounds, using the lower two words of xmm0.
+    // After two rounds, the new {H, G, D, C} is the old {F, E, B, A}.
+    code.movaps(xmm0, w);
+    code.sha256rnds2(cdgh, abef);
+    code.pshufd(xmm0, w, 0b00001110);
+    code.sha256rnds2(abef, cdgh);
+
+    code.shufps(abef, cdgh, part1 ? 0b10111011 : 0b00010001);
+
+    ctx.reg_alloc.DefineValue(inst, abef);
+}
+
+void EmitX64::EmitSHA256ScheduleUpdate0(EmitContext& ctx, IR::Inst* inst) {
+    ASSERT(code.DoesCpuSupport(Xbyak::util::Cpu::tSHA));
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm d = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm n = ctx.reg_alloc.UseXmm(args[1]);
+
+    code.sha256msg1(d, n);
+
+    ctx.reg_alloc.DefineValue(inst, d);
+}
+
+void EmitX64::EmitSHA256ScheduleUpdate1(EmitContext& ctx, IR::Inst* inst) {
+    ASSERT(code.DoesCpuSupport(Xbyak::util::Cpu::tSHA));
+
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm d = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm n = ctx.reg_alloc.UseXmm(args[1]);
+    const Xbyak::Xmm m = ctx.reg_alloc.UseXmm(args[2]);
+    const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+
+    // sha256msg2 expects the sum of d and {n[1], n[2], n[3], m[0]}.
+    code.movdqa(tmp, m);
+    code.palignr(tmp, n, 4);
+    code.paddd(d, tmp);
+    code.sha256msg2(d, m);
+
+    ctx.reg_alloc.DefineValue(inst, d);
+}
+
+} // namespace Dynarmic::BackendX64
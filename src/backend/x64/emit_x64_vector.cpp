@@ -538,7 +538,55 @@ static constexpr T VShift(T x, T y) {
     return static_cast<T>(static_cast<unsigned_type>(x) << static_cast<unsigned_type>(shift_amount));
 }
 
+// There are no variable shifts of bytes, so even and odd bytes are shifted separately as 16-bit lanes.
+// Each byte is placed in the top byte of its lane, with the corresponding shift in the bottom byte.
+// emit_lanes(result, lanes, shift) must compute the top byte of each lane of result, and may clobber shift.
+template <typename EmitLanes>
+static Xbyak::Xmm EmitByteShiftAsWordShifts(BlockOfCode& code, EmitContext& ctx, Xbyak::Xmm data, Xbyak::Xmm shift, EmitLanes emit_lanes) {
+    const Xbyak::Xmm odd_shift = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm lanes = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm odd_result = ctx.reg_alloc.ScratchXmm();
+
+    code.vpsrlw(odd_shift, shift, 8);
+    code.vpsllw(lanes, data, 8);
+    emit_lanes(result, lanes, shift);
+    code.vpand(lanes, data, code.MConst(xword, 0xFF00FF00FF00FF00, 0xFF00FF00FF00FF00));
+    emit_lanes(odd_result, lanes, odd_shift);
+
+    code.vpsrlw(result, result, 8);
+    code.vpand(odd_result, odd_result, code.MConst(xword, 0xFF00FF00FF00FF00, 0xFF00FF00FF00FF00));
+    code.vpor(result, result, odd_result);
+    return result;
+}
+
 void EmitX64::EmitVectorArithmeticVShift8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+        const Xbyak::Xmm data = ctx.reg_alloc.UseXmm(args[0]);
+        const Xbyak::Xmm shift = ctx.reg_alloc.UseScratchXmm(args[1]);
+        const Xbyak::Xmm right_shift = ctx.reg_alloc.ScratchXmm();
+
+        const Xbyak::Xmm result = EmitByteShiftAsWordShifts(code, ctx, data, shift, [&](Xbyak::Xmm lane_result, Xbyak::Xmm lanes, Xbyak::Xmm left_shift) {
+            code.vpxor(right_shift, right_shift, right_shift);
+            code.vpsubw(right_shift, right_shift, left_shift);
+
+            // The sign of the shift is now in the top bit of each lane, which is all that pblendvb looks at.
+            code.vpsllw(xmm0, left_shift, 8);
+
+            code.vpand(right_shift, right_shift, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+            code.vpand(left_shift, left_shift, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+
+            code.vpsravw(right_shift, lanes, right_shift);
+            code.vpsllvw(lane_result, lanes, left_shift);
+            code.vpblendvb(lane_result, lane_result, right_shift, xmm0);
+        });
+
+        ctx.reg_alloc.DefineValue(inst, result);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s8>& result, const VectorArray<s8>& a, const VectorArray<s8>& b) {
         std::transform(a.begin(), a.end(), b.begin(), result.begin(), VShift<s8>);
     });
@@ -1465,6 +1513,28 @@ void EmitX64::EmitVectorLogicalShiftRight64(EmitContext& ctx, IR::Inst* inst) {
 }
 
 void EmitX64::EmitVectorLogicalVShift8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+        const Xbyak::Xmm data = ctx.reg_alloc.UseXmm(args[0]);
+        const Xbyak::Xmm shift = ctx.reg_alloc.UseScratchXmm(args[1]);
+        const Xbyak::Xmm right_shift = ctx.reg_alloc.ScratchXmm();
+
+        const Xbyak::Xmm result = EmitByteShiftAsWordShifts(code, ctx, data, shift, [&](Xbyak::Xmm lane_result, Xbyak::Xmm lanes, Xbyak::Xmm left_shift) {
+            code.vpxor(right_shift, right_shift, right_shift);
+            code.vpsubw(right_shift, right_shift, left_shift);
+            code.vpand(right_shift, right_shift, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+            code.vpand(left_shift, left_shift, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+
+            code.vpsrlvw(right_shift, lanes, right_shift);
+            code.vpsllvw(lane_result, lanes, left_shift);
+            code.vpor(lane_result, lane_result, right_shift);
+        });
+
+        ctx.reg_alloc.DefineValue(inst, result);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u8>& result, const VectorArray<u8>& a, const VectorArray<u8>& b) {
         std::transform(a.begin(), a.end(), b.begin(), result.begin(), VShift<u8>);
     });
@@ -2307,13 +2377,48 @@ static void PairedMin(VectorArray<T>& result, const VectorArray<T>& x, const Vec
     PairedOperation(result, x, y, [](auto a, auto b) { return std::min(a, b); });
 }
 
+template <typename Function>
+static void EmitVectorPairedMinMax(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, size_t esize, Function fn) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm x = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm y = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+
+    // Gather the even elements of each operand into its low half and the odd elements into its high half.
+    if (esize == 8) {
+        code.movdqa(tmp, code.MConst(xword, 0x0E0C0A0806040200, 0x0F0D0B0907050301));
+    } else {
+        code.movdqa(tmp, code.MConst(xword, 0x0D0C090805040100, 0x0F0E0B0A07060302));
+    }
+    code.pshufb(x, tmp);
+    code.pshufb(y, tmp);
+
+    code.movdqa(tmp, x);
+    code.punpcklqdq(x, y);
+    code.punpckhqdq(tmp, y);
+    (code.*fn)(x, tmp);
+
+    ctx.reg_alloc.DefineValue(inst, x);
+}
+
 void EmitX64::EmitVectorPairedMaxS8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 8, &Xbyak::CodeGenerator::pmaxsb);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s8>& result, const VectorArray<s8>& a, const VectorArray<s8>& b) {
         PairedMax(result, a, b);
     });
 }
 
 void EmitX64::EmitVectorPairedMaxS16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 16, &Xbyak::CodeGenerator::pmaxsw);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s16>& result, const VectorArray<s16>& a, const VectorArray<s16>& b) {
         PairedMax(result, a, b);
     });
@@ -2348,12 +2453,22 @@ void EmitX64::EmitVectorPairedMaxS32(EmitContext& ctx, IR::Inst* inst) {
 }
 
 void EmitX64::EmitVectorPairedMaxU8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 8, &Xbyak::CodeGenerator::pmaxub);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u8>& result, const VectorArray<u8>& a, const VectorArray<u8>& b) {
         PairedMax(result, a, b);
     });
 }
 
 void EmitX64::EmitVectorPairedMaxU16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 16, &Xbyak::CodeGenerator::pmaxuw);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u16>& result, const VectorArray<u16>& a, const VectorArray<u16>& b) {
         PairedMax(result, a, b);
     });
@@ -2393,12 +2508,22 @@ void EmitX64::EmitVectorPairedMaxU32(EmitContext& ctx, IR::Inst* inst) {
 }
 
 void EmitX64::EmitVectorPairedMinS8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 8, &Xbyak::CodeGenerator::pminsb);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s8>& result, const VectorArray<s8>& a, const VectorArray<s8>& b) {
         PairedMin(result, a, b);
     });
 }
 
 void EmitX64::EmitVectorPairedMinS16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 16, &Xbyak::CodeGenerator::pminsw);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s16>& result, const VectorArray<s16>& a, const VectorArray<s16>& b) {
         PairedMin(result, a, b);
     });
@@ -2433,12 +2558,22 @@ void EmitX64::EmitVectorPairedMinS32(EmitContext& ctx, IR::Inst* inst) {
 }
 
 void EmitX64::EmitVectorPairedMinU8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 8, &Xbyak::CodeGenerator::pminub);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u8>& result, const VectorArray<u8>& a, const VectorArray<u8>& b) {
         PairedMin(result, a, b);
     });
 }
 
 void EmitX64::EmitVectorPairedMinU16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
+        EmitVectorPairedMinMax(code, ctx, inst, 16, &Xbyak::CodeGenerator::pminuw);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u16>& result, const VectorArray<u16>& a, const VectorArray<u16>& b) {
         PairedMin(result, a, b);
     });
@@ -2493,20 +2628,66 @@ static D PolynomialMultiply(T lhs, T rhs) {
 }
 
 void EmitX64::EmitVectorPolynomialMultiply8(EmitContext& ctx, IR::Inst* inst) {
-    EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u8>& result, const VectorArray<u8>& a, const VectorArray<u8>& b) {
-        std::transform(a.begin(), a.end(), b.begin(), result.begin(), PolynomialMultiply<u8, u8>);
-    });
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const Xbyak::Xmm xmm_a = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm xmm_b = ctx.reg_alloc.UseXmm(args[1]);
+    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm mask = ctx.reg_alloc.ScratchXmm();
+
+    // Horner's scheme, starting from the most significant bit of a: result = (result << 1) ^ (bit ? b : 0).
+    // Products are truncated to eight bits, so bits shifted out of each byte can be discarded.
+    code.pxor(result, result);
+    for (size_t i = 0; i < 8; i++) {
+        code.paddb(result, result);
+        code.pxor(mask, mask);
+        code.pcmpgtb(mask, xmm_a);
+        code.pand(mask, xmm_b);
+        code.pxor(result, mask);
+        code.paddb(xmm_a, xmm_a);
+    }
+
+    ctx.reg_alloc.DefineValue(inst, result);
 }
 
 void EmitX64::EmitVectorPolynomialMultiplyLong8(EmitContext& ctx, IR::Inst* inst) {
-    EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u16>& result, const VectorArray<u8>& a, const VectorArray<u8>& b) {
-        for (size_t i = 0; i < result.size(); i++) {
-            result[i] = PolynomialMultiply<u16, u8>(a[i], b[i]);
-        }
-    });
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const Xbyak::Xmm xmm_a = ctx.reg_alloc.UseScratchXmm(args[0]);
+    const Xbyak::Xmm xmm_b = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm mask = ctx.reg_alloc.ScratchXmm();
+
+    // Widen the lower eight bytes of each operand, with the bytes of a placed in the upper half of
+    // each word so that its bits can be tested from the sign bit, most significant first.
+    code.pxor(mask, mask);
+    code.punpcklbw(xmm_b, mask);
+    code.punpcklbw(mask, xmm_a);
+    code.movdqa(xmm_a, mask);
+
+    code.pxor(result, result);
+    for (size_t i = 0; i < 8; i++) {
+        code.paddw(result, result);
+        code.pxor(mask, mask);
+        code.pcmpgtw(mask, xmm_a);
+        code.pand(mask, xmm_b);
+        code.pxor(result, mask);
+        code.paddw(xmm_a, xmm_a);
+    }
+
+    ctx.reg_alloc.DefineValue(inst, result);
 }
 
 void EmitX64::EmitVectorPolynomialMultiplyLong64(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tPCLMULQDQ)) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+        const Xbyak::Xmm xmm_a = ctx.reg_alloc.UseScratchXmm(args[0]);
+        const Xbyak::Xmm xmm_b = ctx.reg_alloc.UseXmm(args[1]);
+
+        code.pclmulqdq(xmm_a, xmm_b, 0x00);
+
+        ctx.reg_alloc.DefineValue(inst, xmm_a);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u64>& result, const VectorArray<u64>& a, const VectorArray<u64>& b) {
         const auto handle_high_bits = [](u64 lhs, u64 rhs) {
             constexpr size_t bit_size = Common::BitSize<u64>();
@@ -2712,6 +2893,116 @@ void EmitX64::EmitVectorRoundingHalvingAddU32(EmitContext& ctx, IR::Inst* inst)
     EmitVectorRoundingHalvingAddUnsigned(32, ctx, inst, code);
 }
 
+static void EmitVectorRoundingShiftLeft(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, size_t esize, bool is_signed) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm lhs = ctx.reg_alloc.UseXmm(args[0]);
+    const Xbyak::Xmm rhs = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm left = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm right = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+
+    // The shift is the signed bottom byte of each element. Taken as an unsigned count it is out of
+    // range whenever it is negative, so shifting left by it yields the result for non-negative shifts
+    // and zero otherwise. Its complement is one less than the right shift for negative shifts and is
+    // out of range otherwise, so that right shifting by it and rounding yields the remaining results.
+    const u64 byte_mask = esize == 16 ? 0x00FF00FF00FF00FF : esize == 32 ? 0x000000FF000000FF : 0x00000000000000FF;
+    code.vmovdqa(tmp, code.MConst(xword, byte_mask, byte_mask));
+    code.vpandn(right, rhs, tmp);
+    code.vpand(rhs, rhs, tmp);
+
+    switch (esize) {
+    case 16:
+        code.vpsllvw(left, lhs, rhs);
+        if (is_signed) {
+            code.vpsravw(right, lhs, right);
+        } else {
+            code.vpsrlvw(right, lhs, right);
+        }
+        code.vpsrlw(tmp, tmp, 7);
+        code.vpand(tmp, tmp, right);
+        if (is_signed) {
+            code.vpsraw(right, right, 1);
+        } else {
+            code.vpsrlw(right, right, 1);
+        }
+        code.vpaddw(right, right, tmp);
+        break;
+    case 32:
+        code.vpsllvd(left, lhs, rhs);
+        if (is_signed) {
+            code.vpsravd(right, lhs, right);
+        } else {
+            code.vpsrlvd(right, lhs, right);
+        }
+        code.vpsrld(tmp, tmp, 7);
+        code.vpand(tmp, tmp, right);
+        if (is_signed) {
+            code.vpsrad(right, right, 1);
+        } else {
+            code.vpsrld(right, right, 1);
+        }
+        code.vpaddd(right, right, tmp);
+        break;
+    case 64:
+        code.vpsllvq(left, lhs, rhs);
+        if (is_signed) {
+            code.vpsravq(right, lhs, right);
+        } else {
+            code.vpsrlvq(right, lhs, right);
+        }
+        code.vpsrlq(tmp, tmp, 7);
+        code.vpand(tmp, tmp, right);
+        if (is_signed) {
+            code.vpsraq(right, right, 1);
+        } else {
+            code.vpsrlq(right, right, 1);
+        }
+        code.vpaddq(right, right, tmp);
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    code.vpor(left, left, right);
+
+    ctx.reg_alloc.DefineValue(inst, left);
+}
+
+// As EmitVectorRoundingShiftLeft, but each byte is at the top of a 16-bit lane, so the rounding bit is the
+// bottom bit of that byte rather than of the lane.
+static void EmitVectorRoundingShiftLeft8(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, bool is_signed) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm lhs = ctx.reg_alloc.UseXmm(args[0]);
+    const Xbyak::Xmm rhs = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm right = ctx.reg_alloc.ScratchXmm();
+
+    const Xbyak::Xmm result = EmitByteShiftAsWordShifts(code, ctx, lhs, rhs, [&](Xbyak::Xmm left, Xbyak::Xmm lanes, Xbyak::Xmm shift) {
+        code.vmovdqa(right, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+        code.vpandn(right, shift, right);
+        code.vpand(shift, shift, code.MConst(xword, 0x00FF00FF00FF00FF, 0x00FF00FF00FF00FF));
+
+        code.vpsllvw(left, lanes, shift);
+        if (is_signed) {
+            code.vpsravw(right, lanes, right);
+        } else {
+            code.vpsrlvw(right, lanes, right);
+        }
+        code.vpand(shift, right, code.MConst(xword, 0x0100010001000100, 0x0100010001000100));
+        if (is_signed) {
+            code.vpsraw(right, right, 1);
+        } else {
+            code.vpsrlw(right, right, 1);
+        }
+        code.vpaddw(right, right, shift);
+
+        code.vpor(left, left, right);
+    });
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
 template <typename T, typename U>
 static void RoundingShiftLeft(VectorArray<T>& out, const VectorArray<T>& lhs, const VectorArray<U>& rhs) {
     using signed_type = std::make_signed_t<T>;
@@ -2747,48 +3038,88 @@ static void RoundingShiftLeft(VectorArray<T>& out, const VectorArray<T>& lhs, co
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftS8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorRoundingShiftLeft8(code, ctx, inst, true);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s8>& result, const VectorArray<s8>& lhs, const VectorArray<s8>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftS16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 16, true);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s16>& result, const VectorArray<s16>& lhs, const VectorArray<s16>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftS32(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 32, true);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s32>& result, const VectorArray<s32>& lhs, const VectorArray<s32>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftS64(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 64, true);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<s64>& result, const VectorArray<s64>& lhs, const VectorArray<s64>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftU8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorRoundingShiftLeft8(code, ctx, inst, false);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u8>& result, const VectorArray<u8>& lhs, const VectorArray<s8>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftU16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 16, false);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u16>& result, const VectorArray<u16>& lhs, const VectorArray<s16>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftU32(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 32, false);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u32>& result, const VectorArray<u32>& lhs, const VectorArray<s32>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
 }
 
 void EmitX64::EmitVectorRoundingShiftLeftU64(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorRoundingShiftLeft(code, ctx, inst, 64, false);
+        return;
+    }
+
     EmitTwoArgumentFallback(code, ctx, inst, [](VectorArray<u64>& result, const VectorArray<u64>& lhs, const VectorArray<s64>& rhs) {
         RoundingShiftLeft(result, lhs, rhs);
     });
@@ -3807,6 +4138,121 @@ void EmitX64::EmitVectorSignedSaturatedNeg64(EmitContext& ctx, IR::Inst* inst) {
     });
 }
 
+// Shifts each lane of data left by the signed bottom byte of the corresponding lane of shift, saturating
+// lanes which overflow, and sets no_saturation to a mask of the lanes which did not saturate. A byte held
+// in the top of a 16-bit lane (whose bottom byte is zero) shifts and saturates as a byte would.
+// Clobbers shift and xmm0.
+static void EmitSaturatedShiftLeftLanes(BlockOfCode& code, size_t esize, bool is_signed, Xbyak::Xmm result, Xbyak::Xmm data, Xbyak::Xmm shift, Xbyak::Xmm no_saturation, Xbyak::Xmm tmp) {
+    using VectorOperation = void (Xbyak::CodeGenerator::*)(const Xbyak::Xmm&, const Xbyak::Xmm&, const Xbyak::Operand&);
+    using VectorShift = void (Xbyak::CodeGenerator::*)(const Xbyak::Xmm&, const Xbyak::Operand&, u8);
+
+    VectorOperation shift_left, shift_right, sub, compare_equal, compare_greater;
+    VectorShift shift_left_immediate;
+    u64 byte_mask, max_value;
+    switch (esize) {
+    case 16:
+        shift_left = &Xbyak::CodeGenerator::vpsllvw;
+        shift_right = &Xbyak::CodeGenerator::vpsrlvw;
+        if (is_signed) {
+            shift_right = &Xbyak::CodeGenerator::vpsravw;
+        }
+        sub = &Xbyak::CodeGenerator::vpsubw;
+        compare_equal = &Xbyak::CodeGenerator::vpcmpeqw;
+        compare_greater = &Xbyak::CodeGenerator::vpcmpgtw;
+        shift_left_immediate = &Xbyak::CodeGenerator::vpsllw;
+        byte_mask = 0x00FF00FF00FF00FF;
+        max_value = 0x7FFF7FFF7FFF7FFF;
+        break;
+    case 32:
+        shift_left = &Xbyak::CodeGenerator::vpsllvd;
+        shift_right = &Xbyak::CodeGenerator::vpsrlvd;
+        if (is_signed) {
+            shift_right = &Xbyak::CodeGenerator::vpsravd;
+        }
+        sub = &Xbyak::CodeGenerator::vpsubd;
+        compare_equal = &Xbyak::CodeGenerator::vpcmpeqd;
+        compare_greater = &Xbyak::CodeGenerator::vpcmpgtd;
+        shift_left_immediate = &Xbyak::CodeGenerator::vpslld;
+        byte_mask = 0x000000FF000000FF;
+        max_value = 0x7FFFFFFF7FFFFFFF;
+        break;
+    case 64:
+        shift_left = &Xbyak::CodeGenerator::vpsllvq;
+        shift_right = &Xbyak::CodeGenerator::vpsrlvq;
+        if (is_signed) {
+            shift_right = &Xbyak::CodeGenerator::vpsravq;
+        }
+        sub = &Xbyak::CodeGenerator::vpsubq;
+        compare_equal = &Xbyak::CodeGenerator::vpcmpeqq;
+        compare_greater = &Xbyak::CodeGenerator::vpcmpgtq;
+        shift_left_immediate = &Xbyak::CodeGenerator::vpsllq;
+        byte_mask = 0x00000000000000FF;
+        max_value = 0x7FFFFFFFFFFFFFFF;
+        break;
+    default:
+        UNREACHABLE();
+    }
+
+    // Lanes with a negative shift are shifted right instead, and never saturate.
+    code.vpxor(tmp, tmp, tmp);
+    (code.*shift_left_immediate)(xmm0, shift, static_cast<u8>(esize - 8));
+    (code.*compare_greater)(xmm0, tmp, xmm0);
+
+    // Taken as unsigned counts, the bottom byte of the shift and of its negation are out of range
+    // (and so shift out every bit) exactly when the shift is in the other direction.
+    (code.*sub)(tmp, tmp, shift);
+    code.vmovdqa(no_saturation, code.MConst(xword, byte_mask, byte_mask));
+    code.vpand(tmp, tmp, no_saturation);
+    code.vpand(shift, shift, no_saturation);
+
+    // A left shift saturates if shifting back does not recover the original value.
+    (code.*shift_left)(result, data, shift);
+    (code.*shift_right)(no_saturation, result, shift);
+    (code.*compare_equal)(no_saturation, no_saturation, data);
+    code.vpor(no_saturation, no_saturation, xmm0);
+    (code.*shift_right)(shift, data, tmp);
+
+    if (is_signed) {
+        code.vpxor(tmp, tmp, tmp);
+        (code.*compare_greater)(tmp, tmp, data);
+        code.vpxor(tmp, tmp, code.MConst(xword, max_value, max_value));
+    } else {
+        code.vpcmpeqd(tmp, tmp, tmp);
+    }
+    code.vpblendvb(result, tmp, result, no_saturation);
+    code.vpblendvb(result, result, shift, xmm0);
+}
+
+static void EmitVectorSaturatedShiftLeft(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, size_t esize, bool is_signed) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+    const Xbyak::Xmm data = ctx.reg_alloc.UseXmm(args[0]);
+    const Xbyak::Xmm shift = ctx.reg_alloc.UseScratchXmm(args[1]);
+    const Xbyak::Xmm no_saturation = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+    const Xbyak::Reg32 bit = ctx.reg_alloc.ScratchGpr().cvt32();
+
+    Xbyak::Xmm result;
+    if (esize == 8) {
+        const Xbyak::Xmm lane_no_saturation = ctx.reg_alloc.ScratchXmm();
+
+        code.vpcmpeqw(no_saturation, no_saturation, no_saturation);
+        result = EmitByteShiftAsWordShifts(code, ctx, data, shift, [&](Xbyak::Xmm lane_result, Xbyak::Xmm lanes, Xbyak::Xmm lane_shift) {
+            EmitSaturatedShiftLeftLanes(code, 16, is_signed, lane_result, lanes, lane_shift, lane_no_saturation, tmp);
+            code.vpand(no_saturation, no_saturation, lane_no_saturation);
+        });
+    } else {
+        result = ctx.reg_alloc.ScratchXmm();
+        EmitSaturatedShiftLeftLanes(code, esize, is_signed, result, data, shift, no_saturation, tmp);
+    }
+
+    code.vpmovmskb(bit, no_saturation);
+    code.xor_(bit, u32(0xFFFF));
+    code.or_(code.dword[code.r15 + code.GetJitStateInfo().offsetof_fpsr_qc], bit);
+
+    ctx.reg_alloc.DefineValue(inst, result);
+}
+
 // MSVC requires the capture within the saturate lambda, but it's
 // determined to be unnecessary via clang and GCC.
 #ifdef __clang__
@@ -3856,18 +4302,38 @@ static bool VectorSignedSaturatedShiftLeft(VectorArray<T>& dst, const VectorArra
 #endif
 
 void EmitX64::EmitVectorSignedSaturatedShiftLeft8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 8, true);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorSignedSaturatedShiftLeft<s8>);
 }
 
 void EmitX64::EmitVectorSignedSaturatedShiftLeft16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 16, true);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorSignedSaturatedShiftLeft<s16>);
 }
 
 void EmitX64::EmitVectorSignedSaturatedShiftLeft32(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 32, true);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorSignedSaturatedShiftLeft<s32>);
 }
 
 void EmitX64::EmitVectorSignedSaturatedShiftLeft64(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 64, true);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorSignedSaturatedShiftLeft<s64>);
 }
 
@@ -4372,18 +4838,38 @@ static bool VectorUnsignedSaturatedShiftLeft(VectorArray<T>& dst, const VectorAr
 }
 
 void EmitX64::EmitVectorUnsignedSaturatedShiftLeft8(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 8, false);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorUnsignedSaturatedShiftLeft<u8>);
 }
 
 void EmitX64::EmitVectorUnsignedSaturatedShiftLeft16(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512VL) && code.DoesCpuSupport(Xbyak::util::Cpu::tAVX512BW)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 16, false);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorUnsignedSaturatedShiftLeft<u16>);
 }
 
 void EmitX64::EmitVectorUnsignedSaturatedShiftLeft32(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 32, false);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorUnsignedSaturatedShiftLeft<u32>);
 }
 
 void EmitX64::EmitVectorUnsignedSaturatedShiftLeft64(EmitContext& ctx, IR::Inst* inst) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        EmitVectorSaturatedShiftLeft(code, ctx, inst, 64, false);
+        return;
+    }
+
     EmitTwoArgumentFallbackWithSaturation(code, ctx, inst, VectorUnsignedSaturatedShiftLeft<u64>);
 }
 
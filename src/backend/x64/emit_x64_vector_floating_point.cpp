@@ -16,6 +16,7 @@
 #include "common/assert.h"
 #include "common/bit_util.h"
 #include "common/fp/fpcr.h"
+#include "common/fp/fpsr.h"
 #include "common/fp/info.h"
 #include "common/fp/op.h"
 #include "common/fp/util.h"
@@ -360,14 +361,8 @@ void EmitThreeOpVectorOperation(BlockOfCode& code, EmitContext& ctx, IR::Inst* i
 }
 
 template<typename Lambda>
-void EmitTwoOpFallback(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, Lambda lambda) {
+void EmitTwoOpFallbackWithoutRegAlloc(BlockOfCode& code, EmitContext& ctx, Xbyak::Xmm result, Xbyak::Xmm arg1, Lambda lambda) {
     const auto fn = static_cast<mp::equivalent_function_type_t<Lambda>*>(lambda);
-    
-    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
-    const Xbyak::Xmm arg1 = ctx.reg_alloc.UseXmm(args[0]);
-    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
-    ctx.reg_alloc.EndOfAllocScope();
-    ctx.reg_alloc.HostCall(nullptr);
 
     constexpr u32 stack_space = 2 * 16;
     code.sub(rsp, stack_space + ABI_SHADOW_SPACE);
@@ -381,6 +376,17 @@ void EmitTwoOpFallback(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, Lamb
     code.movaps(result, xword[rsp + ABI_SHADOW_SPACE + 0 * 16]);
 
     code.add(rsp, stack_space + ABI_SHADOW_SPACE);
+}
+
+template<typename Lambda>
+void EmitTwoOpFallback(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst, Lambda lambda) {
+    auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+    const Xbyak::Xmm arg1 = ctx.reg_alloc.UseXmm(args[0]);
+    const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+    ctx.reg_alloc.EndOfAllocScope();
+    ctx.reg_alloc.HostCall(nullptr);
+
+    EmitTwoOpFallbackWithoutRegAlloc(code, ctx, result, arg1, lambda);
 
     ctx.reg_alloc.DefineValue(inst, result);
 }
@@ -1013,21 +1019,138 @@ void EmitX64::EmitFPVectorPairedAddLower64(EmitContext& ctx, IR::Inst* inst) {
     });
 }
 
+// The estimates only depend on the sign, the exponent and the top eight bits of the mantissa of
+// their operands. These tables hold the mantissa of the estimate, indexed by the top eight bits of
+// the mantissa of the operand (and for reciprocal square roots, the parity of its exponent).
+// They are generated using the reference implementations so as to remain bit-exact with them.
 template<typename FPT>
+static const std::array<FPT, 256>& RecipEstimateTable() {
+    static const auto table = []{
+        std::array<FPT, 256> result;
+        for (size_t i = 0; i < result.size(); i++) {
+            const FPT one = FP::FPValue<FPT, false, 0, 1>();
+            const FPT operand = static_cast<FPT>(one | (static_cast<FPT>(i) << (FP::FPInfo<FPT>::explicit_mantissa_width - 8)));
+            FP::FPSR fpsr;
+            result[i] = FP::FPRecipEstimate<FPT>(operand, FP::FPCR{}, fpsr) & FP::FPInfo<FPT>::mantissa_mask;
+        }
+        return result;
+    }();
+    return table;
+}
+
+template<typename FPT>
+static const std::array<FPT, 512>& RSqrtEstimateTable() {
+    static const auto table = []{
+        std::array<FPT, 512> result;
+        for (size_t i = 0; i < result.size(); i++) {
+            const FPT operand = static_cast<FPT>((static_cast<FPT>(FP::FPInfo<FPT>::exponent_bias - 1) << FP::FPInfo<FPT>::explicit_mantissa_width)
+                                                 + (static_cast<FPT>(i) << (FP::FPInfo<FPT>::explicit_mantissa_width - 8)));
+            FP::FPSR fpsr;
+            result[i] = FP::FPRSqrtEstimate<FPT>(operand, FP::FPCR{}, fpsr) & FP::FPInfo<FPT>::mantissa_mask;
+        }
+        return result;
+    }();
+    return table;
+}
+
+// Looks up the estimate mantissa for each element of index and writes it to result. mask is clobbered.
+template<size_t fsize>
+static void EmitEstimateTableLookup(BlockOfCode& code, Xbyak::Xmm result, Xbyak::Xmm index, Xbyak::Xmm mask, Xbyak::Reg64 table, const void* table_data) {
+    code.mov(table, reinterpret_cast<u64>(table_data));
+    code.vpcmpeqd(mask, mask, mask);
+    if constexpr (fsize == 32) {
+        code.vpgatherdd(result, code.ptr[table + index * 4], mask);
+    } else {
+        code.vpgatherqq(result, code.ptr[table + index * 8], mask);
+    }
+}
+
+template<size_t fsize>
 static void EmitRecipEstimate(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
-    EmitTwoOpFallback(code, ctx, inst, [](VectorArray<FPT>& result, const VectorArray<FPT>& operand, FP::FPCR fpcr, FP::FPSR& fpsr) {
+    using FPT = mp::unsigned_integer_of_size<fsize>;
+
+    const auto fallback_fn = [](VectorArray<FPT>& result, const VectorArray<FPT>& operand, FP::FPCR fpcr, FP::FPSR& fpsr) {
         for (size_t i = 0; i < result.size(); i++) {
             result[i] = FP::FPRecipEstimate<FPT>(operand[i], fpcr, fpsr);
         }
-    });
+    };
+
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+        const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Xmm operand = ctx.reg_alloc.UseXmm(args[0]);
+        const Xbyak::Xmm index = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Reg64 table = ctx.reg_alloc.ScratchGpr();
+
+        Xbyak::Label end, fallback;
+
+        // Only normal operands whose estimate is also normal are handled inline. Everything else
+        // (zeroes, denormals, infinities, NaNs and very large operands) is left to the fallback.
+        constexpr FPT smallest_normal = FP::FPValue<FPT, false, FP::FPInfo<FPT>::exponent_min, 1>();
+        constexpr FPT largest_handled = static_cast<FPT>((static_cast<FPT>(2 * FP::FPInfo<FPT>::exponent_bias - 2) << FP::FPInfo<FPT>::explicit_mantissa_width) | FP::FPInfo<FPT>::mantissa_mask);
+        constexpr FPT non_sign_mask = static_cast<FPT>(~FP::FPInfo<FPT>::sign_mask);
+
+        code.vpand(tmp, operand, GetVectorOf<fsize, non_sign_mask>(code));
+        if constexpr (fsize == 32) {
+            code.vpcmpgtd(index, tmp, GetVectorOf<fsize, largest_handled>(code));
+            code.vpcmpgtd(tmp, tmp, GetVectorOf<fsize, smallest_normal - 1>(code));
+        } else {
+            code.vpcmpgtq(index, tmp, GetVectorOf<fsize, largest_handled>(code));
+            code.vpcmpgtq(tmp, tmp, GetVectorOf<fsize, smallest_normal - 1>(code));
+        }
+        code.vpandn(tmp, tmp, GetVectorOf<fsize, FPT(~FPT(0))>(code));
+        code.vpor(tmp, tmp, index);
+        code.vptest(tmp, tmp);
+        code.jnz(fallback, code.T_NEAR);
+
+        if constexpr (fsize == 32) {
+            code.vpsrld(index, operand, FP::FPInfo<FPT>::explicit_mantissa_width - 8);
+        } else {
+            code.vpsrlq(index, operand, FP::FPInfo<FPT>::explicit_mantissa_width - 8);
+        }
+        code.vpand(index, index, GetVectorOf<fsize, 0xFF>(code));
+        EmitEstimateTableLookup<fsize>(code, result, index, tmp, table, RecipEstimateTable<FPT>().data());
+
+        // The biased exponent of the estimate is 2 * bias - 1 - the biased exponent of the operand.
+        constexpr FPT exponent_mask = static_cast<FPT>(non_sign_mask & ~FP::FPInfo<FPT>::mantissa_mask);
+        constexpr FPT result_exponent_base = static_cast<FPT>(static_cast<FPT>(2 * FP::FPInfo<FPT>::exponent_bias - 1) << FP::FPInfo<FPT>::explicit_mantissa_width);
+        code.vpand(tmp, operand, GetVectorOf<fsize, exponent_mask>(code));
+        code.vmovdqa(index, GetVectorOf<fsize, result_exponent_base>(code));
+        if constexpr (fsize == 32) {
+            code.vpsubd(index, index, tmp);
+        } else {
+            code.vpsubq(index, index, tmp);
+        }
+        code.vpor(result, result, index);
+        code.vpand(tmp, operand, GetVectorOf<fsize, FP::FPInfo<FPT>::sign_mask>(code));
+        code.vpor(result, result, tmp);
+        code.L(end);
+
+        code.SwitchToFarCode();
+        code.L(fallback);
+        code.sub(rsp, 8);
+        ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+        EmitTwoOpFallbackWithoutRegAlloc(code, ctx, result, operand, fallback_fn);
+        ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+        code.add(rsp, 8);
+        code.jmp(end, code.T_NEAR);
+        code.SwitchToNearCode();
+
+        ctx.reg_alloc.DefineValue(inst, result);
+        return;
+    }
+
+    EmitTwoOpFallback(code, ctx, inst, fallback_fn);
 }
 
 void EmitX64::EmitFPVectorRecipEstimate32(EmitContext& ctx, IR::Inst* inst) {
-    EmitRecipEstimate<u32>(code, ctx, inst);
+    EmitRecipEstimate<32>(code, ctx, inst);
 }
 
 void EmitX64::EmitFPVectorRecipEstimate64(EmitContext& ctx, IR::Inst* inst) {
-    EmitRecipEstimate<u64>(code, ctx, inst);
+    EmitRecipEstimate<64>(code, ctx, inst);
 }
 
 template<size_t fsize>
@@ -1083,6 +1206,38 @@ void EmitX64::EmitFPVectorRecipStepFused64(EmitContext& ctx, IR::Inst* inst) {
     EmitRecipStepFused<64>(code, ctx, inst);
 }
 
+// Rounds each element of operand to the nearest integer, with ties rounding away from zero.
+// This is computed as trunc(|x|) + (frac(|x|) >= 0.5 ? 1 : 0), with the sign of x reapplied.
+// Only a signalling NaN raises a host exception, as for FRINTA: the truncation suppresses the
+// precision exception, infinities are excluded from the subtraction, and the fraction is compared
+// as an integer. result must not alias operand.
+template<size_t fsize>
+void EmitRoundTiesAwayFromZero(BlockOfCode& code, Xbyak::Xmm result, Xbyak::Xmm operand, Xbyak::Xmm tmp1, Xbyak::Xmm tmp2) {
+    using FPT = mp::unsigned_integer_of_size<fsize>;
+
+    constexpr FPT non_sign_mask = static_cast<FPT>(~FP::FPInfo<FPT>::sign_mask);
+    // The largest bit pattern below that of 0.5. The fraction is non-negative, NaN, or -inf for
+    // infinite operands, so comparing bit patterns as signed integers orders it correctly.
+    constexpr FPT below_half = static_cast<FPT>(FP::FPValue<FPT, false, -1, 1>() - 1);
+
+    code.movaps(tmp1, operand);
+    FCODE(andp)(tmp1, GetVectorOf<fsize, non_sign_mask>(code));
+    FCODE(roundp)(result, tmp1, static_cast<u8>(0b1011));
+    code.movaps(tmp2, tmp1);
+    FCODE(cmpneqp)(tmp2, GetVectorOf<fsize, FP::FPInfo<FPT>::Infinity(false)>(code));
+    FCODE(andp)(tmp2, tmp1);
+    FCODE(subp)(tmp2, result);
+    code.pcmpgtd(tmp2, GetVectorOf<fsize, below_half>(code));
+    if constexpr (fsize == 64) {
+        // The low word of 0.5 is zero, so the comparison of the high words decides.
+        code.pshufd(tmp2, tmp2, 0b11110101);
+    }
+    FCODE(andp)(tmp2, GetVectorOf<fsize, false, 0, 1>(code));
+    FCODE(addp)(result, tmp2);
+    FCODE(xorp)(tmp1, operand);
+    FCODE(orp)(result, tmp1);
+}
+
 template<size_t fsize>
 void EmitFPVectorRoundInt(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
     using FPT = mp::unsigned_integer_of_size<fsize>;
@@ -1090,6 +1245,17 @@ void EmitFPVectorRoundInt(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
     const auto rounding = static_cast<FP::RoundingMode>(inst->GetArg(1).GetU8());
     const bool exact = inst->GetArg(2).GetU1();
 
+    // With FPCR.FZ set the fallback reports flushed denormal operands in FPSR.IDC, which this doesn't.
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41) && rounding == FP::RoundingMode::ToNearest_TieAwayFromZero && !exact && !ctx.FPSCR_FTZ()) {
+        EmitTwoOpVectorOperation<fsize, DefaultIndexer>(code, ctx, inst, [&](const Xbyak::Xmm& result, const Xbyak::Xmm& xmm_a){
+            const Xbyak::Xmm tmp1 = ctx.reg_alloc.ScratchXmm();
+            const Xbyak::Xmm tmp2 = ctx.reg_alloc.ScratchXmm();
+            EmitRoundTiesAwayFromZero<fsize>(code, result, xmm_a, tmp1, tmp2);
+        });
+
+        return;
+    }
+
     if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41) && rounding != FP::RoundingMode::ToNearest_TieAwayFromZero && !exact) {
         const u8 round_imm = [&]() -> u8 {
             switch (rounding) {
@@ -1156,21 +1322,92 @@ void EmitX64::EmitFPVectorRoundInt64(EmitContext& ctx, IR::Inst* inst) {
     EmitFPVectorRoundInt<64>(code, ctx, inst);
 }
 
-template<typename FPT>
+template<size_t fsize>
 static void EmitRSqrtEstimate(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
-    EmitTwoOpFallback(code, ctx, inst, [](VectorArray<FPT>& result, const VectorArray<FPT>& operand, FP::FPCR fpcr, FP::FPSR& fpsr) {
+    using FPT = mp::unsigned_integer_of_size<fsize>;
+
+    const auto fallback_fn = [](VectorArray<FPT>& result, const VectorArray<FPT>& operand, FP::FPCR fpcr, FP::FPSR& fpsr) {
         for (size_t i = 0; i < result.size(); i++) {
             result[i] = FP::FPRSqrtEstimate<FPT>(operand[i], fpcr, fpsr);
         }
-    });
+    };
+
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tAVX2)) {
+        auto args = ctx.reg_alloc.GetArgumentInfo(inst);
+
+        const Xbyak::Xmm result = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Xmm operand = ctx.reg_alloc.UseXmm(args[0]);
+        const Xbyak::Xmm index = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Xmm tmp = ctx.reg_alloc.ScratchXmm();
+        const Xbyak::Reg64 table = ctx.reg_alloc.ScratchGpr();
+
+        Xbyak::Label end, fallback;
+
+        // Only positive normal operands are handled inline. Compared as signed integers, everything
+        // else is either less than the smallest normal or greater than the largest normal.
+        constexpr FPT smallest_normal = FP::FPValue<FPT, false, FP::FPInfo<FPT>::exponent_min, 1>();
+        constexpr FPT largest_normal = static_cast<FPT>(FP::FPInfo<FPT>::Infinity(false) - 1);
+
+        if constexpr (fsize == 32) {
+            code.vpcmpgtd(index, operand, GetVectorOf<fsize, largest_normal>(code));
+            code.vpcmpgtd(tmp, operand, GetVectorOf<fsize, smallest_normal - 1>(code));
+        } else {
+            code.vpcmpgtq(index, operand, GetVectorOf<fsize, largest_normal>(code));
+            code.vpcmpgtq(tmp, operand, GetVectorOf<fsize, smallest_normal - 1>(code));
+        }
+        code.vpandn(tmp, tmp, GetVectorOf<fsize, FPT(~FPT(0))>(code));
+        code.vpor(tmp, tmp, index);
+        code.vptest(tmp, tmp);
+        code.jnz(fallback, code.T_NEAR);
+
+        if constexpr (fsize == 32) {
+            code.vpsrld(index, operand, FP::FPInfo<FPT>::explicit_mantissa_width - 8);
+        } else {
+            code.vpsrlq(index, operand, FP::FPInfo<FPT>::explicit_mantissa_width - 8);
+        }
+        code.vpand(index, index, GetVectorOf<fsize, 0x1FF>(code));
+        EmitEstimateTableLookup<fsize>(code, result, index, tmp, table, RSqrtEstimateTable<FPT>().data());
+
+        // The biased exponent of the estimate is (3 * bias - 1 - the biased exponent of the operand) / 2.
+        constexpr FPT result_exponent_base = static_cast<FPT>(3 * FP::FPInfo<FPT>::exponent_bias - 1);
+        code.vmovdqa(index, GetVectorOf<fsize, result_exponent_base>(code));
+        if constexpr (fsize == 32) {
+            code.vpsrld(tmp, operand, FP::FPInfo<FPT>::explicit_mantissa_width);
+            code.vpsubd(index, index, tmp);
+            code.vpsrld(index, index, 1);
+            code.vpslld(index, index, FP::FPInfo<FPT>::explicit_mantissa_width);
+        } else {
+            code.vpsrlq(tmp, operand, FP::FPInfo<FPT>::explicit_mantissa_width);
+            code.vpsubq(index, index, tmp);
+            code.vpsrlq(index, index, 1);
+            code.vpsllq(index, index, FP::FPInfo<FPT>::explicit_mantissa_width);
+        }
+        code.vpor(result, result, index);
+        code.L(end);
+
+        code.SwitchToFarCode();
+        code.L(fallback);
+        code.sub(rsp, 8);
+        ABI_PushCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+        EmitTwoOpFallbackWithoutRegAlloc(code, ctx, result, operand, fallback_fn);
+        ABI_PopCallerSaveRegistersAndAdjustStackExcept(code, HostLocXmmIdx(result.getIdx()));
+        code.add(rsp, 8);
+        code.jmp(end, code.T_NEAR);
+        code.SwitchToNearCode();
+
+        ctx.reg_alloc.DefineValue(inst, result);
+        return;
+    }
+
+    EmitTwoOpFallback(code, ctx, inst, fallback_fn);
 }
 
 void EmitX64::EmitFPVectorRSqrtEstimate32(EmitContext& ctx, IR::Inst* inst) {
-    EmitRSqrtEstimate<u32>(code, ctx, inst);
+    EmitRSqrtEstimate<32>(code, ctx, inst);
 }
 
 void EmitX64::EmitFPVectorRSqrtEstimate64(EmitContext& ctx, IR::Inst* inst) {
-    EmitRSqrtEstimate<u64>(code, ctx, inst);
+    EmitRSqrtEstimate<64>(code, ctx, inst);
 }
 
 template<size_t fsize>
@@ -1253,7 +1490,7 @@ void EmitFPVectorToFixed(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
 
     // TODO: AVX512 implementation
 
-    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41) && rounding != FP::RoundingMode::ToNearest_TieAwayFromZero) {
+    if (code.DoesCpuSupport(Xbyak::util::Cpu::tSSE41)) {
         auto args = ctx.reg_alloc.GetArgumentInfo(inst);
 
         const Xbyak::Xmm src = ctx.reg_alloc.UseScratchXmm(args[0]);
@@ -1261,6 +1498,7 @@ void EmitFPVectorToFixed(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
         const int round_imm = [&]{
             switch (rounding) {
             case FP::RoundingMode::ToNearest_TieEven:
+            case FP::RoundingMode::ToNearest_TieAwayFromZero:
             default:
                 return 0b00;
             case FP::RoundingMode::TowardsPlusInfinity:
@@ -1300,7 +1538,18 @@ void EmitFPVectorToFixed(BlockOfCode& code, EmitContext& ctx, IR::Inst* inst) {
             FCODE(mulp)(src, GetVectorOf<fsize>(code, scale_factor));
         }
 
-        FCODE(roundp)(src, src, static_cast<u8>(round_imm));
+        if (rounding == FP::RoundingMode::ToNearest_TieAwayFromZero) {
+            const Xbyak::Xmm operand = ctx.reg_alloc.ScratchXmm();
+            const Xbyak::Xmm tmp1 = ctx.reg_alloc.ScratchXmm();
+            const Xbyak::Xmm tmp2 = ctx.reg_alloc.ScratchXmm();
+            code.movaps(operand, src);
+            EmitRoundTiesAwayFromZero<fsize>(code, src, operand, tmp1, tmp2);
+            ctx.reg_alloc.Release(operand);
+            ctx.reg_alloc.Release(tmp1);
+            ctx.reg_alloc.Release(tmp2);
+        } else {
+            FCODE(roundp)(src, src, static_cast<u8>(round_imm));
+        }
         ZeroIfNaN<fsize>(code, src);
 
         constexpr u64 float_upper_limit_signed = fsize == 32 ? 0x4f000000 : 0x43e0000000000000;
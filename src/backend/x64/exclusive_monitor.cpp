@@ -0,0 +1,99 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include <dynarmic/exclusive_monitor.h>
+#include "common/assert.h"
+
+namespace Dynarmic {
+
+ExclusiveMonitor::ExclusiveMonitor(size_t processor_count)
+    : exclusive_addresses(processor_count)
+    , event_registers(processor_count)
+{
+    for (GranuleLock& lock : locks) {
+        lock.is_locked.store(0, std::memory_order_relaxed);
+    }
+    for (EventRegister& event_register : event_registers) {
+        event_register.is_set.store(0, std::memory_order_relaxed);
+    }
+    Clear();
+}
+
+size_t ExclusiveMonitor::GetProcessorCount() const {
+    return exclusive_addresses.size();
+}
+
+void ExclusiveMonitor::Mark(size_t processor_id, VAddr address, size_t size) {
+    ASSERT(size <= 16);
+    const VAddr masked_address = address & RESERVATION_GRANULE_MASK;
+
+    // The lock orders this reservation against an in-flight exclusive operation on the same granule.
+    Lock(masked_address);
+    exclusive_addresses[processor_id].address.store(masked_address, std::memory_order_relaxed);
+    Unlock(masked_address);
+}
+
+void ExclusiveMonitor::Lock(VAddr address) {
+    std::atomic<std::uint8_t>& is_locked = locks[(address >> 4) % LOCK_COUNT].is_locked;
+    while (is_locked.exchange(1, std::memory_order_acquire) != 0) {}
+}
+
+void ExclusiveMonitor::Unlock(VAddr address) {
+    locks[(address >> 4) % LOCK_COUNT].is_locked.store(0, std::memory_order_release);
+}
+
+bool ExclusiveMonitor::CheckAndClear(size_t processor_id, VAddr address, size_t size) {
+    ASSERT(size <= 16);
+    const VAddr masked_address = address & RESERVATION_GRANULE_MASK;
+
+    Lock(masked_address);
+    if (exclusive_addresses[processor_id].address.load(std::memory_order_relaxed) != masked_address) {
+        Unlock(masked_address);
+        return false;
+    }
+
+    // Other processors may concurrently mark granules guarded by other locks, so only
+    // clear reservations which still hold this granule.
+    for (ExclusiveAddress& other : exclusive_addresses) {
+        VAddr expected = masked_address;
+        other.address.compare_exchange_strong(expected, INVALID_EXCLUSIVE_ADDRESS, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ExclusiveMonitor::Clear() {
+    for (ExclusiveAddress& exclusive_address : exclusive_addresses) {
+        exclusive_address.address.store(INVALID_EXCLUSIVE_ADDRESS, std::memory_order_relaxed);
+    }
+}
+
+void ExclusiveMonitor::SendEvent() {
+    for (EventRegister& event_register : event_registers) {
+        event_register.is_set.store(1, std::memory_order_seq_cst);
+    }
+}
+
+bool ExclusiveMonitor::ClearEventRegister(size_t processor_id) {
+    return event_registers[processor_id].is_set.exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+std::atomic<std::uint8_t>* ExclusiveMonitor::GetEventRegisterPointer(size_t processor_id) {
+    return &event_registers[processor_id].is_set;
+}
+
+std::atomic<std::uint8_t>* ExclusiveMonitor::GetWaitingForEventPointer() {
+    return &waiting_for_event;
+}
+
+std::atomic<ExclusiveMonitor::VAddr>* ExclusiveMonitor::GetExclusiveAddressPointer(size_t processor_id) {
+    return &exclusive_addresses[processor_id].address;
+}
+
+std::atomic<std::uint8_t>* ExclusiveMonitor::GetLockPointer(size_t lock_index) {
+    return &locks[lock_index].is_locked;
+}
+
+} // namespace Dynarmic
@@ -17,8 +17,10 @@ struct JitStateInfo {
     JitStateInfo(const JitStateType&)
         : offsetof_cycles_remaining(offsetof(JitStateType, cycles_remaining))
         , offsetof_cycles_to_run(offsetof(JitStateType, cycles_to_run))
+        , offsetof_halt_requested(offsetof(JitStateType, halt_requested))
         , offsetof_save_host_MXCSR(offsetof(JitStateType, save_host_MXCSR))
         , offsetof_guest_MXCSR(offsetof(JitStateType, guest_MXCSR))
+        , offsetof_guest_MXCSR_loaded(offsetof(JitStateType, guest_MXCSR_loaded))
         , offsetof_rsb_ptr(offsetof(JitStateType, rsb_ptr))
         , rsb_ptr_mask(JitStateType::RSBPtrMask)
         , offsetof_rsb_location_descriptors(offsetof(JitStateType, rsb_location_descriptors))
@@ -32,8 +34,10 @@ struct JitStateInfo {
 
     const size_t offsetof_cycles_remaining;
     const size_t offsetof_cycles_to_run;
+    const size_t offsetof_halt_requested;
     const size_t offsetof_save_host_MXCSR;
     const size_t offsetof_guest_MXCSR;
+    const size_t offsetof_guest_MXCSR_loaded;
     const size_t offsetof_rsb_ptr;
     const size_t rsb_ptr_mask;
     const size_t offsetof_rsb_location_descriptors;
@@ -5,7 +5,9 @@
  */
 
 #include <algorithm>
+#include <limits>
 #include <numeric>
+#include <tuple>
 #include <utility>
 
 #include <fmt/ostream.h>
@@ -14,6 +16,7 @@
 #include "backend/x64/abi.h"
 #include "backend/x64/reg_alloc.h"
 #include "common/assert.h"
+#include "frontend/ir/basic_block.h"
 
 namespace Dynarmic::BackendX64 {
 
@@ -86,6 +89,10 @@ bool HostLocInfo::IsLastUse() const {
     return is_being_used_count == 0 && current_references == 1 && accumulated_uses + 1 == total_uses;
 }
 
+bool HostLocInfo::IsDeadAfterCurrentInstruction() const {
+    return accumulated_uses + current_references == total_uses;
+}
+
 void HostLocInfo::ReadLock() {
     ASSERT(!is_scratch);
     is_being_used_count++;
@@ -137,6 +144,10 @@ bool HostLocInfo::ContainsValue(const IR::Inst* inst) const {
     return std::find(values.begin(), values.end(), inst) != values.end();
 }
 
+const std::vector<IR::Inst*>& HostLocInfo::GetValues() const {
+    return values;
+}
+
 size_t HostLocInfo::GetMaxBitWidth() const {
     return max_bit_width;
 }
@@ -227,6 +238,12 @@ bool Argument::IsInMemory() const {
     return HostLocIsSpill(*reg_alloc.ValueLocation(value.GetInst()));
 }
 
+bool Argument::IsInHostFlags() const {
+    if (IsImmediate())
+        return false;
+    return reg_alloc.host_flags_value == value.GetInst();
+}
+
 RegAlloc::ArgumentInfo RegAlloc::GetArgumentInfo(IR::Inst* inst) {
     ArgumentInfo ret = {Argument{*this}, Argument{*this}, Argument{*this}, Argument{*this}};
     for (size_t i = 0; i < inst->NumArgs(); i++) {
@@ -385,6 +402,14 @@ void RegAlloc::HostCall(IR::Inst* result_def, boost::optional<Argument&> arg0, b
         return ret;
     }();
 
+    made_host_call = true;
+
+    for (HostLoc caller_saved : ABI_ALL_CALLER_SAVE) {
+        if (!LocInfo(caller_saved).IsLocked()) {
+            MoveOutOfTheWayOfHostCall(caller_saved);
+        }
+    }
+
     ScratchGpr({ABI_RETURN});
     if (result_def) {
         DefineValueImpl(result_def, ABI_RETURN);
@@ -432,16 +457,75 @@ void RegAlloc::AssertNoMoreUses() {
     ASSERT(std::all_of(hostloc_info.begin(), hostloc_info.end(), [](const auto& i) { return i.IsEmpty(); }));
 }
 
+void RegAlloc::DefineValueInHostFlags(const IR::Inst* inst) {
+    host_flags_value = inst;
+    guest_nzcv_in_host_flags = false;
+}
+
+void RegAlloc::SetGuestNZCVInHostFlags() {
+    guest_nzcv_in_host_flags = true;
+}
+
+bool RegAlloc::IsGuestNZCVInHostFlags() const {
+    return guest_nzcv_in_host_flags;
+}
+
+void RegAlloc::ClobberHostFlags() {
+    host_flags_value = nullptr;
+    guest_nzcv_in_host_flags = false;
+}
+
+void RegAlloc::AnalyzeLiveness(const IR::Block& block, std::function<bool(const IR::Inst*)> is_host_call) {
+    liveness.emplace();
+
+    size_t position = 0;
+    for (const auto& inst : block) {
+        liveness->positions.emplace(&inst, position);
+
+        for (size_t i = 0; i < inst.NumArgs(); i++) {
+            const IR::Value arg = inst.GetArg(i);
+            if (!arg.IsImmediate()) {
+                liveness->use_positions[arg.GetInst()].push_back(position);
+            }
+        }
+
+        if (is_host_call(&inst)) {
+            liveness->host_call_positions.push_back(position);
+        }
+        if (inst.IsShift() && !inst.GetArg(1).IsImmediate()) {
+            liveness->variable_shift_positions.push_back(position);
+        }
+
+        position++;
+    }
+}
+
+void RegAlloc::BeginInstruction(const IR::Inst* inst) {
+    made_host_call = false;
+
+    if (!liveness) {
+        return;
+    }
+
+    liveness->current_position = liveness->positions.at(inst);
+    liveness->current_inst = inst;
+}
+
 HostLoc RegAlloc::SelectARegister(HostLocList desired_locations) const {
     std::vector<HostLoc> candidates = desired_locations;
 
     // Find all locations that have not been allocated..
     auto allocated_locs = std::partition(candidates.begin(), candidates.end(), [this](auto loc){
-        return !this->LocInfo(loc).IsLocked();
+        const bool is_reserved = std::find(reserved_locations.begin(), reserved_locations.end(), loc) != reserved_locations.end();
+        return !is_reserved && !this->LocInfo(loc).IsLocked();
     });
     candidates.erase(allocated_locs, candidates.end());
     ASSERT_MSG(!candidates.empty(), "All candidate registers have already been allocated");
 
+    if (liveness) {
+        return SelectARegisterUsingLiveness(candidates);
+    }
+
     // Selects the best location out of the available locations.
     // TODO: Actually do LRU or something. Currently we just try to pick something without a value if possible.
 
@@ -452,6 +536,63 @@ HostLoc RegAlloc::SelectARegister(HostLocList desired_locations) const {
     return candidates.front();
 }
 
+HostLoc RegAlloc::SelectARegisterUsingLiveness(const std::vector<HostLoc>& candidates) const {
+    const size_t current_position = liveness->current_position;
+
+    // Registers are very likely being selected for the result of the current instruction, so avoid
+    // those that are clobbered before its last use.
+    size_t live_until = current_position;
+    if (liveness->current_inst) {
+        const auto iter = liveness->use_positions.find(liveness->current_inst);
+        if (iter != liveness->use_positions.end()) {
+            live_until = iter->second.back();
+        }
+    }
+
+    const auto occurs_within_live_range = [&](const std::vector<size_t>& positions) {
+        const auto iter = std::lower_bound(positions.begin(), positions.end(), current_position);
+        return iter != positions.end() && *iter <= live_until;
+    };
+    const bool crosses_host_call = occurs_within_live_range(liveness->host_call_positions);
+    const bool crosses_variable_shift = occurs_within_live_range(liveness->variable_shift_positions);
+
+    const auto is_caller_save = [](HostLoc loc) {
+        return std::find(ABI_ALL_CALLER_SAVE.begin(), ABI_ALL_CALLER_SAVE.end(), loc) != ABI_ALL_CALLER_SAVE.end();
+    };
+
+    // Lower is better. Empty registers come first; amongst those, callee-saved registers are kept for
+    // results that live across a host call. Amongst occupied registers, the one whose contents are
+    // next used furthest in the future is evicted.
+    const auto cost = [&](HostLoc loc) {
+        if (!LocInfo(loc).IsEmpty()) {
+            return std::make_tuple(true, false, false, std::numeric_limits<size_t>::max() - NextUse(loc));
+        }
+        const bool clobbered = (crosses_host_call && is_caller_save(loc)) || (crosses_variable_shift && loc == HostLoc::RCX);
+        const bool reserved = !crosses_host_call && !is_caller_save(loc);
+        return std::make_tuple(false, clobbered, reserved, size_t(0));
+    };
+
+    return *std::min_element(candidates.begin(), candidates.end(), [&](HostLoc a, HostLoc b) {
+        return cost(a) < cost(b);
+    });
+}
+
+size_t RegAlloc::NextUse(HostLoc loc) const {
+    size_t next_use = std::numeric_limits<size_t>::max();
+    for (const IR::Inst* value : LocInfo(loc).GetValues()) {
+        const auto iter = liveness->use_positions.find(value);
+        if (iter == liveness->use_positions.end()) {
+            continue;
+        }
+        const auto& positions = iter->second;
+        const auto position = std::lower_bound(positions.begin(), positions.end(), liveness->current_position);
+        if (position != positions.end()) {
+            next_use = std::min(next_use, *position);
+        }
+    }
+    return next_use;
+}
+
 boost::optional<HostLoc> RegAlloc::ValueLocation(const IR::Inst* value) const {
     for (size_t i = 0; i < hostloc_info.size(); i++)
         if (hostloc_info[i].ContainsValue(value))
@@ -554,6 +695,46 @@ void RegAlloc::MoveOutOfTheWay(HostLoc reg) {
     }
 }
 
+void RegAlloc::MoveOutOfTheWayOfHostCall(HostLoc reg) {
+    ASSERT(!LocInfo(reg).IsLocked());
+    if (LocInfo(reg).IsEmpty() || LocInfo(reg).IsDeadAfterCurrentInstruction()) {
+        // Arguments of this call are left for the code below to consume in place.
+        return;
+    }
+
+    const auto& allocatable = HostLocIsGPR(reg) ? any_gpr : any_xmm;
+    std::vector<HostLoc> candidates;
+    for (HostLoc loc : ABI_ALL_CALLEE_SAVE) {
+        const bool is_allocatable = std::find(allocatable.begin(), allocatable.end(), loc) != allocatable.end();
+        const bool is_reserved = std::find(reserved_locations.begin(), reserved_locations.end(), loc) != reserved_locations.end();
+        if (is_allocatable && !is_reserved && !LocInfo(loc).IsLocked()) {
+            candidates.emplace_back(loc);
+        }
+    }
+
+    // A free callee-saved register keeps the value in a register across the call, which replaces
+    // a store before the call and a load at the next use with a single move.
+    const auto empty = std::find_if(candidates.begin(), candidates.end(), [this](HostLoc loc) { return LocInfo(loc).IsEmpty(); });
+    if (empty != candidates.end()) {
+        Move(*empty, reg);
+        return;
+    }
+
+    // Otherwise the value that is needed last goes to memory.
+    if (liveness && !candidates.empty()) {
+        const HostLoc furthest = *std::max_element(candidates.begin(), candidates.end(), [this](HostLoc a, HostLoc b) {
+            return NextUse(a) < NextUse(b);
+        });
+        if (NextUse(furthest) > NextUse(reg)) {
+            SpillRegister(furthest);
+            Move(furthest, reg);
+            return;
+        }
+    }
+
+    SpillRegister(reg);
+}
+
 void RegAlloc::SpillRegister(HostLoc loc) {
     ASSERT_MSG(HostLocIsRegister(loc), "Only registers can be spilled");
     ASSERT_MSG(!LocInfo(loc).IsEmpty(), "There is no need to spill unoccupied registers");
@@ -584,6 +765,12 @@ const HostLocInfo& RegAlloc::LocInfo(HostLoc loc) const {
 }
 
 void RegAlloc::EmitMove(size_t bit_width, HostLoc to, HostLoc from) {
+    if (HostLocIsSpill(to) || HostLocIsSpill(from)) {
+        spill_count++;
+    } else {
+        move_count++;
+    }
+
     if (HostLocIsXMM(to) && HostLocIsXMM(from)) {
         MAYBE_AVX(movaps, HostLocToXmm(to), HostLocToXmm(from));
     } else if (HostLocIsGPR(to) && HostLocIsGPR(from)) {
@@ -663,6 +850,8 @@ void RegAlloc::EmitMove(size_t bit_width, HostLoc to, HostLoc from) {
 }
 
 void RegAlloc::EmitExchange(HostLoc a, HostLoc b) {
+    move_count++;
+
     if (HostLocIsGPR(a) && HostLocIsGPR(b)) {
         code.xchg(HostLocToReg64(a), HostLocToReg64(b));
     } else if (HostLocIsXMM(a) && HostLocIsXMM(b)) {
@@ -8,6 +8,7 @@
 
 #include <array>
 #include <functional>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -22,6 +23,10 @@
 #include "frontend/ir/microinstruction.h"
 #include "frontend/ir/value.h"
 
+namespace Dynarmic::IR {
+class Block;
+} // namespace Dynarmic::IR
+
 namespace Dynarmic::BackendX64 {
 
 class RegAlloc;
@@ -31,6 +36,7 @@ public:
     bool IsLocked() const;
     bool IsEmpty() const;
     bool IsLastUse() const;
+    bool IsDeadAfterCurrentInstruction() const;
 
     void ReadLock();
     void WriteLock();
@@ -39,6 +45,7 @@ public:
     void ReleaseAll();
 
     bool ContainsValue(const IR::Inst* inst) const;
+    const std::vector<IR::Inst*>& GetValues() const;
     size_t GetMaxBitWidth() const;
 
     void AddValue(IR::Inst* inst);
@@ -81,6 +88,8 @@ public:
     bool IsInXmm() const;
     /// Is this value currently in memory?
     bool IsInMemory() const;
+    /// Is this value currently in the host flags?
+    bool IsInHostFlags() const;
 
 private:
     friend class RegAlloc;
@@ -95,8 +104,8 @@ class RegAlloc final {
 public:
     using ArgumentInfo = std::array<Argument, IR::max_arg_count>;
 
-    explicit RegAlloc(BlockOfCode& code, size_t num_spills, std::function<Xbyak::Address(HostLoc)> spill_to_addr)
-        : hostloc_info(NonSpillHostLocCount + num_spills), code(code), spill_to_addr(std::move(spill_to_addr)) {}
+    explicit RegAlloc(BlockOfCode& code, size_t num_spills, std::function<Xbyak::Address(HostLoc)> spill_to_addr, std::vector<HostLoc> reserved_locations = {})
+        : hostloc_info(NonSpillHostLocCount + num_spills), reserved_locations(std::move(reserved_locations)), code(code), spill_to_addr(std::move(spill_to_addr)) {}
 
     ArgumentInfo GetArgumentInfo(IR::Inst* inst);
 
@@ -119,16 +128,49 @@ public:
 
     void HostCall(IR::Inst* result_def = nullptr, boost::optional<Argument&> arg0 = {}, boost::optional<Argument&> arg1 = {}, boost::optional<Argument&> arg2 = {}, boost::optional<Argument&> arg3 = {});
 
-    // TODO: Values in host flags
+    /// Records that the host SF, ZF, CF and OF flags hold the NZCV value inst.
+    void DefineValueInHostFlags(const IR::Inst* inst);
+    /// Records that the host flags hold the guest NZCV, as most recently written to the JitState.
+    void SetGuestNZCVInHostFlags();
+    bool IsGuestNZCVInHostFlags() const;
+    /// Forgets the contents of the host flags. Call whenever emitted code may have modified them.
+    void ClobberHostFlags();
 
     void EndOfAllocScope();
 
     void AssertNoMoreUses();
 
+    /// Computes the live range of every value in block ahead of emission. Subsequent register
+    /// selection evicts the value whose next use is furthest away, and avoids registers which
+    /// an instruction within the live range of the current result requires (rcx for variable
+    /// shifts, caller-saved registers for instructions identified by is_host_call).
+    void AnalyzeLiveness(const IR::Block& block, std::function<bool(const IR::Inst*)> is_host_call);
+    /// Informs the allocator of the instruction about to be emitted. Only required after AnalyzeLiveness
+    /// or for MadeHostCall.
+    void BeginInstruction(const IR::Inst* inst);
+    /// Whether HostCall has been called since the last BeginInstruction.
+    bool MadeHostCall() const { return made_host_call; }
+
+    /// Number of loads from and stores to spill slots emitted so far.
+    size_t SpillCount() const { return spill_count; }
+    /// Number of moves and exchanges between host registers emitted so far.
+    size_t MoveCount() const { return move_count; }
+
 private:
     friend struct Argument;
 
+    struct Liveness {
+        std::unordered_map<const IR::Inst*, size_t> positions;
+        std::unordered_map<const IR::Inst*, std::vector<size_t>> use_positions;
+        std::vector<size_t> host_call_positions;
+        std::vector<size_t> variable_shift_positions;
+        size_t current_position = 0;
+        const IR::Inst* current_inst = nullptr;
+    };
+
     HostLoc SelectARegister(HostLocList desired_locations) const;
+    HostLoc SelectARegisterUsingLiveness(const std::vector<HostLoc>& candidates) const;
+    size_t NextUse(HostLoc loc) const;
     boost::optional<HostLoc> ValueLocation(const IR::Inst* value) const;
 
     HostLoc UseImpl(IR::Value use_value, HostLocList desired_locations);
@@ -142,14 +184,27 @@ private:
     void CopyToScratch(size_t bit_width, HostLoc to, HostLoc from);
     void Exchange(HostLoc a, HostLoc b);
     void MoveOutOfTheWay(HostLoc reg);
+    /// Moves values which are still needed after the current instruction out of a caller-saved register.
+    void MoveOutOfTheWayOfHostCall(HostLoc reg);
 
     void SpillRegister(HostLoc loc);
     HostLoc FindFreeSpill() const;
 
     std::vector<HostLocInfo> hostloc_info;
+    /// Locations which are never allocated, as they are in use for the whole of the block.
+    std::vector<HostLoc> reserved_locations;
     HostLocInfo& LocInfo(HostLoc loc);
     const HostLocInfo& LocInfo(HostLoc loc) const;
 
+    boost::optional<Liveness> liveness;
+
+    const IR::Inst* host_flags_value = nullptr;
+    bool guest_nzcv_in_host_flags = false;
+    bool made_host_call = false;
+
+    size_t spill_count = 0;
+    size_t move_count = 0;
+
     BlockOfCode& code;
     std::function<Xbyak::Address(HostLoc)> spill_to_addr;
     void EmitMove(size_t bit_width, HostLoc to, HostLoc from);
@@ -0,0 +1,44 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include "common/common_types.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Dynarmic::Atomic {
+
+// These operate on plain volatile words so that the words can live in structures which emitted code
+// accesses directly and which are otherwise freely copied.
+
+inline u32 Exchange(volatile u32* ptr, u32 value) {
+#ifdef _MSC_VER
+    return static_cast<u32>(_InterlockedExchange(reinterpret_cast<volatile long*>(ptr), static_cast<long>(value)));
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+inline u64 Exchange(volatile u64* ptr, u64 value) {
+#ifdef _MSC_VER
+    return static_cast<u64>(_InterlockedExchange64(reinterpret_cast<volatile __int64*>(ptr), static_cast<__int64>(value)));
+#else
+    return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+inline u32 Or(volatile u32* ptr, u32 value) {
+#ifdef _MSC_VER
+    return static_cast<u32>(_InterlockedOr(reinterpret_cast<volatile long*>(ptr), static_cast<long>(value)));
+#else
+    return __atomic_fetch_or(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+} // namespace Dynarmic::Atomic
@@ -0,0 +1,70 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace Dynarmic::Common {
+
+/**
+ * A lock-free multiple-producer single-consumer queue.
+ * Push may be called concurrently from any thread. Drain must only be called by the consumer.
+ */
+template <typename T>
+class MPSCQueue final {
+public:
+    MPSCQueue() = default;
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    ~MPSCQueue() {
+        Drain([](T&&){});
+    }
+
+    void Push(T value) {
+        Node* node = new Node{std::move(value), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// Calls fn on every element pushed so far, in the order they were pushed.
+    template <typename Fn>
+    void Drain(Fn fn) {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+        // Elements are linked newest first.
+        Node* reversed = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+
+        while (reversed) {
+            Node* next = reversed->next;
+            fn(std::move(reversed->value));
+            delete reversed;
+            reversed = next;
+        }
+    }
+
+    bool IsEmpty() const {
+        return head.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+};
+
+} // namespace Dynarmic::Common
@@ -186,6 +186,17 @@ IR::U64 IREmitter::ReadMemory64(const IR::U32& vaddr) {
     return current_location.EFlag() ? ByteReverseDual(value) : value;
 }
 
+IR::U64 IREmitter::ReadMemory32x2(const IR::U32& vaddr) {
+    auto value = Inst<IR::U64>(Opcode::A32ReadMemory32x2, vaddr);
+    if (!current_location.EFlag()) {
+        return value;
+    }
+    // Each word is byte-reversed independently; word order is unchanged.
+    auto lo = ByteReverseWord(LeastSignificantWord(value));
+    auto hi = ByteReverseWord(MostSignificantWord(value).result);
+    return Pack2x32To1x64(lo, hi);
+}
+
 void IREmitter::WriteMemory8(const IR::U32& vaddr, const IR::U8& value) {
     Inst(Opcode::A32WriteMemory8, vaddr, value);
 }
@@ -217,6 +228,16 @@ void IREmitter::WriteMemory64(const IR::U32& vaddr, const IR::U64& value) {
     }
 }
 
+void IREmitter::WriteMemory32x2(const IR::U32& vaddr, const IR::U64& value) {
+    if (current_location.EFlag()) {
+        auto lo = ByteReverseWord(LeastSignificantWord(value));
+        auto hi = ByteReverseWord(MostSignificantWord(value).result);
+        Inst(Opcode::A32WriteMemory32x2, vaddr, Pack2x32To1x64(lo, hi));
+    } else {
+        Inst(Opcode::A32WriteMemory32x2, vaddr, value);
+    }
+}
+
 IR::U32 IREmitter::ExclusiveWriteMemory8(const IR::U32& vaddr, const IR::U8& value) {
     return Inst<IR::U32>(Opcode::A32ExclusiveWriteMemory8, vaddr, value);
 }
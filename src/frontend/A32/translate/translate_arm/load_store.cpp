@@ -4,6 +4,8 @@
  * General Public License version 2 or any later version.
  */
 
+#include <vector>
+
 #include "translate_arm.h"
 
 namespace Dynarmic::A32 {
@@ -608,13 +610,26 @@ bool ArmTranslatorVisitor::arm_STRH_reg(Cond cond, bool P, bool U, bool W, Reg n
 }
 
 static bool LDMHelper(A32::IREmitter& ir, bool W, Reg n, RegList list, IR::U32 start_address, IR::U32 writeback_address) {
-    auto address = start_address;
+    std::vector<Reg> regs;
     for (size_t i = 0; i <= 14; i++) {
         if (Common::Bit(i, list)) {
-            ir.SetRegister(static_cast<Reg>(i), ir.ReadMemory32(address));
-            address = ir.Add(address, ir.Imm32(4));
+            regs.emplace_back(static_cast<Reg>(i));
         }
     }
+
+    // Registers are transferred from consecutive words, so transfer them two at a time.
+    auto address = start_address;
+    size_t i = 0;
+    for (; i + 1 < regs.size(); i += 2) {
+        const auto data = ir.ReadMemory32x2(address);
+        ir.SetRegister(regs[i], ir.LeastSignificantWord(data));
+        ir.SetRegister(regs[i + 1], ir.MostSignificantWord(data).result);
+        address = ir.Add(address, ir.Imm32(8));
+    }
+    if (i < regs.size()) {
+        ir.SetRegister(regs[i], ir.ReadMemory32(address));
+        address = ir.Add(address, ir.Imm32(4));
+    }
     if (W && !Common::Bit(RegNumber(n), list)) {
         ir.SetRegister(n, writeback_address);
     }
@@ -686,19 +701,29 @@ bool ArmTranslatorVisitor::arm_LDM_eret() {
 }
 
 static bool STMHelper(A32::IREmitter& ir, bool W, Reg n, RegList list, IR::U32 start_address, IR::U32 writeback_address) {
-    auto address = start_address;
+    std::vector<IR::U32> values;
     for (size_t i = 0; i <= 14; i++) {
         if (Common::Bit(i, list)) {
-            ir.WriteMemory32(address, ir.GetRegister(static_cast<Reg>(i)));
-            address = ir.Add(address, ir.Imm32(4));
+            values.emplace_back(ir.GetRegister(static_cast<Reg>(i)));
         }
     }
+    if (Common::Bit<15>(list)) {
+        values.emplace_back(ir.Imm32(ir.PC()));
+    }
+
+    // Registers are transferred to consecutive words, so transfer them two at a time.
+    auto address = start_address;
+    size_t i = 0;
+    for (; i + 1 < values.size(); i += 2) {
+        ir.WriteMemory32x2(address, ir.Pack2x32To1x64(values[i], values[i + 1]));
+        address = ir.Add(address, ir.Imm32(8));
+    }
+    if (i < values.size()) {
+        ir.WriteMemory32(address, values[i]);
+    }
     if (W) {
         ir.SetRegister(n, writeback_address);
     }
-    if (Common::Bit<15>(list)) {
-        ir.WriteMemory32(address, ir.Imm32(ir.PC()));
-    }
     return true;
 }
 
@@ -49,6 +49,18 @@ void IREmitter::DataCacheOperationRaised(DataCacheOperation op, const IR::U64& v
     Inst(Opcode::A64DataCacheOperationRaised, Imm64(static_cast<u64>(op)), value);
 }
 
+void IREmitter::WaitForEvent(u64 pc) {
+    Inst(Opcode::A64WaitForEvent, Imm64(pc));
+}
+
+void IREmitter::SendEvent(u64 pc) {
+    Inst(Opcode::A64SendEvent, Imm64(pc));
+}
+
+void IREmitter::SendEventLocal() {
+    Inst(Opcode::A64SendEventLocal);
+}
+
 void IREmitter::DataSynchronizationBarrier() {
     Inst(Opcode::A64DataSynchronizationBarrier);
 }
@@ -118,6 +130,20 @@ IR::U128 IREmitter::ReadMemory128(const IR::U64& vaddr) {
     return Inst<IR::U128>(Opcode::A64ReadMemory128, vaddr);
 }
 
+IR::U64 IREmitter::ReadMemory32x2(const IR::U64& vaddr) {
+    return Inst<IR::U64>(Opcode::A64ReadMemory32x2, vaddr);
+}
+
+IR::U128 IREmitter::ReadMemory64x2(const IR::U64& vaddr, size_t esize) {
+    return Inst<IR::U128>(Opcode::A64ReadMemory64x2, vaddr, Imm8(static_cast<u8>(esize)));
+}
+
+IR::FirstAndSecond IREmitter::ReadMemory64Pair(const IR::U64& vaddr) {
+    const auto first = Inst<IR::U64>(Opcode::A64ReadMemory64Pair, vaddr);
+    const auto second = Inst<IR::U64>(Opcode::GetSecondFromOp, first);
+    return {first, second};
+}
+
 void IREmitter::WriteMemory8(const IR::U64& vaddr, const IR::U8& value) {
     Inst(Opcode::A64WriteMemory8, vaddr, value);
 }
@@ -138,6 +164,38 @@ void IREmitter::WriteMemory128(const IR::U64& vaddr, const IR::U128& value) {
     Inst(Opcode::A64WriteMemory128, vaddr, value);
 }
 
+void IREmitter::WriteMemory32x2(const IR::U64& vaddr, const IR::U64& value) {
+    Inst(Opcode::A64WriteMemory32x2, vaddr, value);
+}
+
+void IREmitter::WriteMemory64x2(const IR::U64& vaddr, const IR::U128& value, size_t esize) {
+    Inst(Opcode::A64WriteMemory64x2, vaddr, value, Imm8(static_cast<u8>(esize)));
+}
+
+void IREmitter::WriteMemory64Pair(const IR::U64& vaddr, const IR::U64& first, const IR::U64& second) {
+    Inst(Opcode::A64WriteMemory64Pair, vaddr, first, second);
+}
+
+IR::U8 IREmitter::ExclusiveReadMemory8(const IR::U64& vaddr) {
+    return Inst<IR::U8>(Opcode::A64ExclusiveReadMemory8, vaddr);
+}
+
+IR::U16 IREmitter::ExclusiveReadMemory16(const IR::U64& vaddr) {
+    return Inst<IR::U16>(Opcode::A64ExclusiveReadMemory16, vaddr);
+}
+
+IR::U32 IREmitter::ExclusiveReadMemory32(const IR::U64& vaddr) {
+    return Inst<IR::U32>(Opcode::A64ExclusiveReadMemory32, vaddr);
+}
+
+IR::U64 IREmitter::ExclusiveReadMemory64(const IR::U64& vaddr) {
+    return Inst<IR::U64>(Opcode::A64ExclusiveReadMemory64, vaddr);
+}
+
+IR::U128 IREmitter::ExclusiveReadMemory128(const IR::U64& vaddr) {
+    return Inst<IR::U128>(Opcode::A64ExclusiveReadMemory128, vaddr);
+}
+
 IR::U32 IREmitter::ExclusiveWriteMemory8(const IR::U64& vaddr, const IR::U8& value) {
     return Inst<IR::U32>(Opcode::A64ExclusiveWriteMemory8, vaddr, value);
 }
@@ -158,6 +216,42 @@ IR::U32 IREmitter::ExclusiveWriteMemory128(const IR::U64& vaddr, const IR::U128&
     return Inst<IR::U32>(Opcode::A64ExclusiveWriteMemory128, vaddr, value);
 }
 
+IR::U8 IREmitter::AtomicMemoryOperation8(const IR::U64& vaddr, const IR::U8& value, AtomicOp op) {
+    return Inst<IR::U8>(Opcode::A64AtomicMemoryOperation8, vaddr, value, Imm8(static_cast<u8>(op)));
+}
+
+IR::U16 IREmitter::AtomicMemoryOperation16(const IR::U64& vaddr, const IR::U16& value, AtomicOp op) {
+    return Inst<IR::U16>(Opcode::A64AtomicMemoryOperation16, vaddr, value, Imm8(static_cast<u8>(op)));
+}
+
+IR::U32 IREmitter::AtomicMemoryOperation32(const IR::U64& vaddr, const IR::U32& value, AtomicOp op) {
+    return Inst<IR::U32>(Opcode::A64AtomicMemoryOperation32, vaddr, value, Imm8(static_cast<u8>(op)));
+}
+
+IR::U64 IREmitter::AtomicMemoryOperation64(const IR::U64& vaddr, const IR::U64& value, AtomicOp op) {
+    return Inst<IR::U64>(Opcode::A64AtomicMemoryOperation64, vaddr, value, Imm8(static_cast<u8>(op)));
+}
+
+IR::U8 IREmitter::CompareAndSwapMemory8(const IR::U64& vaddr, const IR::U8& expected, const IR::U8& desired) {
+    return Inst<IR::U8>(Opcode::A64CompareAndSwapMemory8, vaddr, expected, desired);
+}
+
+IR::U16 IREmitter::CompareAndSwapMemory16(const IR::U64& vaddr, const IR::U16& expected, const IR::U16& desired) {
+    return Inst<IR::U16>(Opcode::A64CompareAndSwapMemory16, vaddr, expected, desired);
+}
+
+IR::U32 IREmitter::CompareAndSwapMemory32(const IR::U64& vaddr, const IR::U32& expected, const IR::U32& desired) {
+    return Inst<IR::U32>(Opcode::A64CompareAndSwapMemory32, vaddr, expected, desired);
+}
+
+IR::U64 IREmitter::CompareAndSwapMemory64(const IR::U64& vaddr, const IR::U64& expected, const IR::U64& desired) {
+    return Inst<IR::U64>(Opcode::A64CompareAndSwapMemory64, vaddr, expected, desired);
+}
+
+IR::U128 IREmitter::CompareAndSwapMemory128(const IR::U64& vaddr, const IR::U128& expected, const IR::U128& desired) {
+    return Inst<IR::U128>(Opcode::A64CompareAndSwapMemory128, vaddr, expected, desired);
+}
+
 IR::U32 IREmitter::GetW(Reg reg) {
     if (reg == Reg::ZR)
         return Imm32(0);
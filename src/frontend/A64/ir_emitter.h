@@ -43,6 +43,9 @@ public:
     void CallSupervisor(u32 imm);
     void ExceptionRaised(Exception exception);
     void DataCacheOperationRaised(DataCacheOperation op, const IR::U64& value);
+    void WaitForEvent(u64 pc);
+    void SendEvent(u64 pc);
+    void SendEventLocal();
     void DataSynchronizationBarrier();
     void DataMemoryBarrier();
     void InstructionSynchronizationBarrier();
@@ -61,16 +64,36 @@ public:
     IR::U32 ReadMemory32(const IR::U64& vaddr);
     IR::U64 ReadMemory64(const IR::U64& vaddr);
     IR::U128 ReadMemory128(const IR::U64& vaddr);
+    IR::U64 ReadMemory32x2(const IR::U64& vaddr);
+    IR::U128 ReadMemory64x2(const IR::U64& vaddr, size_t esize);
+    IR::FirstAndSecond ReadMemory64Pair(const IR::U64& vaddr);
     void WriteMemory8(const IR::U64& vaddr, const IR::U8& value);
     void WriteMemory16(const IR::U64& vaddr, const IR::U16& value);
     void WriteMemory32(const IR::U64& vaddr, const IR::U32& value);
     void WriteMemory64(const IR::U64& vaddr, const IR::U64& value);
     void WriteMemory128(const IR::U64& vaddr, const IR::U128& value);
+    void WriteMemory32x2(const IR::U64& vaddr, const IR::U64& value);
+    void WriteMemory64x2(const IR::U64& vaddr, const IR::U128& value, size_t esize);
+    void WriteMemory64Pair(const IR::U64& vaddr, const IR::U64& first, const IR::U64& second);
+    IR::U8 ExclusiveReadMemory8(const IR::U64& vaddr);
+    IR::U16 ExclusiveReadMemory16(const IR::U64& vaddr);
+    IR::U32 ExclusiveReadMemory32(const IR::U64& vaddr);
+    IR::U64 ExclusiveReadMemory64(const IR::U64& vaddr);
+    IR::U128 ExclusiveReadMemory128(const IR::U64& vaddr);
     IR::U32 ExclusiveWriteMemory8(const IR::U64& vaddr, const IR::U8& value);
     IR::U32 ExclusiveWriteMemory16(const IR::U64& vaddr, const IR::U16& value);
     IR::U32 ExclusiveWriteMemory32(const IR::U64& vaddr, const IR::U32& value);
     IR::U32 ExclusiveWriteMemory64(const IR::U64& vaddr, const IR::U64& value);
     IR::U32 ExclusiveWriteMemory128(const IR::U64& vaddr, const IR::U128& value);
+    IR::U8 AtomicMemoryOperation8(const IR::U64& vaddr, const IR::U8& value, AtomicOp op);
+    IR::U16 AtomicMemoryOperation16(const IR::U64& vaddr, const IR::U16& value, AtomicOp op);
+    IR::U32 AtomicMemoryOperation32(const IR::U64& vaddr, const IR::U32& value, AtomicOp op);
+    IR::U64 AtomicMemoryOperation64(const IR::U64& vaddr, const IR::U64& value, AtomicOp op);
+    IR::U8 CompareAndSwapMemory8(const IR::U64& vaddr, const IR::U8& expected, const IR::U8& desired);
+    IR::U16 CompareAndSwapMemory16(const IR::U64& vaddr, const IR::U16& expected, const IR::U16& desired);
+    IR::U32 CompareAndSwapMemory32(const IR::U64& vaddr, const IR::U32& expected, const IR::U32& desired);
+    IR::U64 CompareAndSwapMemory64(const IR::U64& vaddr, const IR::U64& expected, const IR::U64& desired);
+    IR::U128 CompareAndSwapMemory128(const IR::U64& vaddr, const IR::U128& expected, const IR::U128& desired);
 
     IR::U32 GetW(Reg source_reg);
     IR::U64 GetX(Reg source_reg);
@@ -314,6 +314,24 @@ void TranslatorVisitor::Mem(IR::U64 address, size_t bytesize, AccType /*acctype*
     }
 }
 
+IR::UAnyU128 TranslatorVisitor::ExclusiveMem(IR::U64 address, size_t bytesize, AccType /*acctype*/) {
+    switch (bytesize) {
+    case 1:
+        return ir.ExclusiveReadMemory8(address);
+    case 2:
+        return ir.ExclusiveReadMemory16(address);
+    case 4:
+        return ir.ExclusiveReadMemory32(address);
+    case 8:
+        return ir.ExclusiveReadMemory64(address);
+    case 16:
+        return ir.ExclusiveReadMemory128(address);
+    default:
+        ASSERT_MSG(false, "Invalid bytesize parameter {}", bytesize);
+        return {};
+    }
+}
+
 IR::U32 TranslatorVisitor::ExclusiveMem(IR::U64 address, size_t bytesize, AccType /*acctype*/, IR::UAnyU128 value) {
     switch (bytesize) {
     case 1:
@@ -332,6 +350,40 @@ IR::U32 TranslatorVisitor::ExclusiveMem(IR::U64 address, size_t bytesize, AccTyp
     }
 }
 
+IR::UAny TranslatorVisitor::AtomicMem(IR::U64 address, size_t bytesize, AccType /*acctype*/, AtomicOp op, IR::UAny value) {
+    switch (bytesize) {
+    case 1:
+        return ir.AtomicMemoryOperation8(address, value, op);
+    case 2:
+        return ir.AtomicMemoryOperation16(address, value, op);
+    case 4:
+        return ir.AtomicMemoryOperation32(address, value, op);
+    case 8:
+        return ir.AtomicMemoryOperation64(address, value, op);
+    default:
+        ASSERT_MSG(false, "Invalid bytesize parameter {}", bytesize);
+        return {};
+    }
+}
+
+IR::UAnyU128 TranslatorVisitor::CompareAndSwapMem(IR::U64 address, size_t bytesize, AccType /*acctype*/, IR::UAnyU128 expected, IR::UAnyU128 desired) {
+    switch (bytesize) {
+    case 1:
+        return ir.CompareAndSwapMemory8(address, expected, desired);
+    case 2:
+        return ir.CompareAndSwapMemory16(address, expected, desired);
+    case 4:
+        return ir.CompareAndSwapMemory32(address, expected, desired);
+    case 8:
+        return ir.CompareAndSwapMemory64(address, expected, desired);
+    case 16:
+        return ir.CompareAndSwapMemory128(address, expected, desired);
+    default:
+        ASSERT_MSG(false, "Invalid bytesize parameter {}", bytesize);
+        return {};
+    }
+}
+
 IR::U32U64 TranslatorVisitor::SignExtend(IR::UAny value, size_t to_size) {
     switch (to_size) {
     case 32:
@@ -0,0 +1,74 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include "frontend/A64/translate/impl/impl.h"
+
+namespace Dynarmic::A64 {
+
+static bool AtomicMemorySharedDecodeAndOperation(TranslatorVisitor& v, Imm<2> size, bool A, bool R, AtomicOp op, Reg Rs, Reg Rn, Reg Rt) {
+    // Shared Decode
+
+    const size_t datasize = 8 << size.ZeroExtend<size_t>();
+    const size_t regsize = datasize == 64 ? 64 : 32;
+
+    const AccType acctype = (A && Rt != Reg::ZR) || R ? AccType::ORDEREDRW : AccType::ATOMIC;
+
+    // Operation
+
+    const size_t dbytes = datasize / 8;
+
+    IR::U64 address;
+    if (Rn == Reg::SP) {
+        // TODO: Check SP Alignment
+        address = v.SP(64);
+    } else {
+        address = v.X(64, Rn);
+    }
+
+    const IR::UAny value = v.X(datasize, Rs);
+    const IR::UAny data = v.AtomicMem(address, dbytes, acctype, op, value);
+    v.X(regsize, Rt, v.ZeroExtend(data, regsize));
+
+    return true;
+}
+
+bool TranslatorVisitor::LDADD(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::ADD, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDCLR(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::CLR, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDEOR(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::EOR, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDSET(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::SET, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDSMAX(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::SMAX, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDSMIN(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::SMIN, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDUMAX(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::UMAX, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::LDUMIN(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::UMIN, Rs, Rn, Rt);
+}
+
+bool TranslatorVisitor::SWP(Imm<2> size, bool A, bool R, Reg Rs, Reg Rn, Reg Rt) {
+    return AtomicMemorySharedDecodeAndOperation(*this, size, A, R, AtomicOp::SWP, Rs, Rn, Rt);
+}
+
+} // namespace Dynarmic::A64
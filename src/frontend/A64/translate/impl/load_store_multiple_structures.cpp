@@ -4,6 +4,7 @@
  * General Public License version 2 or any later version.
  */
 
+#include <array>
 #include <tuple>
 
 #include <boost/optional.hpp>
@@ -64,9 +65,28 @@ static bool SharedDecodeAndOperation(TranslatorVisitor& v, bool wback, MemOp mem
     else
         address = v.X(64, Rn);
 
+    const auto vec_reg = [&](size_t i) {
+        return static_cast<Vec>((VecNumber(Vt) + i) % 32);
+    };
+
     IR::U64 offs = v.ir.Imm64(0);
     if (selem == 1) {
-        for (size_t r = 0; r < rpt; r++) {
+        size_t r = 0;
+        if (datasize == 64) {
+            // Pairs of doubleword registers are transferred with a single quadword access.
+            for (; r + 1 < rpt; r += 2) {
+                if (memop == MemOp::LOAD) {
+                    const IR::U128 data = v.ir.ReadMemory64x2(v.ir.Add(address, offs), 64);
+                    v.V(64, vec_reg(r), data);
+                    v.V(64, vec_reg(r + 1), v.ir.VectorInterleaveUpper(64, data, data));
+                } else {
+                    const IR::U128 data = v.ir.VectorInterleaveLower(64, v.V(64, vec_reg(r)), v.V(64, vec_reg(r + 1)));
+                    v.ir.WriteMemory64x2(v.ir.Add(address, offs), data, 64);
+                }
+                offs = v.ir.Add(offs, v.ir.Imm64(16));
+            }
+        }
+        for (; r < rpt; r++) {
             const Vec tt = static_cast<Vec>((VecNumber(Vt) + r) % 32);
             if (memop == MemOp::LOAD) {
                 const IR::UAnyU128 vec = v.Mem(v.ir.Add(address, offs), ebytes * elements, AccType::VEC);
@@ -77,6 +97,67 @@ static bool SharedDecodeAndOperation(TranslatorVisitor& v, bool wback, MemOp mem
             }
             offs = v.ir.Add(offs, v.ir.Imm64(ebytes * elements));
         }
+    } else if (selem == 2 || selem == 4) {
+        // The structures are transferred with quadword accesses and the elements are
+        // (de)interleaved in registers instead of being transferred one at a time.
+        const size_t chunks = selem * datasize / 128;
+        std::array<IR::U128, 4> data;
+
+        if (memop == MemOp::LOAD) {
+            for (size_t c = 0; c < chunks; c++) {
+                data[c] = v.ir.ReadMemory64x2(v.ir.Add(address, offs), esize);
+                offs = v.ir.Add(offs, v.ir.Imm64(16));
+            }
+
+            std::array<IR::U128, 4> result;
+            if (selem == 2) {
+                const IR::U128 upper = chunks == 2 ? data[1] : data[0];
+                result[0] = v.ir.VectorDeinterleaveEven(esize, data[0], upper);
+                result[1] = v.ir.VectorDeinterleaveOdd(esize, data[0], upper);
+            } else {
+                const IR::U128 even_lo = v.ir.VectorDeinterleaveEven(esize, data[0], data[1]);
+                const IR::U128 odd_lo = v.ir.VectorDeinterleaveOdd(esize, data[0], data[1]);
+                const IR::U128 even_hi = chunks == 4 ? v.ir.VectorDeinterleaveEven(esize, data[2], data[3]) : even_lo;
+                const IR::U128 odd_hi = chunks == 4 ? v.ir.VectorDeinterleaveOdd(esize, data[2], data[3]) : odd_lo;
+                result[0] = v.ir.VectorDeinterleaveEven(esize, even_lo, even_hi);
+                result[1] = v.ir.VectorDeinterleaveEven(esize, odd_lo, odd_hi);
+                result[2] = v.ir.VectorDeinterleaveOdd(esize, even_lo, even_hi);
+                result[3] = v.ir.VectorDeinterleaveOdd(esize, odd_lo, odd_hi);
+            }
+
+            for (size_t s = 0; s < selem; s++) {
+                v.V(datasize, vec_reg(s), result[s]);
+            }
+        } else {
+            if (selem == 2) {
+                const IR::U128 t0 = v.V(datasize, vec_reg(0));
+                const IR::U128 t1 = v.V(datasize, vec_reg(1));
+                data[0] = v.ir.VectorInterleaveLower(esize, t0, t1);
+                if (chunks == 2) {
+                    data[1] = v.ir.VectorInterleaveUpper(esize, t0, t1);
+                }
+            } else {
+                const IR::U128 t0 = v.V(datasize, vec_reg(0));
+                const IR::U128 t1 = v.V(datasize, vec_reg(1));
+                const IR::U128 t2 = v.V(datasize, vec_reg(2));
+                const IR::U128 t3 = v.V(datasize, vec_reg(3));
+                const IR::U128 lo02 = v.ir.VectorInterleaveLower(esize, t0, t2);
+                const IR::U128 lo13 = v.ir.VectorInterleaveLower(esize, t1, t3);
+                data[0] = v.ir.VectorInterleaveLower(esize, lo02, lo13);
+                data[1] = v.ir.VectorInterleaveUpper(esize, lo02, lo13);
+                if (chunks == 4) {
+                    const IR::U128 hi02 = v.ir.VectorInterleaveUpper(esize, t0, t2);
+                    const IR::U128 hi13 = v.ir.VectorInterleaveUpper(esize, t1, t3);
+                    data[2] = v.ir.VectorInterleaveLower(esize, hi02, hi13);
+                    data[3] = v.ir.VectorInterleaveUpper(esize, hi02, hi13);
+                }
+            }
+
+            for (size_t c = 0; c < chunks; c++) {
+                v.ir.WriteMemory64x2(v.ir.Add(address, offs), data[c], esize);
+                offs = v.ir.Add(offs, v.ir.Imm64(16));
+            }
+        }
     } else {
         for (size_t e = 0; e < elements; e++) {
             for (size_t s = 0; s < selem; s++) {
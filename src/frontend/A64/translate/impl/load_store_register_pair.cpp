@@ -27,7 +27,6 @@ bool TranslatorVisitor::STP_LDP_gen(Imm<2> opc, bool not_postindex, bool wback,
         return UnpredictableInstruction();
 
     IR::U64 address;
-    const size_t dbytes = datasize / 8;
 
     if (Rn == Reg::SP)
         // TODO: Check SP Alignment
@@ -42,13 +41,24 @@ bool TranslatorVisitor::STP_LDP_gen(Imm<2> opc, bool not_postindex, bool wback,
     case MemOp::STORE: {
         IR::U32U64 data1 = X(datasize, Rt);
         IR::U32U64 data2 = X(datasize, Rt2);
-        Mem(address, dbytes, AccType::NORMAL, data1);
-        Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::NORMAL, data2);
+        if (datasize == 32) {
+            ir.WriteMemory32x2(address, ir.Pack2x32To1x64(data1, data2));
+        } else {
+            ir.WriteMemory64Pair(address, data1, data2);
+        }
         break;
     }
     case MemOp::LOAD: {
-        IR::U32U64 data1 = Mem(address, dbytes, AccType::NORMAL);
-        IR::U32U64 data2 = Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::NORMAL);
+        IR::U32U64 data1, data2;
+        if (datasize == 32) {
+            const IR::U64 data = ir.ReadMemory32x2(address);
+            data1 = ir.LeastSignificantWord(data);
+            data2 = ir.MostSignificantWord(data).result;
+        } else {
+            const auto data = ir.ReadMemory64Pair(address);
+            data1 = data.first;
+            data2 = data.second;
+        }
         if (signed_) {
             X(64, Rt, SignExtend(data1, 64));
             X(64, Rt2, SignExtend(data2, 64));
@@ -104,20 +114,39 @@ bool TranslatorVisitor::STP_LDP_fpsimd(Imm<2> opc, bool not_postindex, bool wbac
     case MemOp::STORE: {
         IR::UAnyU128 data1 = V(datasize, Vt);
         IR::UAnyU128 data2 = V(datasize, Vt2);
-        if (datasize != 128) {
-            data1 = ir.VectorGetElement(datasize, data1, 0);
-            data2 = ir.VectorGetElement(datasize, data2, 0);
+        switch (datasize) {
+        case 32:
+            ir.WriteMemory32x2(address, ir.Pack2x32To1x64(ir.VectorGetElement(32, data1, 0), ir.VectorGetElement(32, data2, 0)));
+            break;
+        case 64:
+            ir.WriteMemory64x2(address, ir.VectorInterleaveLower(64, data1, data2), 64);
+            break;
+        default:
+            Mem(address, dbytes, AccType::VEC, data1);
+            Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::VEC, data2);
+            break;
         }
-        Mem(address, dbytes, AccType::VEC, data1);
-        Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::VEC, data2);
         break;
     }
     case MemOp::LOAD: {
-        IR::UAnyU128 data1 = Mem(address, dbytes, AccType::VEC);
-        IR::UAnyU128 data2 = Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::VEC);
-        if (datasize != 128) {
-            data1 = ir.ZeroExtendToQuad(data1);
-            data2 = ir.ZeroExtendToQuad(data2);
+        IR::UAnyU128 data1, data2;
+        switch (datasize) {
+        case 32: {
+            const IR::U64 data = ir.ReadMemory32x2(address);
+            data1 = ir.ZeroExtendToQuad(ir.LeastSignificantWord(data));
+            data2 = ir.ZeroExtendToQuad(ir.MostSignificantWord(data).result);
+            break;
+        }
+        case 64: {
+            const IR::U128 data = ir.ReadMemory64x2(address, 64);
+            data1 = data;
+            data2 = ir.VectorInterleaveUpper(64, data, data);
+            break;
+        }
+        default:
+            data1 = Mem(address, dbytes, AccType::VEC);
+            data2 = Mem(ir.Add(address, ir.Imm64(dbytes)), dbytes, AccType::VEC);
+            break;
         }
         V(datasize, Vt, data1);
         V(datasize, Vt2, data2);
@@ -111,18 +111,36 @@ IR::U128 SHA256hash(IREmitter& ir, IR::U128 x, IR::U128 y, IR::U128 w, SHA256Has
 } // Anonymous namespace
 
 bool TranslatorVisitor::SHA1C(Vec Vm, Vec Vn, Vec Vd) {
+    if (options.emit_sha_ir_instructions) {
+        const IR::U32 y = ir.VectorGetElement(32, ir.GetQ(Vn), 0);
+        ir.SetQ(Vd, ir.SHA1HashUpdateChoose(ir.GetQ(Vd), y, ir.GetQ(Vm)));
+        return true;
+    }
+
     const IR::U128 result = SHA1HashUpdate(ir, Vm, Vn, Vd, SHAchoose);
     ir.SetQ(Vd, result);
     return true;
 }
 
 bool TranslatorVisitor::SHA1M(Vec Vm, Vec Vn, Vec Vd) {
+    if (options.emit_sha_ir_instructions) {
+        const IR::U32 y = ir.VectorGetElement(32, ir.GetQ(Vn), 0);
+        ir.SetQ(Vd, ir.SHA1HashUpdateMajority(ir.GetQ(Vd), y, ir.GetQ(Vm)));
+        return true;
+    }
+
     const IR::U128 result = SHA1HashUpdate(ir, Vm, Vn, Vd, SHAmajority);
     ir.SetQ(Vd, result);
     return true;
 }
 
 bool TranslatorVisitor::SHA1P(Vec Vm, Vec Vn, Vec Vd) {
+    if (options.emit_sha_ir_instructions) {
+        const IR::U32 y = ir.VectorGetElement(32, ir.GetQ(Vn), 0);
+        ir.SetQ(Vd, ir.SHA1HashUpdateParity(ir.GetQ(Vd), y, ir.GetQ(Vm)));
+        return true;
+    }
+
     const IR::U128 result = SHA1HashUpdate(ir, Vm, Vn, Vd, SHAparity);
     ir.SetQ(Vd, result);
     return true;
@@ -152,6 +170,11 @@ bool TranslatorVisitor::SHA1SU1(Vec Vn, Vec Vd) {
     const IR::U128 d = ir.GetQ(Vd);
     const IR::U128 n = ir.GetQ(Vn);
 
+    if (options.emit_sha_ir_instructions) {
+        ir.SetQ(Vd, ir.SHA1ScheduleUpdate1(d, n));
+        return true;
+    }
+
     // Shuffle down the whole vector and zero out the top 32 bits
     const IR::U128 shuffled_n = ir.VectorSetElement(32, ir.VectorShuffleWords(n, 0b00111001), 3, ir.Imm32(0));
     const IR::U128 t = ir.VectorEor(d, shuffled_n);
@@ -179,6 +202,11 @@ bool TranslatorVisitor::SHA256SU0(Vec Vn, Vec Vd) {
     const IR::U128 d = ir.GetQ(Vd);
     const IR::U128 n = ir.GetQ(Vn);
 
+    if (options.emit_sha_ir_instructions) {
+        ir.SetQ(Vd, ir.SHA256ScheduleUpdate0(d, n));
+        return true;
+    }
+
     const IR::U128 t = [&] {
         // Shuffle the upper three elements down: [3, 2, 1, 0] -> [0, 3, 2, 1]
         const IR::U128 shuffled = ir.VectorShuffleWords(d, 0b00111001);
@@ -210,6 +238,11 @@ bool TranslatorVisitor::SHA256SU1(Vec Vm, Vec Vn, Vec Vd) {
     const IR::U128 m = ir.GetQ(Vm);
     const IR::U128 n = ir.GetQ(Vn);
 
+    if (options.emit_sha_ir_instructions) {
+        ir.SetQ(Vd, ir.SHA256ScheduleUpdate1(d, n, m));
+        return true;
+    }
+
     const IR::U128 T0 = [&] {
         const IR::U32 low_m = ir.VectorGetElement(32, m, 0);
         const IR::U128 shuffled_n = ir.VectorShuffleWords(n, 0b00111001);
@@ -248,12 +281,22 @@ bool TranslatorVisitor::SHA256SU1(Vec Vm, Vec Vn, Vec Vd) {
 }
 
 bool TranslatorVisitor::SHA256H(Vec Vm, Vec Vn, Vec Vd) {
+    if (options.emit_sha_ir_instructions) {
+        ir.SetQ(Vd, ir.SHA256Hash(ir.GetQ(Vd), ir.GetQ(Vn), ir.GetQ(Vm), true));
+        return true;
+    }
+
     const IR::U128 result = SHA256hash(ir, ir.GetQ(Vd), ir.GetQ(Vn), ir.GetQ(Vm), SHA256HashPart::Part1);
     ir.SetQ(Vd, result);
     return true;
 }
 
 bool TranslatorVisitor::SHA256H2(Vec Vm, Vec Vn, Vec Vd) {
+    if (options.emit_sha_ir_instructions) {
+        ir.SetQ(Vd, ir.SHA256Hash(ir.GetQ(Vn), ir.GetQ(Vd), ir.GetQ(Vm), false));
+        return true;
+    }
+
     const IR::U128 result = SHA256hash(ir, ir.GetQ(Vn), ir.GetQ(Vd), ir.GetQ(Vm), SHA256HashPart::Part2);
     ir.SetQ(Vd, result);
     return true;
@@ -26,6 +26,12 @@ struct TranslationOptions {
     /// If this is false, the ExceptionRaised IR instruction is emitted.
     /// If this is true, we define some behaviour for some instructions.
     bool define_unpredictable_behaviour = false;
+
+    /// This changes what IR we emit when we translate the SHA1 and SHA256 instructions.
+    /// If this is false, they are expanded into generic IR instructions.
+    /// If this is true, the dedicated SHA IR instructions are emitted instead. Only set this
+    /// if the backend is able to emit these natively.
+    bool emit_sha_ir_instructions = false;
 };
 
 /**
@@ -41,6 +41,18 @@ enum class ShiftType {
     ROR,
 };
 
+enum class AtomicOp {
+    ADD,
+    CLR,
+    EOR,
+    SET,
+    SMAX,
+    SMIN,
+    UMAX,
+    UMIN,
+    SWP,
+};
+
 const char* CondToString(Cond cond);
 std::string RegToString(Reg reg);
 std::string VecToString(Vec vec);
@@ -8,6 +8,7 @@
 #include <initializer_list>
 #include <map>
 #include <string>
+#include <unordered_map>
 
 #include <fmt/format.h>
 #include <fmt/ostream.h>
@@ -20,6 +21,35 @@
 
 namespace Dynarmic::IR {
 
+Block::Block(const Block& other)
+    : location(other.location)
+    , end_location(other.end_location)
+    , cond(other.cond)
+    , cond_failed(other.cond_failed)
+    , cond_failed_cycle_count(other.cond_failed_cycle_count)
+    , instruction_alloc_pool(std::make_unique<Common::Pool>(sizeof(Inst), std::max<size_t>(other.size(), 1)))
+    , terminal(other.terminal)
+    , cycle_count(other.cycle_count)
+{
+    // Arguments always refer to earlier instructions, so a single pass suffices.
+    std::unordered_map<const Inst*, Inst*> inst_map;
+    for (const auto& old_inst : other) {
+        Inst* new_inst = new(instruction_alloc_pool->Alloc()) Inst(old_inst.GetOpcode());
+        for (size_t i = 0; i < old_inst.NumArgs(); i++) {
+            const Value arg = old_inst.GetArg(i);
+            if (arg.IsInst()) {
+                const auto iter = inst_map.find(arg.GetInst());
+                ASSERT(iter != inst_map.end());
+                new_inst->SetArg(i, Value{iter->second});
+            } else {
+                new_inst->SetArg(i, arg);
+            }
+        }
+        inst_map.emplace(&old_inst, new_inst);
+        instructions.push_back(new_inst);
+    }
+}
+
 void Block::AppendNewInst(Opcode opcode, std::initializer_list<IR::Value> args) {
     PrependNewInst(end(), opcode, args);
 }
@@ -43,6 +43,13 @@ public:
     explicit Block(const LocationDescriptor& location)
         : location(location), end_location(location) {}
 
+    /// Creates a deep copy of other: every instruction is duplicated into this block's own memory pool,
+    /// which is sized to fit the instructions of other.
+    Block(const Block& other);
+    Block(Block&&) = default;
+    Block& operator=(const Block&) = delete;
+    Block& operator=(Block&&) = default;
+
     bool                   empty()   const { return instructions.empty();   }
     size_type              size()    const { return instructions.size();    }
 
@@ -801,6 +801,34 @@ U128 IREmitter::AESMixColumns(const U128& a) {
     return Inst<U128>(Opcode::AESMixColumns, a);
 }
 
+U128 IREmitter::SHA1HashUpdateChoose(const U128& x, const U32& y, const U128& w) {
+    return Inst<U128>(Opcode::SHA1HashUpdateChoose, x, y, w);
+}
+
+U128 IREmitter::SHA1HashUpdateMajority(const U128& x, const U32& y, const U128& w) {
+    return Inst<U128>(Opcode::SHA1HashUpdateMajority, x, y, w);
+}
+
+U128 IREmitter::SHA1HashUpdateParity(const U128& x, const U32& y, const U128& w) {
+    return Inst<U128>(Opcode::SHA1HashUpdateParity, x, y, w);
+}
+
+U128 IREmitter::SHA1ScheduleUpdate1(const U128& a, const U128& b) {
+    return Inst<U128>(Opcode::SHA1ScheduleUpdate1, a, b);
+}
+
+U128 IREmitter::SHA256Hash(const U128& x, const U128& y, const U128& w, bool part1) {
+    return Inst<U128>(Opcode::SHA256Hash, x, y, w, Imm1(part1));
+}
+
+U128 IREmitter::SHA256ScheduleUpdate0(const U128& a, const U128& b) {
+    return Inst<U128>(Opcode::SHA256ScheduleUpdate0, a, b);
+}
+
+U128 IREmitter::SHA256ScheduleUpdate1(const U128& a, const U128& b, const U128& c) {
+    return Inst<U128>(Opcode::SHA256ScheduleUpdate1, a, b, c);
+}
+
 U8 IREmitter::SM4AccessSubstitutionBox(const U8& a) {
     return Inst<U8>(Opcode::SM4AccessSubstitutionBox, a);
 }
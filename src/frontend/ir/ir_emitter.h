@@ -57,6 +57,11 @@ struct UpperAndLower {
     U128 lower;
 };
 
+struct FirstAndSecond {
+    U64 first;
+    U64 second;
+};
+
 /**
  * Convenience class to construct a basic block of the intermediate representation.
  * `block` is the resulting block.
@@ -204,6 +209,14 @@ public:
     U128 AESInverseMixColumns(const U128& a);
     U128 AESMixColumns(const U128& a);
 
+    U128 SHA1HashUpdateChoose(const U128& x, const U32& y, const U128& w);
+    U128 SHA1HashUpdateMajority(const U128& x, const U32& y, const U128& w);
+    U128 SHA1HashUpdateParity(const U128& x, const U32& y, const U128& w);
+    U128 SHA1ScheduleUpdate1(const U128& a, const U128& b);
+    U128 SHA256Hash(const U128& x, const U128& y, const U128& w, bool part1);
+    U128 SHA256ScheduleUpdate0(const U128& a, const U128& b);
+    U128 SHA256ScheduleUpdate1(const U128& a, const U128& b, const U128& c);
+
     U8 SM4AccessSubstitutionBox(const U8& a);
 
     UAny VectorGetElement(size_t esize, const U128& a, size_t index);
@@ -51,11 +51,24 @@ bool Inst::IsSharedMemoryRead() const {
     case Opcode::A32ReadMemory16:
     case Opcode::A32ReadMemory32:
     case Opcode::A32ReadMemory64:
+    case Opcode::A32ReadMemory32x2:
     case Opcode::A64ReadMemory8:
     case Opcode::A64ReadMemory16:
     case Opcode::A64ReadMemory32:
     case Opcode::A64ReadMemory64:
     case Opcode::A64ReadMemory128:
+    case Opcode::A64ReadMemory32x2:
+    case Opcode::A64ReadMemory64x2:
+    case Opcode::A64ReadMemory64Pair:
+    case Opcode::A64AtomicMemoryOperation8:
+    case Opcode::A64AtomicMemoryOperation16:
+    case Opcode::A64AtomicMemoryOperation32:
+    case Opcode::A64AtomicMemoryOperation64:
+    case Opcode::A64CompareAndSwapMemory8:
+    case Opcode::A64CompareAndSwapMemory16:
+    case Opcode::A64CompareAndSwapMemory32:
+    case Opcode::A64CompareAndSwapMemory64:
+    case Opcode::A64CompareAndSwapMemory128:
         return true;
 
     default:
@@ -69,11 +82,24 @@ bool Inst::IsSharedMemoryWrite() const {
     case Opcode::A32WriteMemory16:
     case Opcode::A32WriteMemory32:
     case Opcode::A32WriteMemory64:
+    case Opcode::A32WriteMemory32x2:
     case Opcode::A64WriteMemory8:
     case Opcode::A64WriteMemory16:
     case Opcode::A64WriteMemory32:
     case Opcode::A64WriteMemory64:
     case Opcode::A64WriteMemory128:
+    case Opcode::A64WriteMemory32x2:
+    case Opcode::A64WriteMemory64x2:
+    case Opcode::A64WriteMemory64Pair:
+    case Opcode::A64AtomicMemoryOperation8:
+    case Opcode::A64AtomicMemoryOperation16:
+    case Opcode::A64AtomicMemoryOperation32:
+    case Opcode::A64AtomicMemoryOperation64:
+    case Opcode::A64CompareAndSwapMemory8:
+    case Opcode::A64CompareAndSwapMemory16:
+    case Opcode::A64CompareAndSwapMemory32:
+    case Opcode::A64CompareAndSwapMemory64:
+    case Opcode::A64CompareAndSwapMemory128:
         return true;
 
     default:
@@ -85,6 +111,20 @@ bool Inst::IsSharedMemoryReadOrWrite() const {
     return IsSharedMemoryRead() || IsSharedMemoryWrite();
 }
 
+bool Inst::IsExclusiveMemoryRead() const {
+    switch (op) {
+    case Opcode::A64ExclusiveReadMemory8:
+    case Opcode::A64ExclusiveReadMemory16:
+    case Opcode::A64ExclusiveReadMemory32:
+    case Opcode::A64ExclusiveReadMemory64:
+    case Opcode::A64ExclusiveReadMemory128:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 bool Inst::IsExclusiveMemoryWrite() const {
     switch (op) {
     case Opcode::A32ExclusiveWriteMemory8:
@@ -104,7 +144,7 @@ bool Inst::IsExclusiveMemoryWrite() const {
 }
 
 bool Inst::IsMemoryRead() const {
-    return IsSharedMemoryRead();
+    return IsSharedMemoryRead() || IsExclusiveMemoryRead();
 }
 
 bool Inst::IsMemoryWrite() const {
@@ -391,12 +431,132 @@ bool Inst::WritesToFPSRCumulativeSaturationBit() const {
     }
 }
 
+bool Inst::ReadsFromAndWritesToMXCSR() const {
+    switch (op) {
+    case Opcode::A32GetFpscr:
+    case Opcode::A32SetFpscr:
+    case Opcode::A64GetFPSR:
+    case Opcode::A64SetFPCR:
+    case Opcode::A64SetFPSR:
+    case Opcode::FPAbs32:
+    case Opcode::FPAbs64:
+    case Opcode::FPAdd32:
+    case Opcode::FPAdd64:
+    case Opcode::FPCompare32:
+    case Opcode::FPCompare64:
+    case Opcode::FPDiv32:
+    case Opcode::FPDiv64:
+    case Opcode::FPMax32:
+    case Opcode::FPMax64:
+    case Opcode::FPMaxNumeric32:
+    case Opcode::FPMaxNumeric64:
+    case Opcode::FPMin32:
+    case Opcode::FPMin64:
+    case Opcode::FPMinNumeric32:
+    case Opcode::FPMinNumeric64:
+    case Opcode::FPMul32:
+    case Opcode::FPMul64:
+    case Opcode::FPMulAdd32:
+    case Opcode::FPMulAdd64:
+    case Opcode::FPMulX32:
+    case Opcode::FPMulX64:
+    case Opcode::FPNeg32:
+    case Opcode::FPNeg64:
+    case Opcode::FPRecipEstimate32:
+    case Opcode::FPRecipEstimate64:
+    case Opcode::FPRecipStepFused32:
+    case Opcode::FPRecipStepFused64:
+    case Opcode::FPRoundInt32:
+    case Opcode::FPRoundInt64:
+    case Opcode::FPRSqrtEstimate32:
+    case Opcode::FPRSqrtEstimate64:
+    case Opcode::FPRSqrtStepFused32:
+    case Opcode::FPRSqrtStepFused64:
+    case Opcode::FPSqrt32:
+    case Opcode::FPSqrt64:
+    case Opcode::FPSub32:
+    case Opcode::FPSub64:
+    case Opcode::FPSingleToDouble:
+    case Opcode::FPDoubleToSingle:
+    case Opcode::FPDoubleToFixedS32:
+    case Opcode::FPDoubleToFixedS64:
+    case Opcode::FPDoubleToFixedU32:
+    case Opcode::FPDoubleToFixedU64:
+    case Opcode::FPSingleToFixedS32:
+    case Opcode::FPSingleToFixedS64:
+    case Opcode::FPSingleToFixedU32:
+    case Opcode::FPSingleToFixedU64:
+    case Opcode::FPFixedU32ToSingle:
+    case Opcode::FPFixedS32ToSingle:
+    case Opcode::FPFixedU32ToDouble:
+    case Opcode::FPFixedU64ToDouble:
+    case Opcode::FPFixedU64ToSingle:
+    case Opcode::FPFixedS32ToDouble:
+    case Opcode::FPFixedS64ToDouble:
+    case Opcode::FPFixedS64ToSingle:
+    case Opcode::FPVectorAbs16:
+    case Opcode::FPVectorAbs32:
+    case Opcode::FPVectorAbs64:
+    case Opcode::FPVectorAdd32:
+    case Opcode::FPVectorAdd64:
+    case Opcode::FPVectorDiv32:
+    case Opcode::FPVectorDiv64:
+    case Opcode::FPVectorEqual32:
+    case Opcode::FPVectorEqual64:
+    case Opcode::FPVectorFromSignedFixed32:
+    case Opcode::FPVectorFromSignedFixed64:
+    case Opcode::FPVectorFromUnsignedFixed32:
+    case Opcode::FPVectorFromUnsignedFixed64:
+    case Opcode::FPVectorGreater32:
+    case Opcode::FPVectorGreater64:
+    case Opcode::FPVectorGreaterEqual32:
+    case Opcode::FPVectorGreaterEqual64:
+    case Opcode::FPVectorMax32:
+    case Opcode::FPVectorMax64:
+    case Opcode::FPVectorMin32:
+    case Opcode::FPVectorMin64:
+    case Opcode::FPVectorMul32:
+    case Opcode::FPVectorMul64:
+    case Opcode::FPVectorMulAdd32:
+    case Opcode::FPVectorMulAdd64:
+    case Opcode::FPVectorNeg16:
+    case Opcode::FPVectorNeg32:
+    case Opcode::FPVectorNeg64:
+    case Opcode::FPVectorPairedAdd32:
+    case Opcode::FPVectorPairedAdd64:
+    case Opcode::FPVectorPairedAddLower32:
+    case Opcode::FPVectorPairedAddLower64:
+    case Opcode::FPVectorRecipEstimate32:
+    case Opcode::FPVectorRecipEstimate64:
+    case Opcode::FPVectorRecipStepFused32:
+    case Opcode::FPVectorRecipStepFused64:
+    case Opcode::FPVectorRoundInt32:
+    case Opcode::FPVectorRoundInt64:
+    case Opcode::FPVectorRSqrtEstimate32:
+    case Opcode::FPVectorRSqrtEstimate64:
+    case Opcode::FPVectorRSqrtStepFused32:
+    case Opcode::FPVectorRSqrtStepFused64:
+    case Opcode::FPVectorSub32:
+    case Opcode::FPVectorSub64:
+    case Opcode::FPVectorToSignedFixed32:
+    case Opcode::FPVectorToSignedFixed64:
+    case Opcode::FPVectorToUnsignedFixed32:
+    case Opcode::FPVectorToUnsignedFixed64:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
 bool Inst::CausesCPUException() const {
     return op == Opcode::Breakpoint         ||
            op == Opcode::A32CallSupervisor  ||
            op == Opcode::A32ExceptionRaised ||
            op == Opcode::A64CallSupervisor  ||
-           op == Opcode::A64ExceptionRaised;
+           op == Opcode::A64ExceptionRaised ||
+           op == Opcode::A64WaitForEvent    ||
+           op == Opcode::A64SendEvent;
 }
 
 bool Inst::AltersExclusiveState() const {
@@ -404,6 +564,7 @@ bool Inst::AltersExclusiveState() const {
            op == Opcode::A32SetExclusive   ||
            op == Opcode::A64ClearExclusive ||
            op == Opcode::A64SetExclusive   ||
+           IsExclusiveMemoryRead()         ||
            IsExclusiveMemoryWrite();
 }
 
@@ -427,6 +588,7 @@ bool Inst::MayHaveSideEffects() const {
     return op == Opcode::PushRSB                              ||
            op == Opcode::A64SetCheckBit                       ||
            op == Opcode::A64DataCacheOperationRaised          ||
+           op == Opcode::A64SendEventLocal                    ||
            op == Opcode::A64DataSynchronizationBarrier        ||
            op == Opcode::A64DataMemoryBarrier                 ||
            op == Opcode::A64InstructionSynchronizationBarrier ||
@@ -449,6 +611,7 @@ bool Inst::IsAPseudoOperation() const {
     case Opcode::GetNZCVFromOp:
     case Opcode::GetUpperFromOp:
     case Opcode::GetLowerFromOp:
+    case Opcode::GetSecondFromOp:
         return true;
 
     default:
@@ -482,7 +645,7 @@ bool Inst::AreAllArgsImmediates() const {
 }
 
 bool Inst::HasAssociatedPseudoOperation() const {
-    return carry_inst || overflow_inst || ge_inst || nzcv_inst || upper_inst || lower_inst;
+    return carry_inst || overflow_inst || ge_inst || nzcv_inst || upper_inst || lower_inst || second_inst;
 }
 
 Inst* Inst::GetAssociatedPseudoOperation(Opcode opcode) {
@@ -506,6 +669,9 @@ Inst* Inst::GetAssociatedPseudoOperation(Opcode opcode) {
     case Opcode::GetLowerFromOp:
         ASSERT(!lower_inst || lower_inst->GetOpcode() == Opcode::GetLowerFromOp);
         return lower_inst;
+    case Opcode::GetSecondFromOp:
+        ASSERT(!second_inst || second_inst->GetOpcode() == Opcode::GetSecondFromOp);
+        return second_inst;
     default:
         break;
     }
@@ -600,6 +766,10 @@ void Inst::Use(const Value& value) {
         ASSERT_MSG(!value.GetInst()->lower_inst, "Only one of each type of pseudo-op allowed");
         value.GetInst()->lower_inst = this;
         break;
+    case Opcode::GetSecondFromOp:
+        ASSERT_MSG(!value.GetInst()->second_inst, "Only one of each type of pseudo-op allowed");
+        value.GetInst()->second_inst = this;
+        break;
     default:
         break;
     }
@@ -633,6 +803,10 @@ void Inst::UndoUse(const Value& value) {
         ASSERT(value.GetInst()->lower_inst->GetOpcode() == Opcode::GetLowerFromOp);
         value.GetInst()->lower_inst = nullptr;
         break;
+    case Opcode::GetSecondFromOp:
+        ASSERT(value.GetInst()->second_inst->GetOpcode() == Opcode::GetSecondFromOp);
+        value.GetInst()->second_inst = nullptr;
+        break;
     default:
         break;
     }
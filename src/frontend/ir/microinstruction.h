@@ -42,6 +42,8 @@ public:
     bool IsSharedMemoryWrite() const;
     /// Determines whether or not this instruction performs a shared memory read or write.
     bool IsSharedMemoryReadOrWrite() const;
+    /// Determines whether or not this instruction performs an atomic memory read.
+    bool IsExclusiveMemoryRead() const;
     /// Determines whether or not this instruction performs an atomic memory write.
     bool IsExclusiveMemoryWrite() const;
 
@@ -87,6 +89,10 @@ public:
     /// Determines whether or not this instruction writes to the FPSR cumulative saturation bit.
     bool WritesToFPSRCumulativeSaturationBit() const;
 
+    /// Determines whether or not this instruction both reads from and writes to the host MXCSR,
+    /// and so must run with the guest's floating-point environment loaded into it.
+    bool ReadsFromAndWritesToMXCSR() const;
+
     /// Determines whether or not this instruction alters memory-exclusivity.
     bool AltersExclusiveState() const;
 
@@ -146,6 +152,7 @@ private:
         Inst* carry_inst = nullptr;
         Inst* ge_inst;
         Inst* upper_inst;
+        Inst* second_inst;
     };
     Inst* overflow_inst = nullptr;
     union {
@@ -67,6 +67,10 @@ bool Value::IsImmediate() const {
     return true;
 }
 
+bool Value::IsInst() const {
+    return type == Type::Opaque;
+}
+
 bool Value::IsEmpty() const {
     return type == Type::Void;
 }
@@ -51,6 +51,8 @@ public:
 
     bool IsEmpty() const;
     bool IsImmediate() const;
+    /// Determines whether or not this value refers to a microinstruction, without looking through Identity.
+    bool IsInst() const;
     Type GetType() const;
 
     Inst* GetInst() const;
@@ -55,6 +55,18 @@ void A32ConstantMemoryReads(IR::Block& block, A32::UserCallbacks* cb) {
             }
             break;
         }
+        case IR::Opcode::A32ReadMemory32x2: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            u32 vaddr = inst.GetArg(0).GetU32();
+            if (cb->IsReadOnlyMemory(vaddr) && cb->IsReadOnlyMemory(vaddr + 4)) {
+                u64 lo = cb->MemoryRead32(vaddr);
+                u64 hi = cb->MemoryRead32(vaddr + 4);
+                inst.ReplaceUsesWith(IR::Value{lo | (hi << 32)});
+            }
+            break;
+        }
         case IR::Opcode::A32ReadMemory64: {
             if (!inst.AreAllArgsImmediates())
                 break;
@@ -15,11 +15,7 @@
 
 namespace Dynarmic::Optimization {
 
-void A64CallbackConfigPass(IR::Block& block, const A64::UserConfig& conf) {
-    if (conf.hook_data_cache_operations) {
-        return;
-    }
-
+static void ReplaceDataCacheOperations(IR::Block& block, const A64::UserConfig& conf) {
     for (auto& inst : block) {
         if (inst.GetOpcode() != IR::Opcode::A64DataCacheOperationRaised) {
             continue;
@@ -56,4 +52,41 @@ void A64CallbackConfigPass(IR::Block& block, const A64::UserConfig& conf) {
     }
 }
 
+static void InlineEventOperations(IR::Block& block) {
+    for (auto& inst : block) {
+        if (inst.GetOpcode() != IR::Opcode::A64ExceptionRaised) {
+            continue;
+        }
+
+        const u64 pc = inst.GetArg(0).GetU64();
+        A64::IREmitter ir{block};
+        ir.SetInsertionPoint(&inst);
+
+        switch (static_cast<A64::Exception>(inst.GetArg(1).GetU64())) {
+        case A64::Exception::WaitForEvent:
+            ir.WaitForEvent(pc);
+            break;
+        case A64::Exception::SendEvent:
+            ir.SendEvent(pc);
+            break;
+        case A64::Exception::SendEventLocal:
+            ir.SendEventLocal();
+            break;
+        default:
+            continue;
+        }
+        inst.Invalidate();
+    }
+}
+
+void A64CallbackConfigPass(IR::Block& block, const A64::UserConfig& conf) {
+    if (!conf.hook_data_cache_operations) {
+        ReplaceDataCacheOperations(block, conf);
+    }
+
+    if (conf.inline_event_handling && conf.global_monitor) {
+        InlineEventOperations(block);
+    }
+}
+
 } // namespace Dynarmic::Optimization
@@ -0,0 +1,167 @@
+/* This file is part of the dynarmic project.
+ * Copyright (c) 2018 MerryMage
+ * This software may be used and distributed according to the terms of the GNU
+ * General Public License version 2 or any later version.
+ */
+
+#include <array>
+
+#include <boost/variant/get.hpp>
+
+#include <dynarmic/A64/config.h>
+
+#include "frontend/A64/location_descriptor.h"
+#include "frontend/ir/basic_block.h"
+#include "frontend/ir/ir_emitter.h"
+#include "frontend/ir/opcodes.h"
+#include "ir_opt/passes.h"
+
+namespace Dynarmic::Optimization {
+
+void A64ConstantMemoryReads(IR::Block& block, A64::UserCallbacks* cb) {
+    const auto is_read_only = [cb](u64 vaddr, size_t bytesize) {
+        return cb->IsReadOnlyMemory(vaddr) && cb->IsReadOnlyMemory(vaddr + bytesize - 1);
+    };
+
+    IR::IREmitter ir{block};
+    IR::Inst* last_set_pc = nullptr;
+
+    for (auto& inst : block) {
+        switch (inst.GetOpcode()) {
+        case IR::Opcode::A64SetPC: {
+            last_set_pc = &inst;
+            break;
+        }
+        case IR::Opcode::A64ReadMemory8: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 1)) {
+                const u8 value_from_memory = cb->MemoryRead8(vaddr);
+                inst.ReplaceUsesWith(IR::Value{value_from_memory});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory16: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 2)) {
+                const u16 value_from_memory = cb->MemoryRead16(vaddr);
+                inst.ReplaceUsesWith(IR::Value{value_from_memory});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory32: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 4)) {
+                const u32 value_from_memory = cb->MemoryRead32(vaddr);
+                inst.ReplaceUsesWith(IR::Value{value_from_memory});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory64: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 8)) {
+                const u64 value_from_memory = cb->MemoryRead64(vaddr);
+                inst.ReplaceUsesWith(IR::Value{value_from_memory});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory32x2: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 8)) {
+                const u64 lo = cb->MemoryRead32(vaddr);
+                const u64 hi = cb->MemoryRead32(vaddr + 4);
+                inst.ReplaceUsesWith(IR::Value{lo | (hi << 32)});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory64Pair: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 16)) {
+                // The pseudo-operation refers to inst, so it has to be replaced first.
+                if (IR::Inst* second = inst.GetAssociatedPseudoOperation(IR::Opcode::GetSecondFromOp)) {
+                    second->ReplaceUsesWith(IR::Value{cb->MemoryRead64(vaddr + 8)});
+                }
+                inst.ReplaceUsesWith(IR::Value{cb->MemoryRead64(vaddr)});
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory128: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            // There are no 128-bit immediates, so the value is constructed from two 64-bit halves.
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            if (is_read_only(vaddr, 16)) {
+                const u64 lo = cb->MemoryRead64(vaddr);
+                const u64 hi = cb->MemoryRead64(vaddr + 8);
+                ir.SetInsertionPoint(&inst);
+                inst.ReplaceUsesWith(ir.Pack2x64To1x128(ir.Imm64(lo), ir.Imm64(hi)));
+            }
+            break;
+        }
+        case IR::Opcode::A64ReadMemory64x2: {
+            if (!inst.AreAllArgsImmediates())
+                break;
+
+            // Memory is read with accesses of the element size, as the emitted code would.
+            const u64 vaddr = inst.GetArg(0).GetU64();
+            const size_t esize = inst.GetArg(1).GetU8();
+            if (is_read_only(vaddr, 16)) {
+                std::array<u64, 2> halves{};
+                for (size_t i = 0; i < 16; i += esize / 8) {
+                    u64 element;
+                    switch (esize) {
+                    case 8:
+                        element = cb->MemoryRead8(vaddr + i);
+                        break;
+                    case 16:
+                        element = cb->MemoryRead16(vaddr + i);
+                        break;
+                    case 32:
+                        element = cb->MemoryRead32(vaddr + i);
+                        break;
+                    default:
+                        element = cb->MemoryRead64(vaddr + i);
+                        break;
+                    }
+                    halves[i / 8] |= element << (i % 8 * 8);
+                }
+                ir.SetInsertionPoint(&inst);
+                inst.ReplaceUsesWith(ir.Pack2x64To1x128(ir.Imm64(halves[0]), ir.Imm64(halves[1])));
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // An indirect branch to a target loaded from read-only memory can be linked directly.
+    if (!last_set_pc || !last_set_pc->GetArg(0).IsImmediate())
+        return;
+    const IR::Terminal terminal = block.GetTerminal();
+    if (!boost::get<IR::Term::FastDispatchHint>(&terminal))
+        return;
+
+    const u64 target = last_set_pc->GetArg(0).GetU64();
+    block.ReplaceTerminal(IR::Term::LinkBlock{A64::LocationDescriptor{block.Location()}.SetPC(target)});
+}
+
+} // namespace Dynarmic::Optimization
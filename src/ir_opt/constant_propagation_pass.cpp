@@ -23,6 +23,19 @@ void ReplaceUsesWith(IR::Inst& inst, bool is_32_bit, u64 value) {
     }
 }
 
+// Folds ADD operations based on the following:
+//
+// 1. imm_x + imm_y + imm_carry -> result (where the carry and overflow outputs are unused)
+//
+void FoldADD(IR::Inst& inst, bool is_32_bit) {
+    if (!inst.AreAllArgsImmediates() || inst.HasAssociatedPseudoOperation()) {
+        return;
+    }
+
+    const u64 result = inst.GetArg(0).GetImmediateAsU64() + inst.GetArg(1).GetImmediateAsU64() + inst.GetArg(2).GetImmediateAsU64();
+    ReplaceUsesWith(inst, is_32_bit, result);
+}
+
 // Folds AND operations based on the following:
 //
 // 1. imm_x & imm_y -> result
@@ -238,6 +251,10 @@ void ConstantPropagation(IR::Block& block) {
         case IR::Opcode::UnsignedDiv64:
             FoldDivide(inst, opcode == IR::Opcode::UnsignedDiv32, false);
             break;
+        case IR::Opcode::Add32:
+        case IR::Opcode::Add64:
+            FoldADD(inst, opcode == IR::Opcode::Add32);
+            break;
         case IR::Opcode::And32:
         case IR::Opcode::And64:
             FoldAND(inst, opcode == IR::Opcode::And32);
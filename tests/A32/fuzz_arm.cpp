@@ -6,16 +6,20 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <functional>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <vector>
 
 #include <catch.hpp>
 
 #include <dynarmic/A32/a32.h>
+#include <dynarmic/exclusive_monitor.h>
 
 #include "common/bit_util.h"
 #include "common/common_types.h"
@@ -1192,3 +1196,264 @@ TEST_CASE("arm: Test InvalidateCacheRange", "[arm][A32]") {
     REQUIRE(jit.Regs()[15] == 0x0000000c);
     REQUIRE(jit.Cpsr() == 0x000001d0);
 }
+
+TEST_CASE("arm: Constant memory reads", "[arm][A32]") {
+    ArmTestEnv test_env;
+    Dynarmic::A32::Jit jit{GetUserConfig(&test_env)};
+    test_env.code_mem.fill({});
+    test_env.code_mem[0] = 0xe1cf0fd8; // ldrd r0, r1, [pc, #0xf8]
+    test_env.code_mem[1] = 0xe3a02c01; // mov r2, #0x100
+    test_env.code_mem[2] = 0xe8920018; // ldm r2, {r3, r4}
+    test_env.code_mem[3] = 0xeafffffe; // b +#0
+    test_env.code_mem[0x40] = 0x11111111;
+    test_env.code_mem[0x41] = 0x22222222;
+
+    test_env.read_only_memory_start = 0x100;
+    test_env.read_only_memory_end = 0x200;
+
+    const auto run = [&] {
+        jit.Regs() = {};
+        jit.SetCpsr(0x000001d0); // User-mode
+        test_env.ticks_left = 4;
+        jit.Run();
+    };
+
+    run();
+    REQUIRE(jit.Regs()[0] == 0x11111111);
+    REQUIRE(jit.Regs()[1] == 0x22222222);
+    REQUIRE(jit.Regs()[3] == 0x11111111);
+    REQUIRE(jit.Regs()[4] == 0x22222222);
+
+    // Read-only memory promises to never change, so the loaded values have been folded into the block.
+    test_env.code_mem[0x40] = 0x33333333;
+    test_env.code_mem[0x41] = 0x44444444;
+
+    run();
+    REQUIRE(jit.Regs()[0] == 0x11111111);
+    REQUIRE(jit.Regs()[1] == 0x22222222);
+    REQUIRE(jit.Regs()[3] == 0x11111111);
+    REQUIRE(jit.Regs()[4] == 0x22222222);
+}
+
+TEST_CASE("arm: Software TLB", "[arm][A32]") {
+    ArmTestEnv test_env;
+
+    auto page_table = std::make_unique<std::array<u8*, Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES>>();
+    std::array<u32, 1024> page_a;
+    std::array<u32, 1024> page_b;
+    page_a.fill(0xaaaaaaaa);
+    page_b.fill(0xbbbbbbbb);
+    (*page_table)[0x10] = reinterpret_cast<u8*>(page_a.data());
+
+    Dynarmic::A32::UserConfig config = GetUserConfig(&test_env);
+    config.page_table = page_table.get();
+    config.enable_tlb = true;
+    Dynarmic::A32::Jit jit{config};
+
+    test_env.code_mem.fill({});
+    test_env.code_mem[0] = 0xe5910000; // ldr r0, [r1]
+    test_env.code_mem[1] = 0xeafffffe; // b +#0
+
+    // The code page is not in the page table, so instruction fetches still go through the callbacks.
+    const auto run = [&] {
+        jit.Regs() = {};
+        jit.Regs()[1] = 0x10008;
+        jit.SetCpsr(0x000001d0); // User-mode
+        test_env.ticks_left = 2;
+        jit.Run();
+    };
+
+    run();
+    REQUIRE(jit.Regs()[0] == 0xaaaaaaaa);
+
+    (*page_table)[0x10] = reinterpret_cast<u8*>(page_b.data());
+    jit.InvalidateTLB();
+
+    run();
+    REQUIRE(jit.Regs()[0] == 0xbbbbbbbb);
+
+    (*page_table)[0x10] = nullptr;
+    jit.InvalidateTLB();
+
+    run();
+    REQUIRE(jit.Regs()[0] == 0x0b0a0908);
+}
+
+TEST_CASE("arm: Dirty page bitmap", "[arm][A32]") {
+    ArmTestEnv test_env;
+
+    auto page_table = std::make_unique<std::array<u8*, Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES>>();
+    std::array<u32, 1024> page_a{};
+    std::array<u32, 1024> page_b{};
+    std::vector<u64> dirty_page_bitmap(Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES / 64, 0);
+    (*page_table)[0x10] = reinterpret_cast<u8*>(page_a.data());
+    (*page_table)[0x52] = reinterpret_cast<u8*>(page_b.data());
+
+    Dynarmic::A32::UserConfig config = GetUserConfig(&test_env);
+    config.page_table = page_table.get();
+    config.dirty_page_bitmap = dirty_page_bitmap.data();
+    Dynarmic::A32::Jit jit{config};
+
+    test_env.code_mem.fill({});
+    test_env.code_mem[0] = 0xe5810000; // str r0, [r1]
+    test_env.code_mem[1] = 0xe5c20000; // strb r0, [r2]
+    test_env.code_mem[2] = 0xe5830000; // str r0, [r3]
+    test_env.code_mem[3] = 0xeafffffe; // b +#0
+
+    jit.Regs() = {};
+    jit.Regs()[0] = 0x12345678;
+    jit.Regs()[1] = 0x10008;
+    jit.Regs()[2] = 0x52fff;
+    jit.Regs()[3] = 0x20000;
+    jit.SetCpsr(0x000001d0); // User-mode
+
+    test_env.ticks_left = 4;
+    jit.Run();
+
+    // The write to the unmapped page goes through the memory callbacks and is not recorded.
+    REQUIRE(page_a[2] == 0x12345678);
+    REQUIRE(jit.HarvestDirtyPages() == std::vector<u32>{0x10000, 0x52000});
+    REQUIRE(jit.HarvestDirtyPages().empty());
+}
+
+TEST_CASE("arm: Global exclusive monitor", "[arm][A32]") {
+    ArmTestEnv test_env;
+    Dynarmic::ExclusiveMonitor monitor{2};
+
+    auto page_table = std::make_unique<std::array<u8*, Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES>>();
+    std::array<u32, 1024> page{};
+    (*page_table)[0x4] = reinterpret_cast<u8*>(page.data());
+
+    Dynarmic::A32::UserConfig config0 = GetUserConfig(&test_env);
+    config0.processor_id = 0;
+    config0.global_monitor = &monitor;
+
+    SECTION("Callbacks") {
+        page_table = nullptr;
+    }
+    SECTION("Inline exclusive access") {
+        config0.page_table = page_table.get();
+        config0.inline_exclusive_access = true;
+    }
+
+    const auto read_memory = [&](u32 vaddr) {
+        return page_table ? page[(vaddr & 0xFFF) / 4] : test_env.MemoryRead32(vaddr);
+    };
+
+    Dynarmic::A32::Jit jit0{config0};
+
+    Dynarmic::A32::UserConfig config1 = config0;
+    config1.processor_id = 1;
+    Dynarmic::A32::Jit jit1{config1};
+
+    test_env.code_mem.fill({});
+    test_env.code_mem[0] = 0xe1901f9f; // ldrex r1, [r0]
+    test_env.code_mem[1] = 0xeafffffe; // b +#0
+    test_env.code_mem[2] = 0xe1901f9f; // ldrex r1, [r0]
+    test_env.code_mem[3] = 0xe1802f93; // strex r2, r3, [r0]
+    test_env.code_mem[4] = 0xeafffffe; // b +#0
+    test_env.code_mem[5] = 0xe1802f93; // strex r2, r3, [r0]
+    test_env.code_mem[6] = 0xeafffffe; // b +#0
+
+    jit0.Regs() = {};
+    jit0.Regs()[0] = 0x4000;
+    jit0.Regs()[2] = 0xff;
+    jit0.Regs()[3] = 0xaaaaaaaa;
+    jit0.SetCpsr(0x000001d0); // User-mode
+    jit1.Regs() = jit0.Regs();
+    jit1.Regs()[3] = 0xbbbbbbbb;
+    jit1.Regs()[15] = 8;
+    jit1.SetCpsr(0x000001d0); // User-mode
+
+    // Processor 0 takes a reservation.
+    test_env.ticks_left = 2;
+    jit0.Run();
+
+    // Processor 1 takes a reservation on the same address and successfully stores to it.
+    test_env.ticks_left = 3;
+    jit1.Run();
+    REQUIRE(jit1.Regs()[2] == 0);
+    REQUIRE(read_memory(0x4000) == 0xbbbbbbbb);
+
+    // This clears the reservation of processor 0, so its store fails.
+    jit0.Regs()[15] = 20;
+    test_env.ticks_left = 2;
+    jit0.Run();
+    REQUIRE(jit0.Regs()[2] == 1);
+    REQUIRE(read_memory(0x4000) == 0xbbbbbbbb);
+}
+
+TEST_CASE("arm: Inline exclusive access from multiple threads", "[arm][A32]") {
+    Dynarmic::ExclusiveMonitor monitor{2};
+
+    auto page_table = std::make_unique<std::array<u8*, Dynarmic::A32::UserConfig::NUM_PAGE_TABLE_ENTRIES>>();
+    std::array<u32, 1024> page{};
+    (*page_table)[0x4] = reinterpret_cast<u8*>(page.data());
+
+    std::array<ArmTestEnv, 2> test_envs;
+    std::vector<std::unique_ptr<Dynarmic::A32::Jit>> jits;
+    for (size_t i = 0; i < test_envs.size(); i++) {
+        Dynarmic::A32::UserConfig config = GetUserConfig(&test_envs[i]);
+        config.processor_id = i;
+        config.global_monitor = &monitor;
+        config.page_table = page_table.get();
+        config.inline_exclusive_access = true;
+        jits.emplace_back(std::make_unique<Dynarmic::A32::Jit>(config));
+
+        test_envs[i].code_mem.fill({});
+        test_envs[i].code_mem[0] = 0xe1901f9f; // ldrex r1, [r0]
+        test_envs[i].code_mem[1] = 0xe2811001; // add r1, r1, #1
+        test_envs[i].code_mem[2] = 0xe1802f91; // strex r2, r1, [r0]
+        test_envs[i].code_mem[3] = 0xe3520000; // cmp r2, #0
+        test_envs[i].code_mem[4] = 0x02844001; // addeq r4, r4, #1
+        test_envs[i].code_mem[5] = 0xeafffff9; // b -#20 (loop)
+        test_envs[i].ticks_left = 6'000'000;
+
+        jits[i]->Regs() = {};
+        jits[i]->Regs()[0] = 0x4000;
+        jits[i]->SetCpsr(0x000001d0); // User-mode
+    }
+
+    std::thread other{[&]{ jits[1]->Run(); }};
+    jits[0]->Run();
+    other.join();
+
+    // No increment is lost, so the value counts the successful stores of both processors.
+    REQUIRE(jits[0]->Regs()[4] != 0);
+    REQUIRE(jits[1]->Regs()[4] != 0);
+    REQUIRE(page[0] == jits[0]->Regs()[4] + jits[1]->Regs()[4]);
+}
+
+TEST_CASE("arm: HaltExecution from another thread", "[arm][A32]") {
+    ArmTestEnv test_env;
+    Dynarmic::A32::Jit jit{GetUserConfig(&test_env)};
+    test_env.code_mem.fill({});
+
+    SECTION("Linked blocks") {
+        test_env.code_mem[0] = 0xe2800001; // add r0, r0, #1
+        test_env.code_mem[1] = 0xeafffffd; // b -#12 (loop)
+    }
+    SECTION("Return stack buffer") {
+        test_env.code_mem[0] = 0xe2800001; // add r0, r0, #1
+        test_env.code_mem[1] = 0xeb000000; // bl +#0
+        test_env.code_mem[2] = 0xeafffffc; // b -#16 (loop)
+        test_env.code_mem[3] = 0xe12fff1e; // bx lr
+    }
+
+    jit.Regs() = {};
+    jit.SetCpsr(0x000001d0); // User-mode
+
+    constexpr u64 initial_ticks = 1'000'000'000'000'000;
+    test_env.ticks_left = initial_ticks;
+
+    std::thread halter{[&jit]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        jit.HaltExecution();
+    }};
+    jit.Run();
+    halter.join();
+
+    REQUIRE(test_env.ticks_left > 0);
+    REQUIRE(test_env.ticks_left < initial_ticks);
+    REQUIRE(jit.Regs()[0] != 0);
+}
@@ -25,6 +25,8 @@ public:
 
     u64 ticks_left = 0;
     bool code_mem_modified_by_guest = false;
+    u32 read_only_memory_start = 0;
+    u32 read_only_memory_end = 0;
     std::array<InstructionType, 2048> code_mem{};
     std::map<u32, u8> modified_memory;
     std::vector<std::string> interrupts;
@@ -77,6 +79,10 @@ public:
         MemoryWrite32(vaddr + 4, static_cast<u32>(value >> 32));
     }
 
+    bool IsReadOnlyMemory(u32 vaddr) override {
+        return vaddr >= read_only_memory_start && vaddr < read_only_memory_end;
+    }
+
     void InterpreterFallback(u32 pc, size_t num_instructions) override { ASSERT_MSG(false, "InterpreterFallback({:08x}, {})", pc, num_instructions); }
 
     void CallSVC(std::uint32_t swi) override { ASSERT_MSG(false, "CallSVC({})", swi); }
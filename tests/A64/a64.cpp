@@ -4,11 +4,35 @@
  * General Public License version 2 or any later version.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <map>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <xmmintrin.h>
+
 #include <catch.hpp>
+#include <fmt/format.h>
 
 #include <dynarmic/A64/exclusive_monitor.h>
+#include <dynarmic/A64/multicore_scheduler.h>
+#include <dynarmic/A64/translation_cache.h>
 
+#include "common/fp/fpcr.h"
 #include "common/fp/fpsr.h"
+#include "common/fp/info.h"
+#include "common/fp/op.h"
+#include "common/fp/rounding_mode.h"
+#include "common/scope_exit.h"
+#include "rand_int.h"
 #include "testenv.h"
 
 namespace FP = Dynarmic::FP;
@@ -317,6 +341,60 @@ TEST_CASE("A64: 128-bit exclusive read/write", "[a64]") {
     REQUIRE(env.MemoryRead64(0x1234567812345680) == 0xd0d0cacad0d0caca);
 }
 
+// Each thread increments a shared counter with an exclusive load/store loop, in the same way
+// guest code would. Threads increment either one shared counter or counters in separate granules.
+static void IncrementWithExclusiveMonitor(Dynarmic::A64::ExclusiveMonitor& monitor, size_t thread_count, size_t increments, bool shared) {
+    std::vector<u64> counters(thread_count * 2, 0);
+    std::vector<std::thread> threads;
+    for (size_t processor_id = 0; processor_id < thread_count; processor_id++) {
+        threads.emplace_back([&, processor_id] {
+            const size_t index = shared ? 0 : processor_id * 2;
+            const u64 vaddr = index * sizeof(u64);
+            for (size_t i = 0; i < increments; i++) {
+                bool done = false;
+                while (!done) {
+                    monitor.Mark(processor_id, vaddr, 8);
+                    const u64 value = reinterpret_cast<volatile u64&>(counters[index]);
+                    done = monitor.DoExclusiveOperation(processor_id, vaddr, 8, [&]{
+                        reinterpret_cast<volatile u64&>(counters[index]) = value + 1;
+                    });
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (shared) {
+        REQUIRE(counters[0] == thread_count * increments);
+    } else {
+        for (size_t processor_id = 0; processor_id < thread_count; processor_id++) {
+            REQUIRE(counters[processor_id * 2] == increments);
+        }
+    }
+}
+
+TEST_CASE("A64: ExclusiveMonitor with multiple processors", "[a64]") {
+    Dynarmic::A64::ExclusiveMonitor monitor{4};
+
+    IncrementWithExclusiveMonitor(monitor, 4, 10000, true);
+    IncrementWithExclusiveMonitor(monitor, 4, 10000, false);
+}
+
+TEST_CASE("A64: ExclusiveMonitor contention", "[.benchmark]") {
+    for (size_t thread_count : {1, 2, 4, 8, 16}) {
+        Dynarmic::A64::ExclusiveMonitor monitor{thread_count};
+
+        BENCHMARK(fmt::format("{} threads, shared granule", thread_count)) {
+            IncrementWithExclusiveMonitor(monitor, thread_count, 100000, true);
+        }
+        BENCHMARK(fmt::format("{} threads, separate granules", thread_count)) {
+            IncrementWithExclusiveMonitor(monitor, thread_count, 100000, false);
+        }
+    }
+}
+
 TEST_CASE("A64: CNTPCT_EL0", "[a64]") {
     A64TestEnv env;
     Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
@@ -536,3 +614,2144 @@ TEST_CASE("A64: SQDMULH.4S (saturate)", "[a64]") {
     REQUIRE(jit.GetVector(0) == Vector{0x7ffffffe7fffffff, 0x8000000180000001});
     REQUIRE(FP::FPSR{jit.GetFpsr()}.QC() == true);
 }
+
+TEST_CASE("A64: Software TLB", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page_a(512, 0xaaaaaaaaaaaaaaaa);
+    std::vector<u64> page_b(512, 0xbbbbbbbbbbbbbbbb);
+    page_table[0x10] = page_a.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.enable_tlb = true;
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xf9400020); // LDR X0, [X1]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(1, 0x10008);
+    jit.SetPC(0);
+    env.ticks_left = 2;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0xaaaaaaaaaaaaaaaa);
+
+    page_table[0x10] = page_b.data();
+    jit.InvalidateTLB();
+
+    jit.SetPC(0);
+    env.ticks_left = 2;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0xbbbbbbbbbbbbbbbb);
+
+    page_table[0x10] = nullptr;
+    jit.InvalidateTLB();
+
+    jit.SetPC(0);
+    env.ticks_left = 2;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0x0f0e0d0c0b0a0908);
+}
+
+TEST_CASE("A64: LDP/STP of X registers through the memory callbacks", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0xa9000440); // STP X0, X1, [X2]
+    env.code_mem.emplace_back(0xa9401043); // LDP X3, X4, [X2]
+    env.code_mem.emplace_back(0xa94018e5); // LDP X5, X6, [X7]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(0, 0x0123456789abcdef);
+    jit.SetRegister(1, 0xfedcba9876543210);
+    jit.SetRegister(2, 0x1000);
+    jit.SetRegister(7, 0x2000);
+    jit.SetPC(0);
+
+    env.ticks_left = 4;
+    jit.Run();
+
+    REQUIRE(env.MemoryRead64(0x1000) == 0x0123456789abcdef);
+    REQUIRE(env.MemoryRead64(0x1008) == 0xfedcba9876543210);
+    REQUIRE(jit.GetRegister(3) == 0x0123456789abcdef);
+    REQUIRE(jit.GetRegister(4) == 0xfedcba9876543210);
+    REQUIRE(jit.GetRegister(5) == 0x0706050403020100);
+    REQUIRE(jit.GetRegister(6) == 0x0f0e0d0c0b0a0908);
+}
+
+TEST_CASE("A64: LDP/STP across a page boundary", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page(512, 0xaaaaaaaaaaaaaaaa);
+    page_table[0x10] = page.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0x29402548); // LDP W8, W9, [X10]
+    env.code_mem.emplace_back(0x29400820); // LDP W0, W2, [X1]
+    env.code_mem.emplace_back(0xa94010a3); // LDP X3, X4, [X5]
+    env.code_mem.emplace_back(0x29001c26); // STP W6, W7, [X1]
+    env.code_mem.emplace_back(0xa90031ab); // STP X11, X12, [X13]
+    env.code_mem.emplace_back(0xa9403dae); // LDP X14, X15, [X13]
+    env.code_mem.emplace_back(0xa940fdb0); // LDP X16, XZR, [X13, #8]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(1, 0x10ffc);
+    jit.SetRegister(5, 0x10ff8);
+    jit.SetRegister(6, 0x11223344);
+    jit.SetRegister(7, 0x55667788);
+    jit.SetRegister(10, 0x10000);
+    jit.SetRegister(11, 0x0123456789abcdef);
+    jit.SetRegister(12, 0xfedcba9876543210);
+    jit.SetRegister(13, 0x10010);
+    jit.SetPC(0);
+
+    env.ticks_left = 8;
+    jit.Run();
+
+    // Accesses which cross into the unmapped page fall back to the memory callbacks.
+    REQUIRE(jit.GetRegister(8) == 0xaaaaaaaa);
+    REQUIRE(jit.GetRegister(9) == 0xaaaaaaaa);
+    REQUIRE(jit.GetRegister(0) == 0xfffefdfc);
+    REQUIRE(jit.GetRegister(2) == 0x03020100);
+    REQUIRE(jit.GetRegister(3) == 0xfffefdfcfbfaf9f8);
+    REQUIRE(jit.GetRegister(4) == 0x0706050403020100);
+    REQUIRE(env.MemoryRead32(0x10ffc) == 0x11223344);
+    REQUIRE(env.MemoryRead32(0x11000) == 0x55667788);
+    REQUIRE(page[511] == 0xaaaaaaaaaaaaaaaa);
+
+    // Accesses within a page go directly to the page.
+    REQUIRE(page[2] == 0x0123456789abcdef);
+    REQUIRE(page[3] == 0xfedcba9876543210);
+    REQUIRE(jit.GetRegister(14) == 0x0123456789abcdef);
+    REQUIRE(jit.GetRegister(15) == 0xfedcba9876543210);
+    REQUIRE(jit.GetRegister(16) == 0xfedcba9876543210);
+}
+
+TEST_CASE("A64: LDP/STP across a page boundary under register pressure", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page_a(512, 0xaaaaaaaaaaaaaaaa);
+    std::vector<u64> page_b(512, 0xaaaaaaaaaaaaaaaa);
+    std::vector<u64> page_c(512, 0xaaaaaaaaaaaaaaaa);
+    page_table[0x10] = page_a.data();
+    page_table[0x12] = page_b.data();
+    page_table[0x14] = page_c.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    SECTION("Page table") {}
+    SECTION("TLB") {
+        conf.enable_tlb = true;
+    }
+    Dynarmic::A64::Jit jit{conf};
+
+    // X0 to X23 are kept live across every access, so allocating scratch registers for them spills.
+    const auto increment_live_registers = [&] {
+        for (u32 i = 0; i < 24; i++) {
+            env.code_mem.emplace_back(0x91000400 | (i << 5) | i); // ADD Xi, Xi, #1
+        }
+    };
+
+    increment_live_registers();
+    env.code_mem.emplace_back(0xa940733b); // LDP X27, X28, [X25]
+    env.code_mem.emplace_back(0x29407b5d); // LDP W29, W30, [X26]
+    env.code_mem.emplace_back(0x0c40af20); // LD1 {V0.1D, V1.1D}, [X25]
+    increment_live_registers();
+    env.code_mem.emplace_back(0xa9000720); // STP X0, X1, [X25]
+    env.code_mem.emplace_back(0x29000f42); // STP W2, W3, [X26]
+    env.code_mem.emplace_back(0x0c00af00); // ST1 {V0.1D, V1.1D}, [X24]
+    increment_live_registers();
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    for (u32 i = 0; i < 24; i++) {
+        jit.SetRegister(i, 0x0101010101010101 * i);
+    }
+    jit.SetRegister(24, 0x14ff8);
+    jit.SetRegister(25, 0x10ff8);
+    jit.SetRegister(26, 0x12ffc);
+    jit.SetPC(0);
+
+    env.ticks_left = env.code_mem.size();
+    jit.Run();
+
+    for (u32 i = 0; i < 24; i++) {
+        INFO(i);
+        REQUIRE(jit.GetRegister(i) == 0x0101010101010101 * i + 3);
+    }
+    REQUIRE(jit.GetRegister(24) == 0x14ff8);
+    REQUIRE(jit.GetRegister(25) == 0x10ff8);
+    REQUIRE(jit.GetRegister(26) == 0x12ffc);
+    REQUIRE(jit.GetRegister(27) == 0xfffefdfcfbfaf9f8);
+    REQUIRE(jit.GetRegister(28) == 0x0706050403020100);
+    REQUIRE(jit.GetRegister(29) == 0xfffefdfc);
+    REQUIRE(jit.GetRegister(30) == 0x03020100);
+    REQUIRE(jit.GetVector(0) == Vector{0xfffefdfcfbfaf9f8, 0});
+    REQUIRE(jit.GetVector(1) == Vector{0x0706050403020100, 0});
+    REQUIRE(env.MemoryRead64(0x10ff8) == 0x0000000000000002);
+    REQUIRE(env.MemoryRead64(0x11000) == 0x0101010101010103);
+    REQUIRE(env.MemoryRead32(0x12ffc) == 0x02020204);
+    REQUIRE(env.MemoryRead32(0x13000) == 0x03030305);
+    REQUIRE(env.MemoryRead64(0x14ff8) == 0xfffefdfcfbfaf9f8);
+    REQUIRE(env.MemoryRead64(0x15000) == 0x0706050403020100);
+}
+
+namespace {
+
+// Forwards to A64TestEnv, recording the size of each data access made through the callbacks.
+struct AccessSizeTestEnv final : public Dynarmic::A64::UserCallbacks {
+    A64TestEnv env;
+    std::vector<size_t> read_sizes;
+    std::vector<size_t> write_sizes;
+
+    std::uint32_t MemoryReadCode(u64 vaddr) override { return env.MemoryReadCode(vaddr); }
+
+    std::uint8_t MemoryRead8(u64 vaddr) override { read_sizes.emplace_back(8); return env.MemoryRead8(vaddr); }
+    std::uint16_t MemoryRead16(u64 vaddr) override { read_sizes.emplace_back(16); return env.MemoryRead16(vaddr); }
+    std::uint32_t MemoryRead32(u64 vaddr) override { read_sizes.emplace_back(32); return env.MemoryRead32(vaddr); }
+    std::uint64_t MemoryRead64(u64 vaddr) override { read_sizes.emplace_back(64); return env.MemoryRead64(vaddr); }
+    Vector MemoryRead128(u64 vaddr) override { read_sizes.emplace_back(128); return env.MemoryRead128(vaddr); }
+
+    void MemoryWrite8(u64 vaddr, std::uint8_t value) override { write_sizes.emplace_back(8); env.MemoryWrite8(vaddr, value); }
+    void MemoryWrite16(u64 vaddr, std::uint16_t value) override { write_sizes.emplace_back(16); env.MemoryWrite16(vaddr, value); }
+    void MemoryWrite32(u64 vaddr, std::uint32_t value) override { write_sizes.emplace_back(32); env.MemoryWrite32(vaddr, value); }
+    void MemoryWrite64(u64 vaddr, std::uint64_t value) override { write_sizes.emplace_back(64); env.MemoryWrite64(vaddr, value); }
+    void MemoryWrite128(u64 vaddr, Vector value) override { write_sizes.emplace_back(128); env.MemoryWrite128(vaddr, value); }
+
+    void InterpreterFallback(u64 pc, size_t num_instructions) override { env.InterpreterFallback(pc, num_instructions); }
+    void CallSVC(std::uint32_t swi) override { env.CallSVC(swi); }
+    void ExceptionRaised(u64 pc, Dynarmic::A64::Exception exception) override { env.ExceptionRaised(pc, exception); }
+
+    void AddTicks(std::uint64_t ticks) override { env.AddTicks(ticks); }
+    std::uint64_t GetTicksRemaining() override { return env.GetTicksRemaining(); }
+    std::uint64_t GetCNTPCT() override { return env.GetCNTPCT(); }
+};
+
+} // anonymous namespace
+
+TEST_CASE("A64: LD2/LD4/ST4 (multiple structures)", "[a64]") {
+    AccessSizeTestEnv env;
+    std::vector<void*> page_table(1 << 12, nullptr);
+    Dynarmic::A64::UserConfig conf{&env};
+
+    SECTION("Memory callbacks") {}
+
+    SECTION("Page table miss") {
+        conf.page_table = page_table.data();
+        conf.page_table_address_space_bits = 24;
+    }
+
+    Dynarmic::A64::Jit jit{conf};
+
+    env.env.code_mem.emplace_back(0x4c408400); // LD2 {V0.8H, V1.8H}, [X0]
+    env.env.code_mem.emplace_back(0x0c408002); // LD2 {V2.8B, V3.8B}, [X0]
+    env.env.code_mem.emplace_back(0x4c400824); // LD4 {V4.4S, V5.4S, V6.4S, V7.4S}, [X1]
+    env.env.code_mem.emplace_back(0x4c000844); // ST4 {V4.4S, V5.4S, V6.4S, V7.4S}, [X2]
+    env.env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(0, 0x100);
+    jit.SetRegister(1, 0x200);
+    jit.SetRegister(2, 0x300);
+    jit.SetPC(0);
+
+    env.env.ticks_left = 5;
+    jit.Run();
+
+    REQUIRE(jit.GetVector(0) == Vector{0x0d0c090805040100, 0x1d1c191815141110});
+    REQUIRE(jit.GetVector(1) == Vector{0x0f0e0b0a07060302, 0x1f1e1b1a17161312});
+    REQUIRE(jit.GetVector(2) == Vector{0x0e0c0a0806040200, 0});
+    REQUIRE(jit.GetVector(3) == Vector{0x0f0d0b0907050301, 0});
+    REQUIRE(jit.GetVector(4) == Vector{0x1312111003020100, 0x3332313023222120});
+    REQUIRE(jit.GetVector(5) == Vector{0x1716151407060504, 0x3736353427262524});
+    REQUIRE(jit.GetVector(6) == Vector{0x1b1a19180b0a0908, 0x3b3a39382b2a2928});
+    REQUIRE(jit.GetVector(7) == Vector{0x1f1e1d1c0f0e0d0c, 0x3f3e3d3c2f2e2d2c});
+    for (size_t i = 0; i < 64; i++) {
+        REQUIRE(env.env.modified_memory[0x300 + i] == i);
+    }
+
+    // The callbacks see one access per element, as they would if the elements were transferred individually.
+    std::vector<size_t> expected_read_sizes;
+    expected_read_sizes.insert(expected_read_sizes.end(), 16, 16);
+    expected_read_sizes.insert(expected_read_sizes.end(), 16, 8);
+    expected_read_sizes.insert(expected_read_sizes.end(), 16, 32);
+    REQUIRE(env.read_sizes == expected_read_sizes);
+    REQUIRE(env.write_sizes == std::vector<size_t>(16, 32));
+}
+
+TEST_CASE("A64: Dirty page bitmap", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page_a(512, 0);
+    std::vector<u64> page_b(512, 0);
+    std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+    page_table[0x10] = page_a.data();
+    page_table[0x12] = page_b.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.dirty_page_bitmap = dirty_page_bitmap.data();
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xf9000020); // STR X0, [X1]
+    env.code_mem.emplace_back(0xa9000c82); // STP X2, X3, [X4]
+    env.code_mem.emplace_back(0xb90000c5); // STR W5, [X6]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(1, 0x10008);
+    jit.SetRegister(4, 0x12100);
+    jit.SetRegister(6, 0x20000);
+    jit.SetPC(0);
+
+    env.ticks_left = 4;
+    jit.Run();
+
+    // The write to the unmapped page goes through the memory callbacks and is not recorded.
+    REQUIRE(jit.HarvestDirtyPages() == std::vector<u64>{0x10000, 0x12000});
+    REQUIRE(jit.HarvestDirtyPages().empty());
+}
+
+TEST_CASE("A64: Dirty page bitmap shared between threads", "[a64]") {
+    // Two Jits mark alternate pages, so they concurrently set bits within the same words.
+    std::vector<u64> page(512, 0);
+    std::vector<void*> page_table(1 << 12, page.data());
+    std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+
+    std::array<A64TestEnv, 2> envs;
+    std::vector<std::unique_ptr<Dynarmic::A64::Jit>> jits;
+    for (auto& env : envs) {
+        env.code_mem.emplace_back(0xf9000020); // STR X0, [X1]
+        env.code_mem.emplace_back(0x91400821); // ADD X1, X1, #2, LSL #12
+        env.code_mem.emplace_back(0x17fffffe); // B .-8
+
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.page_table = page_table.data();
+        conf.page_table_address_space_bits = 24;
+        conf.dirty_page_bitmap = dirty_page_bitmap.data();
+        jits.emplace_back(std::make_unique<Dynarmic::A64::Jit>(conf));
+    }
+
+    for (size_t round = 0; round < 64; round++) {
+        std::atomic<size_t> ready{0};
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < 2; i++) {
+            threads.emplace_back([&, i] {
+                ready++;
+                while (ready != 2) {}
+                jits[i]->SetRegister(1, i << 12);
+                jits[i]->SetPC(0);
+                envs[i].ticks_left = 3 * 2048;
+                jits[i]->Run();
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        REQUIRE(jits[0]->HarvestDirtyPages().size() == 1 << 12);
+    }
+}
+
+TEST_CASE("A64: Constant memory reads", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0x58008000); // LDR X0, 0x1000
+    env.code_mem.emplace_back(0x58008021); // LDR X1, 0x1008
+    env.code_mem.emplace_back(0x9c008042); // LDR Q2, 0x1010
+    env.code_mem.emplace_back(0xd61f0020); // BR X1
+    env.code_mem.emplace_back(0x10007f83); // ADR X3, 0x1000
+    env.code_mem.emplace_back(0xa9401865); // LDP X5, X6, [X3]
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.resize(8, 0xd503201f);    // NOP
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    env.read_only_memory_start = 0x1000;
+    env.read_only_memory_end = 0x2000;
+    env.MemoryWrite64(0x1008, 0x20);
+
+    jit.SetPC(0);
+    env.ticks_left = 5;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0x0706050403020100);
+    REQUIRE(jit.GetRegister(1) == 0x20);
+    REQUIRE(jit.GetVector(2) == Vector{0x1716151413121110, 0x1f1e1d1c1b1a1918});
+    REQUIRE(jit.GetPC() == 0x20);
+
+    // Read-only memory promises to never change, so the loaded value has been folded into the block.
+    env.MemoryWrite8(0x1000, 0xff);
+
+    jit.SetPC(0);
+    env.ticks_left = 5;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0x0706050403020100);
+    REQUIRE(jit.GetPC() == 0x20);
+
+    jit.SetPC(0x10);
+    env.ticks_left = 3;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(5) == 0x07060504030201ff);
+    REQUIRE(jit.GetRegister(6) == 0x20);
+
+    env.MemoryWrite8(0x1008, 0xff);
+
+    jit.SetPC(0x10);
+    env.ticks_left = 3;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(6) == 0x20);
+}
+
+TEST_CASE("A64: MMIO handlers", "[a64]") {
+    struct Device {
+        std::vector<std::tuple<u64, u64, size_t>> writes;
+
+        static u64 Read(void* context, u64 vaddr, size_t bytesize) {
+            (void)context;
+            return vaddr + bytesize;
+        }
+        static void Write(void* context, u64 vaddr, u64 value, size_t bytesize) {
+            static_cast<Device*>(context)->writes.emplace_back(vaddr, value, bytesize);
+        }
+    };
+
+    A64TestEnv env;
+    Device device;
+    Dynarmic::A64::MMIOHandler handler{&device, &Device::Read, &Device::Write};
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<Dynarmic::A64::MMIOHandler*> mmio_page_table(1 << 12, nullptr);
+    mmio_page_table[0x20] = &handler;
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.mmio_page_table = mmio_page_table.data();
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xb9400020); // LDR W0, [X1]
+    env.code_mem.emplace_back(0xb9000022); // STR W2, [X1]
+    env.code_mem.emplace_back(0x39000027); // STRB W7, [X1]
+    env.code_mem.emplace_back(0x79000427); // STRH W7, [X1, #2]
+    env.code_mem.emplace_back(0xd2a00043); // MOVZ X3, #2, LSL #16
+    env.code_mem.emplace_back(0xf9400464); // LDR X4, [X3, #8]
+    env.code_mem.emplace_back(0xf9000062); // STR X2, [X3]
+    env.code_mem.emplace_back(0x39000467); // STRB W7, [X3, #1]
+    env.code_mem.emplace_back(0x79000467); // STRH W7, [X3, #2]
+    env.code_mem.emplace_back(0xf94000a6); // LDR X6, [X5]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(1, 0x20010);
+    jit.SetRegister(2, 0xdeadbeef);
+    jit.SetRegister(5, 0x30000);
+    // Narrow stores only pass the low bits of the register to the handler.
+    jit.SetRegister(7, 0x1122334455667788);
+    jit.SetPC(0);
+
+    env.ticks_left = 11;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(0) == 0x20014);
+    REQUIRE(jit.GetRegister(4) == 0x20010);
+    REQUIRE(device.writes == std::vector<std::tuple<u64, u64, size_t>>{
+        {0x20010, 0xdeadbeef, 4},
+        {0x20010, 0x88, 1},
+        {0x20012, 0x7788, 2},
+        {0x20000, 0xdeadbeef, 8},
+        {0x20001, 0x88, 1},
+        {0x20002, 0x7788, 2},
+    });
+
+    // Pages without a handler still go through the memory callbacks.
+    REQUIRE(jit.GetRegister(6) == env.MemoryRead64(0x30000));
+}
+
+TEST_CASE("A64: Inline exclusive access", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::ExclusiveMonitor monitor{1};
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page(512, 0);
+    page_table[0x10] = page.data();
+    page[1] = 0x1111;
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.inline_exclusive_access = true;
+
+    SECTION("Local Monitor Only") {
+        conf.global_monitor = nullptr;
+    }
+    SECTION("Global Monitor") {
+        conf.global_monitor = &monitor;
+    }
+
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xc85f7c01); // LDXR X1, [X0]
+    env.code_mem.emplace_back(0xc8047c02); // STXR W4, X2, [X0]
+    env.code_mem.emplace_back(0xc85f7c05); // LDXR X5, [X0]
+    env.code_mem.emplace_back(0xf9000003); // STR X3, [X0]
+    env.code_mem.emplace_back(0xc8067c02); // STXR W6, X2, [X0]
+    env.code_mem.emplace_back(0xc87f2127); // LDXP X7, X8, [X9]
+    env.code_mem.emplace_back(0xc82a0d22); // STXP W10, X2, X3, [X9]
+    env.code_mem.emplace_back(0xc85f7d6c); // LDXR X12, [X11]
+    env.code_mem.emplace_back(0xc80d7d62); // STXR W13, X2, [X11]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(0, 0x10008);
+    jit.SetRegister(2, 0x2222);
+    jit.SetRegister(3, 0x3333);
+    jit.SetRegister(9, 0x10010);
+    jit.SetRegister(11, 0x20000);
+    jit.SetRegister(4, 0xff);
+    jit.SetRegister(6, 0xff);
+    jit.SetRegister(10, 0xff);
+    jit.SetRegister(13, 0xff);
+    jit.SetPC(0);
+
+    const u64 unmapped_value = env.MemoryRead64(0x20000);
+
+    env.ticks_left = 10;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(1) == 0x1111);
+    REQUIRE(jit.GetRegister(4) == 0);
+    REQUIRE(jit.GetRegister(5) == 0x2222);
+    // Memory no longer holds the value loaded by the exclusive load, so the compare-and-swap fails.
+    REQUIRE(jit.GetRegister(6) == 1);
+    REQUIRE(page[1] == 0x3333);
+    REQUIRE(jit.GetRegister(7) == 0);
+    REQUIRE(jit.GetRegister(8) == 0);
+    REQUIRE(jit.GetRegister(10) == 0);
+    REQUIRE(page[2] == 0x2222);
+    REQUIRE(page[3] == 0x3333);
+    // Accesses which miss the page table go through the memory callbacks.
+    REQUIRE(jit.GetRegister(12) == unmapped_value);
+    REQUIRE(jit.GetRegister(13) == 0);
+    REQUIRE(env.MemoryRead64(0x20000) == 0x2222);
+}
+
+TEST_CASE("A64: Inline exclusive access with pinned registers", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::ExclusiveMonitor monitor{1};
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page(512, 0);
+    std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+    page_table[0x10] = page.data();
+    page[2] = 0x1111;
+    page[3] = 0x4444;
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.inline_exclusive_access = true;
+    conf.enable_tlb = true;
+    conf.dirty_page_bitmap = dirty_page_bitmap.data();
+    conf.pinned_registers = {2, 3, 9, 10};
+
+    SECTION("Local Monitor Only") {
+        conf.global_monitor = nullptr;
+    }
+    SECTION("Global Monitor") {
+        conf.global_monitor = &monitor;
+    }
+
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xc87f2127); // LDXP X7, X8, [X9]
+    env.code_mem.emplace_back(0xc82a0d22); // STXP W10, X2, X3, [X9]
+    env.code_mem.emplace_back(0xc85f7d6c); // LDXR X12, [X11]
+    env.code_mem.emplace_back(0xc80d7d62); // STXR W13, X2, [X11]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(2, 0x2222);
+    jit.SetRegister(3, 0x3333);
+    jit.SetRegister(9, 0x10010);
+    jit.SetRegister(10, 0xff);
+    jit.SetRegister(11, 0x10008);
+    jit.SetRegister(13, 0xff);
+    jit.SetPC(0);
+
+    env.ticks_left = 5;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(7) == 0x1111);
+    REQUIRE(jit.GetRegister(8) == 0x4444);
+    REQUIRE(jit.GetRegister(10) == 0);
+    REQUIRE(page[2] == 0x2222);
+    REQUIRE(page[3] == 0x3333);
+    REQUIRE(jit.GetRegister(12) == 0);
+    REQUIRE(jit.GetRegister(13) == 0);
+    REQUIRE(page[1] == 0x2222);
+    REQUIRE(dirty_page_bitmap[0] == 1ull << 0x10);
+}
+
+TEST_CASE("A64: Failed inline exclusive stores leave pages clean", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page_a(512, 0);
+    std::vector<u64> page_b(512, 0);
+    std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+    page_table[0x10] = page_a.data();
+    page_table[0x11] = page_b.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.inline_exclusive_access = true;
+    conf.dirty_page_bitmap = dirty_page_bitmap.data();
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xc85f7d09); // LDXR X9, [X8]
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.emplace_back(0xc80d7d0e); // STXR W13, X14, [X8]
+    env.code_mem.emplace_back(0xc87f2d8a); // LDXP X10, X11, [X12]
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.emplace_back(0xc82f398e); // STXP W15, X14, X14, [X12]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(8, 0x10008);
+    jit.SetRegister(12, 0x11010);
+    jit.SetRegister(13, 0xff);
+    jit.SetRegister(14, 0x2222);
+    jit.SetRegister(15, 0xff);
+
+    const auto run = [&](u64 pc, size_t ticks) {
+        jit.SetPC(pc);
+        env.ticks_left = ticks;
+        jit.Run();
+    };
+
+    // Memory changes between each exclusive load and store, so the compare-and-swap fails.
+    run(0, 1);
+    page_a[1] = 0x1111;
+    run(8, 2);
+    page_b[2] = 0x1111;
+    run(20, 1);
+
+    REQUIRE(jit.GetRegister(13) == 1);
+    REQUIRE(jit.GetRegister(15) == 1);
+    REQUIRE(page_a[1] == 0x1111);
+    REQUIRE(page_b[2] == 0x1111);
+    REQUIRE(page_b[3] == 0);
+    REQUIRE(jit.HarvestDirtyPages().empty());
+}
+
+TEST_CASE("A64: Inline exclusive store clears global monitor reservations", "[a64]") {
+    Dynarmic::A64::ExclusiveMonitor monitor{2};
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page(512, 0);
+    page_table[0x10] = page.data();
+
+    A64TestEnv inline_env;
+    Dynarmic::A64::UserConfig inline_conf{&inline_env};
+    inline_conf.page_table = page_table.data();
+    inline_conf.page_table_address_space_bits = 24;
+    inline_conf.inline_exclusive_access = true;
+    inline_conf.global_monitor = &monitor;
+    inline_conf.processor_id = 0;
+    Dynarmic::A64::Jit inline_jit{inline_conf};
+
+    A64TestEnv callback_env;
+    Dynarmic::A64::UserConfig callback_conf{&callback_env};
+    callback_conf.global_monitor = &monitor;
+    callback_conf.processor_id = 1;
+    Dynarmic::A64::Jit callback_jit{callback_conf};
+
+    inline_env.code_mem.emplace_back(0xc85f7c01); // LDXR X1, [X0]
+    inline_env.code_mem.emplace_back(0xc8047c02); // STXR W4, X2, [X0]
+    inline_env.code_mem.emplace_back(0x14000000); // B .
+
+    callback_env.code_mem.emplace_back(0xc85f7c01); // LDXR X1, [X0]
+    callback_env.code_mem.emplace_back(0x14000000); // B .
+    callback_env.code_mem.emplace_back(0xc8047c02); // STXR W4, X2, [X0]
+    callback_env.code_mem.emplace_back(0x14000000); // B .
+
+    // The callback processor reserves the granule first.
+    callback_jit.SetRegister(0, 0x10008);
+    callback_jit.SetRegister(2, 0x3333);
+    callback_jit.SetPC(0);
+    callback_env.ticks_left = 1;
+    callback_jit.Run();
+    REQUIRE(callback_jit.GetPC() == 4);
+
+    inline_jit.SetRegister(0, 0x10008);
+    inline_jit.SetRegister(2, 0x2222);
+    inline_jit.SetRegister(4, 0xff);
+    inline_jit.SetPC(0);
+    inline_env.ticks_left = 2;
+    inline_jit.Run();
+    REQUIRE(inline_jit.GetRegister(4) == 0);
+    REQUIRE(page[1] == 0x2222);
+
+    // The inline store took the reservation away from the callback processor.
+    callback_jit.SetRegister(4, 0xff);
+    callback_jit.SetPC(8);
+    callback_env.ticks_left = 1;
+    callback_jit.Run();
+    REQUIRE(callback_jit.GetRegister(4) == 1);
+}
+
+TEST_CASE("A64: LSE atomics", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page(512, 0);
+    page_table[0x10] = page.data();
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table_address_space_bits = 24;
+
+    SECTION("Page table") {
+        conf.page_table = page_table.data();
+    }
+    SECTION("Callbacks") {
+        conf.page_table = nullptr;
+    }
+
+    const auto read_memory = [&](u64 vaddr) {
+        return conf.page_table && (vaddr >> 12) == 0x10 ? page[(vaddr & 0xFFF) / 8] : env.MemoryRead64(vaddr);
+    };
+    const auto write_memory = [&](u64 vaddr, u64 value) {
+        page[(vaddr & 0xFFF) / 8] = value;
+        env.MemoryWrite64(vaddr, value);
+    };
+
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xf8210002); // LDADD X1, X2, [X0]
+    env.code_mem.emplace_back(0xf8a31004); // LDCLRA X3, X4, [X0]
+    env.code_mem.emplace_back(0xf8652006); // LDEORL X5, X6, [X0]
+    env.code_mem.emplace_back(0xf8e73008); // LDSETAL X7, X8, [X0]
+    env.code_mem.emplace_back(0x3829400a); // LDSMAXB W9, W10, [X0]
+    env.code_mem.emplace_back(0x3829500b); // LDSMINB W9, W11, [X0]
+    env.code_mem.emplace_back(0x782c600d); // LDUMAXH W12, W13, [X0]
+    env.code_mem.emplace_back(0xb82e700f); // LDUMIN W14, W15, [X0]
+    env.code_mem.emplace_back(0xf8308011); // SWP X16, X17, [X0]
+    env.code_mem.emplace_back(0xc8b27c13); // CAS X18, X19, [X0]
+    env.code_mem.emplace_back(0xc8f4fc13); // CASAL X20, X19, [X0]
+    env.code_mem.emplace_back(0x48367eb8); // CASP X22, X23, X24, X25, [X21]
+    env.code_mem.emplace_back(0xf821037a); // LDADD X1, X26, [X27]
+    env.code_mem.emplace_back(0xc8bc7fb3); // CAS X28, X19, [X29]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    write_memory(0x10000, 10);
+    write_memory(0x10010, 0);
+    write_memory(0x10018, 0);
+    const u64 unmapped_value = env.MemoryRead64(0x20000);
+    const u64 unmapped_value2 = env.MemoryRead64(0x20008);
+
+    jit.SetRegister(0, 0x10000);
+    jit.SetRegister(1, 5);
+    jit.SetRegister(3, 1);
+    jit.SetRegister(5, 0xff);
+    jit.SetRegister(7, 0x100);
+    jit.SetRegister(9, 0x80);
+    jit.SetRegister(12, 0x8000);
+    jit.SetRegister(14, 0x10);
+    jit.SetRegister(16, 0x1234);
+    jit.SetRegister(18, 0x1234);
+    jit.SetRegister(19, 0x5678);
+    jit.SetRegister(20, 0x1111);
+    jit.SetRegister(21, 0x10010);
+    jit.SetRegister(22, 0);
+    jit.SetRegister(23, 0);
+    jit.SetRegister(24, 0xaa);
+    jit.SetRegister(25, 0xbb);
+    jit.SetRegister(27, 0x20000);
+    jit.SetRegister(28, unmapped_value2);
+    jit.SetRegister(29, 0x20008);
+    jit.SetPC(0);
+
+    env.ticks_left = 15;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(2) == 10);
+    REQUIRE(jit.GetRegister(4) == 15);
+    REQUIRE(jit.GetRegister(6) == 14);
+    REQUIRE(jit.GetRegister(8) == 0xf1);
+    REQUIRE(jit.GetRegister(10) == 0xf1);
+    REQUIRE(jit.GetRegister(11) == 0xf1);
+    REQUIRE(jit.GetRegister(13) == 0x180);
+    REQUIRE(jit.GetRegister(15) == 0x8000);
+    REQUIRE(jit.GetRegister(17) == 0x10);
+    REQUIRE(jit.GetRegister(18) == 0x1234);
+    // The comparison fails, so memory is left unchanged.
+    REQUIRE(jit.GetRegister(20) == 0x5678);
+    REQUIRE(read_memory(0x10000) == 0x5678);
+    REQUIRE(jit.GetRegister(22) == 0);
+    REQUIRE(jit.GetRegister(23) == 0);
+    REQUIRE(read_memory(0x10010) == 0xaa);
+    REQUIRE(read_memory(0x10018) == 0xbb);
+    REQUIRE(jit.GetRegister(26) == unmapped_value);
+    REQUIRE(env.MemoryRead64(0x20000) == unmapped_value + 5);
+    REQUIRE(jit.GetRegister(28) == unmapped_value2);
+    REQUIRE(env.MemoryRead64(0x20008) == 0x5678);
+}
+
+TEST_CASE("A64: Failed compare-and-swap leaves pages clean", "[a64]") {
+    A64TestEnv env;
+
+    std::vector<void*> page_table(1 << 12, nullptr);
+    std::vector<u64> page_a(512, 0);
+    std::vector<u64> page_b(512, 0);
+    std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+    page_table[0x10] = page_a.data();
+    page_table[0x11] = page_b.data();
+    page_a[0] = 5;
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.page_table = page_table.data();
+    conf.page_table_address_space_bits = 24;
+    conf.dirty_page_bitmap = dirty_page_bitmap.data();
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xc8a17c02); // CAS X1, X2, [X0]
+    env.code_mem.emplace_back(0x48247c66); // CASP X4, X5, X6, X7, [X3]
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetRegister(0, 0x10000);
+    jit.SetRegister(1, 7);
+    jit.SetRegister(2, 0x2222);
+    jit.SetRegister(3, 0x11010);
+    jit.SetRegister(4, 1);
+    jit.SetRegister(5, 0);
+    jit.SetRegister(6, 0x3333);
+    jit.SetRegister(7, 0x4444);
+    jit.SetPC(0);
+
+    env.ticks_left = 3;
+    jit.Run();
+
+    REQUIRE(jit.GetRegister(1) == 5);
+    REQUIRE(jit.GetRegister(4) == 0);
+    REQUIRE(jit.GetRegister(5) == 0);
+    REQUIRE(page_a[0] == 5);
+    REQUIRE(page_b[2] == 0);
+    REQUIRE(page_b[3] == 0);
+    REQUIRE(jit.HarvestDirtyPages().empty());
+}
+
+TEST_CASE("A64: HaltExecution from another thread", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0x17ffffff); // B .-4
+
+    jit.SetPC(0);
+
+    constexpr u64 initial_ticks = 1'000'000'000'000'000;
+    env.ticks_left = initial_ticks;
+
+    std::thread halter{[&jit]{
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        jit.HaltExecution();
+    }};
+    jit.Run();
+    halter.join();
+
+    REQUIRE(env.ticks_left > 0);
+    REQUIRE(env.ticks_left < initial_ticks);
+}
+
+TEST_CASE("A64: Values live across host calls", "[a64]") {
+    for (const bool liveness : {false, true}) {
+        A64TestEnv env;
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.enable_liveness_register_allocation = liveness;
+        Dynarmic::A64::Jit jit{conf};
+
+        env.code_mem.emplace_back(0xf9400001); // LDR X1, [X0]
+        env.code_mem.emplace_back(0x91000422); // ADD X2, X1, #1
+        env.code_mem.emplace_back(0x91000823); // ADD X3, X1, #2
+        env.code_mem.emplace_back(0xf9400404); // LDR X4, [X0, #8]
+        env.code_mem.emplace_back(0x8b030045); // ADD X5, X2, X3
+        env.code_mem.emplace_back(0x8b0400a5); // ADD X5, X5, X4
+        env.code_mem.emplace_back(0x14000000); // B .
+
+        env.MemoryWrite64(0x1000, 0x100);
+        env.MemoryWrite64(0x1008, 0x20);
+
+        jit.SetRegister(0, 0x1000);
+        jit.SetPC(0);
+        env.ticks_left = 7;
+        jit.Run();
+
+        INFO("liveness " << liveness);
+        REQUIRE(jit.GetRegister(2) == 0x101);
+        REQUIRE(jit.GetRegister(3) == 0x102);
+        REQUIRE(jit.GetRegister(4) == 0x20);
+        REQUIRE(jit.GetRegister(5) == 0x223);
+    }
+}
+
+TEST_CASE("A64: Cross-block NZCV elimination", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.enable_cross_block_nzcv_elimination = true;
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0xf1000400); // SUBS X0, X0, #1
+    env.code_mem.emplace_back(0x54ffffe1); // B.NE .-4
+    env.code_mem.emplace_back(0xb1000421); // ADDS X1, X1, #1
+    env.code_mem.emplace_back(0x14000001); // B .+4
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    // Translate the block at 8 first, so that the loop above it is translated knowing its successors.
+    jit.SetPC(8);
+    env.ticks_left = 4;
+    jit.Run();
+    REQUIRE(jit.GetRegister(1) == 1);
+
+    // Returning to the dispatcher from the loop must still store NZCV.
+    jit.SetRegister(0, 100);
+    jit.SetPstate(0x40000000);
+    jit.SetPC(0);
+    env.ticks_left = 5;
+    jit.Run();
+    REQUIRE(jit.GetRegister(0) < 100);
+    REQUIRE(jit.GetRegister(0) > 0);
+    REQUIRE(jit.GetPC() == 0);
+    REQUIRE(jit.GetPstate() == 0x20000000);
+
+    jit.SetRegister(0, 3);
+    jit.SetRegister(1, 0xffffffffffffffff);
+    jit.SetPstate(0);
+    jit.SetPC(0);
+    env.ticks_left = 20;
+    jit.Run();
+    REQUIRE(jit.GetRegister(0) == 0);
+    REQUIRE(jit.GetRegister(1) == 0);
+    REQUIRE(jit.GetPstate() == 0x60000000);
+
+    // The successor now reads NZCV, so the loop must be retranslated to store it again.
+    env.code_mem[2] = 0x9a9f17e2; // CSET X2, EQ
+    jit.InvalidateCacheRange(8, 4);
+
+    jit.SetRegister(0, 1);
+    jit.SetRegister(2, 0);
+    jit.SetPstate(0);
+    jit.SetPC(0);
+    env.ticks_left = 10;
+    jit.Run();
+    REQUIRE(jit.GetRegister(0) == 0);
+    REQUIRE(jit.GetRegister(2) == 1);
+    REQUIRE(jit.GetPstate() == 0x60000000);
+}
+
+TEST_CASE("A64: QueueInvalidateCacheRange from another thread", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0x17ffffff); // B .-4
+
+    jit.SetPC(0);
+    env.ticks_left = 10;
+    jit.Run();
+    REQUIRE(jit.GetRegister(0) == 5);
+
+    // Queued while the Jit is idle: performed at the start of the next run.
+    env.code_mem[0] = 0x91000800; // ADD X0, X0, #2
+    std::thread{[&jit]{ jit.QueueInvalidateCacheRange(0, 4); }}.join();
+
+    jit.SetRegister(0, 0);
+    jit.SetPC(0);
+    env.ticks_left = 10;
+    jit.Run();
+    REQUIRE(jit.GetRegister(0) == 10);
+
+    // Queued while the Jit is running: performed without returning from Jit::Run.
+    std::atomic<bool> done{false};
+    std::thread poster{[&jit, &done]{
+        while (!done) {
+            jit.QueueInvalidateCacheRange(0, 4);
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }};
+
+    jit.SetRegister(0, 0);
+    jit.SetPC(0);
+    env.ticks_left = 2'000'000;
+    jit.Run();
+    done = true;
+    poster.join();
+
+    REQUIRE(env.ticks_left == 0);
+    REQUIRE(jit.GetRegister(0) == 2'000'000);
+}
+
+TEST_CASE("A64: Shared TranslationCache", "[a64]") {
+    Dynarmic::A64::TranslationCache translation_cache;
+
+    A64TestEnv env1;
+    Dynarmic::A64::UserConfig conf1{&env1};
+    conf1.processor_id = 0;
+    conf1.translation_cache = &translation_cache;
+    Dynarmic::A64::Jit jit1{conf1};
+
+    A64TestEnv env2;
+    Dynarmic::A64::UserConfig conf2{&env2};
+    conf2.processor_id = 1;
+    conf2.translation_cache = &translation_cache;
+    Dynarmic::A64::Jit jit2{conf2};
+
+    // The guest code differs between the two environments so that we can observe which translation was used.
+    env1.code_mem = {0xd2800540, 0x14000000}; // MOVZ X0, #42; B .
+    env2.code_mem = {0xd2800020, 0x14000000}; // MOVZ X0, #1; B .
+
+    jit1.SetPC(0);
+    env1.ticks_left = 2;
+    jit1.Run();
+    REQUIRE(jit1.GetRegister(0) == 42);
+
+    jit2.SetPC(0);
+    env2.ticks_left = 2;
+    jit2.Run();
+    REQUIRE(jit2.GetRegister(0) == 42);
+
+    env1.code_mem = env2.code_mem;
+    translation_cache.InvalidateCacheRange(0, 8);
+
+    jit1.SetPC(0);
+    env1.ticks_left = 2;
+    jit1.Run();
+    REQUIRE(jit1.GetRegister(0) == 1);
+
+    jit2.SetPC(0);
+    env2.ticks_left = 2;
+    jit2.Run();
+    REQUIRE(jit2.GetRegister(0) == 1);
+}
+
+TEST_CASE("A64: TranslationCache capacity", "[a64]") {
+    // Smaller than any translation, so the cache holds one block at a time.
+    Dynarmic::A64::TranslationCache translation_cache{1};
+
+    A64TestEnv env1;
+    Dynarmic::A64::UserConfig conf1{&env1};
+    conf1.processor_id = 0;
+    conf1.translation_cache = &translation_cache;
+    Dynarmic::A64::Jit jit1{conf1};
+
+    A64TestEnv env2;
+    Dynarmic::A64::UserConfig conf2{&env2};
+    conf2.processor_id = 1;
+    conf2.translation_cache = &translation_cache;
+    Dynarmic::A64::Jit jit2{conf2};
+
+    env1.code_mem = {0xd2800540, 0x14000000, 0xd2800061, 0x14000000}; // MOVZ X0, #42; B .; MOVZ X1, #3; B .
+    env2.code_mem = {0xd2800020, 0x14000000, 0xd2800061, 0x14000000}; // MOVZ X0, #1; B .; MOVZ X1, #3; B .
+
+    jit1.SetPC(0);
+    env1.ticks_left = 2;
+    jit1.Run();
+    REQUIRE(jit1.GetRegister(0) == 42);
+
+    // Translating another block evicts the translation of the first.
+    jit1.SetPC(8);
+    env1.ticks_left = 2;
+    jit1.Run();
+    REQUIRE(jit1.GetRegister(1) == 3);
+
+    jit2.SetPC(0);
+    env2.ticks_left = 2;
+    jit2.Run();
+    REQUIRE(jit2.GetRegister(0) == 1);
+}
+
+namespace {
+class SchedulerTestEnv final : public Dynarmic::A64::UserCallbacks {
+public:
+    Dynarmic::A64::MultiCoreScheduler* scheduler = nullptr;
+    size_t core_index = 0;
+    std::vector<u32> code_mem;
+
+    std::uint32_t MemoryReadCode(u64 vaddr) override {
+        if (vaddr / 4 >= code_mem.size()) {
+            return 0x14000000; // B .
+        }
+        return code_mem[vaddr / 4];
+    }
+
+    std::uint8_t MemoryRead8(u64) override { return 0; }
+    std::uint16_t MemoryRead16(u64) override { return 0; }
+    std::uint32_t MemoryRead32(u64) override { return 0; }
+    std::uint64_t MemoryRead64(u64) override { return 0; }
+    Vector MemoryRead128(u64) override { return {0, 0}; }
+
+    void MemoryWrite8(u64, std::uint8_t) override {}
+    void MemoryWrite16(u64, std::uint16_t) override {}
+    void MemoryWrite32(u64, std::uint32_t) override {}
+    void MemoryWrite64(u64, std::uint64_t) override {}
+    void MemoryWrite128(u64, Vector) override {}
+
+    void InterpreterFallback(u64 pc, size_t num_instructions) override { ASSERT_MSG(false, "InterpreterFallback({:016x}, {})", pc, num_instructions); }
+
+    void CallSVC(std::uint32_t) override { scheduler->Stop(); }
+
+    void ExceptionRaised(u64 pc, Dynarmic::A64::Exception exception) override {
+        if (!scheduler->ExceptionRaised(core_index, exception)) {
+            ASSERT_MSG(false, "ExceptionRaised({:016x})", pc);
+        }
+    }
+
+    void AddTicks(std::uint64_t ticks) override { scheduler->AddTicks(core_index, ticks); }
+    std::uint64_t GetTicksRemaining() override { return scheduler->GetTicksRemaining(core_index); }
+    std::uint64_t GetCNTPCT() override { return 0; }
+};
+} // anonymous namespace
+
+TEST_CASE("A64: MultiCoreScheduler", "[a64]") {
+    std::array<SchedulerTestEnv, 3> envs;
+    envs[0].code_mem = {0xd503205f, 0xd4000001}; // WFE; SVC #0
+    envs[1].code_mem = {0xd503209f};             // SEV
+    envs[2].code_mem = {0xd503207f};             // WFI
+
+    Dynarmic::A64::ExclusiveMonitor monitor{envs.size()};
+    bool inline_event_handling = false;
+    SECTION("Callbacks") {}
+    SECTION("Inline event handling") { inline_event_handling = true; }
+
+    std::vector<std::unique_ptr<Dynarmic::A64::Jit>> jits;
+    std::vector<Dynarmic::A64::Jit*> cores;
+    for (size_t i = 0; i < envs.size(); i++) {
+        Dynarmic::A64::UserConfig conf{&envs[i]};
+        conf.processor_id = i;
+        conf.global_monitor = &monitor;
+        conf.inline_event_handling = inline_event_handling;
+        jits.emplace_back(std::make_unique<Dynarmic::A64::Jit>(conf));
+        cores.emplace_back(jits.back().get());
+    }
+
+    Dynarmic::A64::MultiCoreScheduler scheduler{cores, 2, 1000};
+    for (size_t i = 0; i < envs.size(); i++) {
+        envs[i].scheduler = &scheduler;
+        envs[i].core_index = i;
+    }
+
+    // Core 0 is woken by the SEV of core 1 and stops the scheduler.
+    // Core 2 is never woken, and may not have been scheduled at all by then.
+    scheduler.Run();
+
+    REQUIRE(jits[0]->GetPC() == 8);
+    REQUIRE(jits[1]->GetPC() == 4);
+}
+
+TEST_CASE("A64: MultiCoreScheduler with many cores", "[a64]") {
+    // Core 0 counts down and then stops the scheduler, while the other cores spin and compete for host threads.
+    std::array<SchedulerTestEnv, 8> envs;
+    envs[0].code_mem = {0xf1000400, 0x54ffffe1, 0xd4000001}; // SUBS X0, X0, #1; B.NE .-4; SVC #0
+
+    size_t host_thread_count = 0;
+    SECTION("Fewer host threads than cores") { host_thread_count = 3; }
+    SECTION("More host threads than cores") { host_thread_count = 12; }
+
+    std::vector<std::unique_ptr<Dynarmic::A64::Jit>> jits;
+    std::vector<Dynarmic::A64::Jit*> cores;
+    for (auto& env : envs) {
+        jits.emplace_back(std::make_unique<Dynarmic::A64::Jit>(Dynarmic::A64::UserConfig{&env}));
+        cores.emplace_back(jits.back().get());
+    }
+    jits[0]->SetRegister(0, 100000);
+
+    Dynarmic::A64::MultiCoreScheduler scheduler{cores, host_thread_count, 100};
+    for (size_t i = 0; i < envs.size(); i++) {
+        envs[i].scheduler = &scheduler;
+        envs[i].core_index = i;
+    }
+
+    scheduler.Run();
+
+    REQUIRE(jits[0]->GetRegister(0) == 0);
+    REQUIRE(jits[0]->GetPC() == 12);
+}
+
+TEST_CASE("A64: Inline event register handling", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::ExclusiveMonitor monitor{2};
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.processor_id = 0;
+    conf.global_monitor = &monitor;
+    conf.inline_event_handling = true;
+    Dynarmic::A64::Jit jit{conf};
+
+    // None of these reach UserCallbacks::ExceptionRaised: each WFE finds its event register set.
+    env.code_mem.emplace_back(0xd503209f); // SEV
+    env.code_mem.emplace_back(0xd503205f); // WFE
+    env.code_mem.emplace_back(0xd50320bf); // SEVL
+    env.code_mem.emplace_back(0xd503205f); // WFE
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    jit.SetPC(0);
+    env.ticks_left = 10;
+    jit.Run();
+
+    REQUIRE(jit.GetPC() == 16);
+    REQUIRE(!monitor.ClearEventRegister(0));
+    REQUIRE(monitor.ClearEventRegister(1));
+}
+
+TEST_CASE("A64: Inline tick accounting", "[a64]") {
+    A64TestEnv env;
+    u64 cycle_counter = 0;
+    std::atomic<u64> cycle_deadline = 100;
+
+    Dynarmic::A64::UserConfig conf{&env};
+    conf.cycle_counter = &cycle_counter;
+    conf.cycle_deadline = &cycle_deadline;
+    Dynarmic::A64::Jit jit{conf};
+
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0x17ffffff); // B .-4
+
+    // env.ticks_left is left at zero: AddTicks and GetTicksRemaining are never consulted.
+    jit.SetRegister(0, 0);
+    jit.SetPC(0);
+    jit.Run();
+
+    REQUIRE(cycle_counter >= 100);
+    REQUIRE(jit.GetRegister(0) == cycle_counter / 2);
+    REQUIRE(env.ticks_left == 0);
+
+    cycle_deadline = 200;
+    jit.Run();
+
+    REQUIRE(cycle_counter >= 200);
+    REQUIRE(jit.GetRegister(0) == cycle_counter / 2);
+}
+
+namespace {
+
+// A long block of interleaved vector and integer arithmetic with memory reads, which keeps
+// enough values live at once to exhaust the host registers.
+std::vector<u32> MakeRegisterPressureBlock(size_t length) {
+    std::vector<u32> code;
+    for (u32 i = 0; i < length; i++) {
+        const u32 d = (i * 7) % 31;
+        const u32 n = (i * 3 + 1) % 31;
+        const u32 m = (i * 5 + 2) % 31;
+        switch (i % 6) {
+        case 0:
+            code.emplace_back(0x4ea08400 | m << 16 | n << 5 | d); // ADD Vd.4S, Vn.4S, Vm.4S
+            break;
+        case 1:
+            code.emplace_back(0x6e201c00 | m << 16 | n << 5 | d); // EOR Vd.16B, Vn.16B, Vm.16B
+            break;
+        case 2:
+            code.emplace_back(0x4ea09c00 | m << 16 | n << 5 | d); // MUL Vd.4S, Vn.4S, Vm.4S
+            break;
+        case 3:
+            code.emplace_back(0x9ac02000 | m << 16 | n << 5 | d); // LSLV Xd, Xn, Xm
+            break;
+        case 4:
+            code.emplace_back(0x8b000000 | m << 16 | n << 5 | d); // ADD Xd, Xn, Xm
+            break;
+        case 5:
+            code.emplace_back(0xf9400000 | n << 5 | d); // LDR Xd, [Xn]
+            break;
+        }
+    }
+    return code;
+}
+
+void SetRegisterPressureState(Dynarmic::A64::Jit& jit) {
+    for (size_t i = 0; i < 31; i++) {
+        jit.SetRegister(i, 0x0123456789abcdefull * (i + 1));
+        jit.SetVector(i, {0xfedcba9876543210ull * (i + 1), 0x0f1e2d3c4b5a6978ull * (i + 3)});
+    }
+    jit.SetPC(0);
+}
+
+} // anonymous namespace
+
+TEST_CASE("A64: Liveness-guided register allocation", "[a64]") {
+    std::vector<u32> code;
+
+    SECTION("Register pressure block") {
+        code = MakeRegisterPressureBlock(300);
+    }
+
+    SECTION("Instructions of the behavior tests") {
+        // The instructions are translated as two blocks, so that the second one is allocated knowing
+        // which of them call into the host.
+        const std::vector<u32> instructions {
+            0x8b020020, // ADD X0, X1, X2
+            0xdac00c00, // REV X0, X0
+            0x5ac00421, // REV16 W1, W1
+            0x6a020020, // ANDS W0, W1, W2
+            0x6eb5d556, // FABD.4S V22, V10, V21
+            0x1f618a9c, // FNMSUB D28, D20, D1, D2
+            0x1f5e0e4a, // FMADD D10, D18, D30, D3
+            0x4e2fcccc, // FMLA.4S V12, V6, V15
+            0x2ea0fb50, // FNEG.2S V16, V26
+            0x2e207a1c, // SQNEG.8B V28, V16
+            0x5eb8fcad, // FRSQRTS S13, S5, S24
+            0x4e62b420, // SQDMULH.8H V0, V1, V2
+            0x6e225420, // URSHL.16B V0, V1, V2
+            0x4e22a420, // SMAXP.16B V0, V1, V2
+            0x4ea0b820, // ABS.4S V0, V1
+            0xd53be021, // MRS X1, CNTPCT_EL0
+            0xa9000c82, // STP X2, X3, [X4]
+            0xa94018e5, // LDP X5, X6, [X7]
+            0x29402548, // LDP W8, W9, [X10]
+            0x4c408400, // LD2 {V0.8H, V1.8H}, [X0]
+            0x4c000844, // ST4 {V4.4S, V5.4S, V6.4S, V7.4S}, [X2]
+            0xf8210002, // LDADD X1, X2, [X0]
+            0x3829400a, // LDSMAXB W9, W10, [X0]
+            0xc8b27c13, // CAS X18, X19, [X0]
+            0x48367eb8, // CASP X22, X23, X24, X25, [X21]
+            0xc87f0861, // LDXP X1, X2, [X3]
+            0xc8241865, // STXP W4, X5, X6, [X3]
+            0x8b030045, // ADD X5, X2, X3
+        };
+        code = instructions;
+        code.emplace_back(0x14000001); // B .+4
+        code.insert(code.end(), instructions.begin(), instructions.end());
+    }
+
+    const auto run = [&code](bool enable_liveness_register_allocation) {
+        A64TestEnv env;
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.enable_liveness_register_allocation = enable_liveness_register_allocation;
+        Dynarmic::A64::Jit jit{conf};
+
+        env.code_mem = code;
+        env.code_mem.emplace_back(0x14000000); // B .
+
+        SetRegisterPressureState(jit);
+        env.ticks_left = code.size();
+        jit.Run();
+
+        return std::make_tuple(jit.GetRegisters(), jit.GetVectors(), jit.GetPC(), jit.GetPstate(), jit.GetFpsr(), env.modified_memory);
+    };
+
+    REQUIRE(run(true) == run(false));
+}
+
+TEST_CASE("A64: Liveness-guided register allocation code quality", "[.benchmark]") {
+    constexpr size_t length = 300;
+
+    for (bool enable_liveness_register_allocation : {false, true}) {
+        A64TestEnv env;
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.enable_liveness_register_allocation = enable_liveness_register_allocation;
+        Dynarmic::A64::Jit jit{conf};
+
+        env.code_mem = MakeRegisterPressureBlock(length);
+        env.code_mem.emplace_back(0x14000000 | (-static_cast<u32>(length) & 0x3FFFFFF)); // B start
+
+        SetRegisterPressureState(jit);
+
+        const char* name = enable_liveness_register_allocation ? "liveness-guided allocation" : "greedy allocation";
+        BENCHMARK(name) {
+            env.ticks_left = length * 10000;
+            jit.Run();
+        }
+
+        const auto statistics = jit.GetCodeStatistics();
+        WARN(fmt::format("{}: {} bytes of code, {} spill slot accesses, {} register moves", name, statistics.code_size, statistics.spill_count, statistics.move_count));
+    }
+}
+
+namespace {
+
+struct PinnedRegisterTestEnv final : public Dynarmic::A64::UserCallbacks {
+    Dynarmic::A64::Jit* jit = nullptr;
+    std::vector<u32> code_mem;
+    std::map<u64, u64> memory;
+
+    std::uint32_t MemoryReadCode(u64 vaddr) override { return code_mem.at(vaddr / 4); }
+
+    std::uint8_t MemoryRead8(u64) override { return 0; }
+    std::uint16_t MemoryRead16(u64) override { return 0; }
+    std::uint32_t MemoryRead32(u64) override { return 0; }
+    std::uint64_t MemoryRead64(u64 vaddr) override { return memory[vaddr]; }
+    Vector MemoryRead128(u64) override { return {0, 0}; }
+
+    void MemoryWrite8(u64, std::uint8_t) override {}
+    void MemoryWrite16(u64, std::uint16_t) override {}
+    void MemoryWrite32(u64, std::uint32_t) override {}
+    void MemoryWrite64(u64 vaddr, std::uint64_t value) override { memory[vaddr] = value; }
+    void MemoryWrite128(u64, Vector) override {}
+
+    void InterpreterFallback(u64 pc, size_t num_instructions) override { ASSERT_MSG(false, "InterpreterFallback({:016x}, {})", pc, num_instructions); }
+
+    void CallSVC(std::uint32_t) override {
+        // Pinned registers must be observable and modifiable from callbacks.
+        jit->SetRegister(1, jit->GetRegister(1) + jit->GetRegister(0));
+        if (jit->GetRegister(0) == 10) {
+            jit->HaltExecution();
+        }
+    }
+
+    void ExceptionRaised(u64 pc, Dynarmic::A64::Exception) override { ASSERT_MSG(false, "ExceptionRaised({:016x})", pc); }
+
+    void AddTicks(std::uint64_t) override {}
+    std::uint64_t GetTicksRemaining() override { return 1000; }
+    std::uint64_t GetCNTPCT() override { return 0; }
+};
+
+} // anonymous namespace
+
+TEST_CASE("A64: Pinned registers", "[a64]") {
+    SECTION("Callbacks") {
+        PinnedRegisterTestEnv env;
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.pinned_registers = {0, 1, 31};
+        Dynarmic::A64::Jit jit{conf};
+        env.jit = &jit;
+
+        env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+        env.code_mem.emplace_back(0xd4000001); // SVC #0
+        env.code_mem.emplace_back(0xd10043ff); // SUB SP, SP, #16
+        env.code_mem.emplace_back(0xf90003e0); // STR X0, [SP]
+        env.code_mem.emplace_back(0x17fffffc); // B .-16
+
+        jit.SetRegister(0, 0);
+        jit.SetRegister(1, 0);
+        jit.SetSP(0x10000);
+        jit.SetPC(0);
+        jit.Run();
+
+        REQUIRE(jit.GetRegister(0) == 10);
+        REQUIRE(jit.GetRegister(1) == 55);
+        REQUIRE(jit.GetSP() == 0x10000 - 9 * 16);
+        REQUIRE(env.memory[jit.GetSP()] == 9);
+    }
+
+    // With four pinned registers only ten general-purpose registers are left to allocate.
+    SECTION("LSE atomics with TLB and dirty page bitmap") {
+        A64TestEnv env;
+
+        std::vector<void*> page_table(1 << 12, nullptr);
+        std::vector<u64> page_a(512, 0);
+        std::vector<u64> page_b(512, 0);
+        std::vector<u64> dirty_page_bitmap((1 << 12) / 64, 0);
+        page_table[0x10] = page_a.data();
+        page_table[0x11] = page_b.data();
+        page_a[0] = static_cast<u64>(-10);
+        page_a[1] = 5;
+        page_a[2] = 5;
+        page_a[3] = 100;
+        page_b[0] = 1;
+        page_b[1] = 2;
+
+        Dynarmic::A64::UserConfig conf{&env};
+        conf.page_table = page_table.data();
+        conf.page_table_address_space_bits = 24;
+        conf.enable_tlb = true;
+        conf.dirty_page_bitmap = dirty_page_bitmap.data();
+        conf.pinned_registers = {20, 21, 22, 23};
+        Dynarmic::A64::Jit jit{conf};
+
+        env.code_mem.emplace_back(0xf8214062); // LDSMAX X1, X2, [X3]
+        env.code_mem.emplace_back(0xf82150a4); // LDSMIN X1, X4, [X5]
+        env.code_mem.emplace_back(0xf82160e6); // LDUMAX X1, X6, [X7]
+        env.code_mem.emplace_back(0xf8217128); // LDUMIN X1, X8, [X9]
+        env.code_mem.emplace_back(0x482a7dcc); // CASP X10, X11, X12, X13, [X14]
+        env.code_mem.emplace_back(0x14000000); // B .
+
+        jit.SetRegister(1, 7);
+        jit.SetRegister(3, 0x10000);
+        jit.SetRegister(5, 0x10008);
+        jit.SetRegister(7, 0x10010);
+        jit.SetRegister(9, 0x10018);
+        jit.SetRegister(10, 1);
+        jit.SetRegister(11, 2);
+        jit.SetRegister(12, 3);
+        jit.SetRegister(13, 4);
+        jit.SetRegister(14, 0x11000);
+        for (size_t i = 20; i <= 23; i++) {
+            jit.SetRegister(i, i);
+        }
+        jit.SetPC(0);
+
+        env.ticks_left = 6;
+        jit.Run();
+
+        REQUIRE(jit.GetRegister(2) == static_cast<u64>(-10));
+        REQUIRE(page_a[0] == 7);
+        REQUIRE(jit.GetRegister(4) == 5);
+        REQUIRE(page_a[1] == 5);
+        REQUIRE(jit.GetRegister(6) == 5);
+        REQUIRE(page_a[2] == 7);
+        REQUIRE(jit.GetRegister(8) == 100);
+        REQUIRE(page_a[3] == 7);
+        REQUIRE(jit.GetRegister(10) == 1);
+        REQUIRE(jit.GetRegister(11) == 2);
+        REQUIRE(page_b[0] == 3);
+        REQUIRE(page_b[1] == 4);
+        for (size_t i = 20; i <= 23; i++) {
+            REQUIRE(jit.GetRegister(i) == i);
+        }
+        REQUIRE(dirty_page_bitmap[0] == (1ull << 0x10 | 1ull << 0x11));
+    }
+}
+
+TEST_CASE("A64: Conditional select and branch after compare", "[a64]") {
+    const auto condition_holds = [](u64 a, u64 b, u32 cond) {
+        const u64 result = a - b;
+        const bool n = (result >> 63) != 0;
+        const bool z = result == 0;
+        const bool c = a >= b;
+        const bool v = (((a ^ b) & (a ^ result)) >> 63) != 0;
+        switch (cond) {
+        case 0: return z;
+        case 1: return !z;
+        case 2: return c;
+        case 3: return !c;
+        case 4: return n;
+        case 5: return !n;
+        case 6: return v;
+        case 7: return !v;
+        case 8: return c && !z;
+        case 9: return !c || z;
+        case 10: return n == v;
+        case 11: return n != v;
+        case 12: return !z && n == v;
+        case 13: return z || n != v;
+        }
+        return true;
+    };
+
+    const std::vector<std::pair<u64, u64>> operands{
+        {0, 0},
+        {1, 2},
+        {2, 1},
+        {0x8000000000000000, 1},
+        {0x7fffffffffffffff, 0xffffffffffffffff},
+    };
+
+    for (u32 cond = 0; cond < 14; cond++) {
+        for (const auto& [a, b] : operands) {
+            A64TestEnv env;
+            Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+            env.code_mem.emplace_back(0xeb01001f); // CMP X0, X1
+            env.code_mem.emplace_back(0x9a840062 | cond << 12); // CSEL X2, X3, X4, cond
+            env.code_mem.emplace_back(0x9a840065 | cond << 12); // CSEL X5, X3, X4, cond
+            env.code_mem.emplace_back(0x54000040 | cond); // B.cond .+8
+            env.code_mem.emplace_back(0x14000000); // B .
+            env.code_mem.emplace_back(0x14000000); // B .
+
+            jit.SetRegister(0, a);
+            jit.SetRegister(1, b);
+            jit.SetRegister(3, 3);
+            jit.SetRegister(4, 4);
+            jit.SetPC(0);
+            env.ticks_left = 4;
+            jit.Run();
+
+            const bool holds = condition_holds(a, b, cond);
+            INFO("cond " << cond << ", a " << a << ", b " << b);
+            REQUIRE(jit.GetRegister(2) == (holds ? 3 : 4));
+            REQUIRE(jit.GetRegister(5) == (holds ? 3 : 4));
+            REQUIRE(jit.GetPC() == (holds ? 20 : 16));
+            REQUIRE(jit.GetPstate() >> 28 == (condition_holds(a, b, 4) << 3 | condition_holds(a, b, 0) << 2 | condition_holds(a, b, 2) << 1 | condition_holds(a, b, 6)));
+        }
+    }
+}
+
+namespace {
+
+template <typename T>
+using Lanes = std::array<T, 16 / sizeof(T)>;
+
+template <typename T>
+Lanes<T> ToLanes(const Dynarmic::A64::Vector& vector) {
+    Lanes<T> lanes;
+    std::memcpy(lanes.data(), vector.data(), sizeof(lanes));
+    return lanes;
+}
+
+template <typename T>
+Dynarmic::A64::Vector FromLanes(const Lanes<T>& lanes) {
+    Dynarmic::A64::Vector vector;
+    std::memcpy(vector.data(), lanes.data(), sizeof(vector));
+    return vector;
+}
+
+template <typename T>
+T RoundingShiftLeftReference(T value, s8 shift) {
+    constexpr int bit_size = static_cast<int>(sizeof(T) * 8);
+    if (shift >= 0) {
+        return shift >= bit_size ? 0 : static_cast<T>(static_cast<std::make_unsigned_t<T>>(value) << shift);
+    }
+
+    const int amount = -shift;
+    if (amount > bit_size) {
+        return 0;
+    }
+    const T round = static_cast<T>((static_cast<std::make_unsigned_t<T>>(value) >> (amount - 1)) & 1);
+    return static_cast<T>((value >> (amount - 1) >> 1) + round);
+}
+
+template <typename T>
+T ShiftLeftReference(T value, s8 shift) {
+    constexpr int bit_size = static_cast<int>(sizeof(T) * 8);
+    if (shift >= 0) {
+        return shift >= bit_size ? 0 : static_cast<T>(static_cast<std::make_unsigned_t<T>>(value) << shift);
+    }
+
+    const int amount = -shift;
+    if (amount >= bit_size) {
+        return std::is_signed_v<T> && value < 0 ? T(-1) : 0;
+    }
+    return static_cast<T>(value >> amount);
+}
+
+template <typename T>
+T SaturatedShiftLeftReference(T value, s8 shift, bool& saturated) {
+    constexpr int bit_size = static_cast<int>(sizeof(T) * 8);
+    if (shift < 0 || value == 0) {
+        return ShiftLeftReference<T>(value, shift);
+    }
+
+    if (shift < bit_size) {
+        const T result = static_cast<T>(static_cast<std::make_unsigned_t<T>>(value) << shift);
+        if (static_cast<T>(result >> shift) == value) {
+            return result;
+        }
+    }
+    saturated = true;
+    return value < 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+}
+
+// The guest state read by an instruction under test, which reads V0, V1 and V2 and writes V2.
+struct FuzzState {
+    std::array<Dynarmic::A64::Vector, 3> vectors;
+    u32 fpcr = 0;
+    u32 fpsr = 0;
+};
+
+FuzzState RandomFuzzState() {
+    FuzzState state;
+    for (auto& vector : state.vectors) {
+        vector = {RandInt<u64>(0, ~u64(0)), RandInt<u64>(0, ~u64(0))};
+    }
+    return state;
+}
+
+using ConfigureJit = void (*)(Dynarmic::A64::UserConfig& conf);
+
+// Runs instruction on 1000 states returned by generate, on one Jit for each of configurations, and
+// requires V2 (and FPSR, if compare_fpsr) to match the state computed by reference from the inputs.
+template <typename Generate, typename Reference>
+void FuzzInstruction(u32 instruction, Generate generate, Reference reference,
+                     std::initializer_list<ConfigureJit> configurations = {[](Dynarmic::A64::UserConfig&) {}},
+                     bool compare_fpsr = true) {
+    A64TestEnv env;
+    std::vector<std::unique_ptr<Dynarmic::A64::Jit>> jits;
+    for (ConfigureJit configure : configurations) {
+        Dynarmic::A64::UserConfig conf{&env};
+        configure(conf);
+        jits.emplace_back(std::make_unique<Dynarmic::A64::Jit>(conf));
+    }
+
+    env.code_mem.emplace_back(instruction);
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    for (size_t i = 0; i < 1000; i++) {
+        const FuzzState inputs = generate(i);
+        FuzzState expected = inputs;
+        reference(expected);
+
+        for (size_t j = 0; j < jits.size(); j++) {
+            Dynarmic::A64::Jit& jit = *jits[j];
+            for (size_t v = 0; v < inputs.vectors.size(); v++) {
+                jit.SetVector(v, inputs.vectors[v]);
+            }
+            jit.SetFpcr(inputs.fpcr);
+            jit.SetFpsr(inputs.fpsr);
+            jit.SetPC(0);
+            env.ticks_left = 2;
+            jit.Run();
+
+            const auto& [a, b, d] = inputs.vectors;
+            INFO(fmt::format("instruction {:08x}, configuration {}, fpcr {:08x}, a {:016x}{:016x}, b {:016x}{:016x}, d {:016x}{:016x}",
+                             instruction, j, inputs.fpcr, a[1], a[0], b[1], b[0], d[1], d[0]));
+            REQUIRE(jit.GetVector(2) == expected.vectors[2]);
+            if (compare_fpsr) {
+                REQUIRE(jit.GetFpsr() == expected.fpsr);
+            }
+        }
+    }
+}
+
+// Runs V2 = op(V0, V1) on random inputs and compares the results against reference.
+template <typename T, typename Reference>
+void FuzzVectorInstruction(u32 instruction, Reference reference) {
+    FuzzInstruction(instruction, [](size_t) { return RandomFuzzState(); }, [reference](FuzzState& state) {
+        Lanes<T> result;
+        reference(result, ToLanes<T>(state.vectors[0]), ToLanes<T>(state.vectors[1]));
+        state.vectors[2] = FromLanes<T>(result);
+    });
+}
+
+template <typename T>
+void FuzzRoundingShiftLeft(u32 instruction) {
+    FuzzVectorInstruction<T>(instruction, [](Lanes<T>& result, const Lanes<T>& x, const Lanes<T>& y) {
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = RoundingShiftLeftReference<T>(x[i], static_cast<s8>(y[i] & 0xFF));
+        }
+    });
+}
+
+template <typename T>
+void FuzzShiftLeft(u32 instruction) {
+    FuzzVectorInstruction<T>(instruction, [](Lanes<T>& result, const Lanes<T>& x, const Lanes<T>& y) {
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = ShiftLeftReference<T>(x[i], static_cast<s8>(y[i] & 0xFF));
+        }
+    });
+}
+
+// Runs V2 = SQSHL/UQSHL(V0, V1) on random inputs, checking both the result and FPSR.QC.
+template <typename T>
+void FuzzSaturatedShiftLeft(u32 instruction) {
+    FuzzInstruction(instruction, [](size_t) { return RandomFuzzState(); }, [](FuzzState& state) {
+        const Lanes<T> x = ToLanes<T>(state.vectors[0]);
+        const Lanes<T> y = ToLanes<T>(state.vectors[1]);
+        Lanes<T> result;
+        bool saturated = false;
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = SaturatedShiftLeftReference<T>(x[i], static_cast<s8>(y[i] & 0xFF), saturated);
+        }
+        state.vectors[2] = FromLanes<T>(result);
+        state.fpsr |= u32(saturated) << 27;
+    });
+}
+
+template <typename T, typename Fn>
+void FuzzPairedOperation(u32 instruction, Fn fn) {
+    FuzzVectorInstruction<T>(instruction, [fn](Lanes<T>& result, const Lanes<T>& x, const Lanes<T>& y) {
+        const size_t half = result.size() / 2;
+        for (size_t i = 0; i < half; i++) {
+            result[i] = fn(x[2 * i], x[2 * i + 1]);
+            result[half + i] = fn(y[2 * i], y[2 * i + 1]);
+        }
+    });
+}
+
+// Carry-less multiplication of a and b, returned as {low 64 bits, high 64 bits}.
+std::array<u64, 2> PolynomialMultiplyReference(u64 a, u64 b) {
+    std::array<u64, 2> result{};
+    for (size_t i = 0; i < 64; i++) {
+        if ((a >> i) & 1) {
+            result[0] ^= b << i;
+            result[1] ^= i == 0 ? 0 : b >> (64 - i);
+        }
+    }
+    return result;
+}
+
+// Runs PMULL/PMULL2 with bytes as elements, on the given half of the operands.
+void FuzzPolynomialMultiplyLong8(u32 instruction, size_t half) {
+    FuzzVectorInstruction<u64>(instruction, [half](Lanes<u64>& result, const Lanes<u64>& x, const Lanes<u64>& y) {
+        result = {};
+        for (size_t i = 0; i < 8; i++) {
+            const u64 product = PolynomialMultiplyReference((x[half] >> (i * 8)) & 0xFF, (y[half] >> (i * 8)) & 0xFF)[0];
+            result[i / 4] |= product << (i % 4 * 16);
+        }
+    });
+}
+
+// Runs V2 = op(V2, V0, V1) on random inputs and compares the results against reference, both with
+// the host SHA extensions (where supported) and with the generic expansion of the instruction.
+template <typename Reference>
+void FuzzSHAInstruction(u32 instruction, Reference reference) {
+    FuzzInstruction(instruction, [](size_t) { return RandomFuzzState(); }, [reference](FuzzState& state) {
+        Lanes<u32> d = ToLanes<u32>(state.vectors[2]);
+        reference(d, ToLanes<u32>(state.vectors[0]), ToLanes<u32>(state.vectors[1]));
+        state.vectors[2] = FromLanes<u32>(d);
+    }, {
+        [](Dynarmic::A64::UserConfig&) {},
+        [](Dynarmic::A64::UserConfig& conf) { conf.enable_host_sha_instructions = false; },
+    });
+}
+
+u32 RotateRight(u32 value, int amount) {
+    return (value >> amount) | (value << (32 - amount));
+}
+
+template <typename Fn>
+void SHA1HashUpdateReference(Lanes<u32>& x, u32 y, const Lanes<u32>& w, Fn fn) {
+    for (size_t i = 0; i < 4; i++) {
+        const u32 t = y + RotateRight(x[0], 27) + fn(x[1], x[2], x[3]) + w[i];
+        y = x[3];
+        x = {t, x[0], RotateRight(x[1], 2), x[2]};
+    }
+}
+
+// Returns {A, B, C, D} if part1, otherwise {E, F, G, H}.
+Lanes<u32> SHA256HashReference(Lanes<u32> x, Lanes<u32> y, const Lanes<u32>& w, bool part1) {
+    for (size_t i = 0; i < 4; i++) {
+        const u32 choose = (y[0] & y[1]) ^ (~y[0] & y[2]);
+        const u32 majority = (x[0] & x[1]) ^ (x[0] & x[2]) ^ (x[1] & x[2]);
+        const u32 sigma0 = RotateRight(x[0], 2) ^ RotateRight(x[0], 13) ^ RotateRight(x[0], 22);
+        const u32 sigma1 = RotateRight(y[0], 6) ^ RotateRight(y[0], 11) ^ RotateRight(y[0], 25);
+        const u32 t = y[3] + sigma1 + choose + w[i];
+        y = {t + x[3], y[0], y[1], y[2]};
+        x = {t + sigma0 + majority, x[0], x[1], x[2]};
+    }
+    return part1 ? x : y;
+}
+
+// Generates floating-point values biased towards the interesting cases: values close to
+// integers (including ties), special values and denormals, as well as random bit patterns.
+template <typename FPT>
+FPT RandomFloatingPoint(bool ordinary_values_only) {
+    using Info = Dynarmic::FP::FPInfo<FPT>;
+
+    switch (ordinary_values_only ? RandInt<int>(0, 1) * 2 : RandInt<int>(0, 3)) {
+    case 0: {
+        const double value = RandInt<s64>(-(1 << 20), 1 << 20) / 4.0;
+        FPT result;
+        if constexpr (sizeof(FPT) == 4) {
+            const float single = static_cast<float>(value);
+            std::memcpy(&result, &single, sizeof(result));
+        } else {
+            std::memcpy(&result, &value, sizeof(result));
+        }
+        return result;
+    }
+    case 1: {
+        const std::array<FPT, 9> special_values{
+            Info::Zero(false), Info::Zero(true), Info::Infinity(false), Info::Infinity(true),
+            Info::DefaultNaN(), static_cast<FPT>(Info::exponent_mask | 1), static_cast<FPT>(1),
+            Info::MaxNormal(false), static_cast<FPT>(Info::implicit_leading_bit | Info::sign_mask),
+        };
+        return special_values[RandInt<size_t>(0, special_values.size() - 1)];
+    }
+    case 2: {
+        const FPT exponent = RandInt<FPT>(Info::exponent_bias - 40, Info::exponent_bias + 40);
+        const FPT sign = RandInt<FPT>(0, 1) ? Info::sign_mask : 0;
+        return static_cast<FPT>(sign | (exponent << Info::explicit_mantissa_width) | RandInt<FPT>(0, Info::mantissa_mask));
+    }
+    default:
+        return RandInt<FPT>(0, ~FPT(0));
+    }
+}
+
+// Runs V2 = op(V0) on floating-point inputs and compares the results against reference. FPCR.FZ
+// and FPCR.DN are set at random, which covers the standard FPSCR value A32 ASIMD uses too.
+template <typename FPT, typename Reference>
+void FuzzFloatingPointVectorInstruction(u32 instruction, Reference reference, bool compare_fpsr = true) {
+    const auto generate = [](size_t i) {
+        Lanes<FPT> x;
+        for (FPT& lane : x) {
+            // Vectors made up only of ordinary values must come up often enough too.
+            lane = RandomFloatingPoint<FPT>(i % 2 == 0);
+        }
+
+        FuzzState state;
+        state.vectors = {FromLanes<FPT>(x), {}, {}};
+        state.fpcr = RandInt<u32>(0, 3) << 24;
+        return state;
+    };
+
+    FuzzInstruction(instruction, generate, [reference](FuzzState& state) {
+        const Lanes<FPT> x = ToLanes<FPT>(state.vectors[0]);
+        const Dynarmic::FP::FPCR fpcr{state.fpcr};
+        Dynarmic::FP::FPSR fpsr{state.fpsr};
+        Lanes<FPT> result;
+        for (size_t i = 0; i < x.size(); i++) {
+            result[i] = static_cast<FPT>(reference(x[i], fpcr, fpsr));
+        }
+        state.vectors[2] = FromLanes<FPT>(result);
+        state.fpsr = fpsr.Value();
+    }, {[](Dynarmic::A64::UserConfig&) {}}, compare_fpsr);
+}
+
+} // anonymous namespace
+
+TEST_CASE("A64: Fuzz vector rounding shifts", "[a64]") {
+    FuzzRoundingShiftLeft<s8>(0x4e215402); // SRSHL V2.16B, V0.16B, V1.16B
+    FuzzRoundingShiftLeft<s16>(0x4e615402); // SRSHL V2.8H, V0.8H, V1.8H
+    FuzzRoundingShiftLeft<s32>(0x4ea15402); // SRSHL V2.4S, V0.4S, V1.4S
+    FuzzRoundingShiftLeft<s64>(0x4ee15402); // SRSHL V2.2D, V0.2D, V1.2D
+    FuzzRoundingShiftLeft<u8>(0x6e215402); // URSHL V2.16B, V0.16B, V1.16B
+    FuzzRoundingShiftLeft<u16>(0x6e615402); // URSHL V2.8H, V0.8H, V1.8H
+    FuzzRoundingShiftLeft<u32>(0x6ea15402); // URSHL V2.4S, V0.4S, V1.4S
+    FuzzRoundingShiftLeft<u64>(0x6ee15402); // URSHL V2.2D, V0.2D, V1.2D
+}
+
+TEST_CASE("A64: Fuzz vector shifts by register", "[a64]") {
+    FuzzShiftLeft<s8>(0x4e214402); // SSHL V2.16B, V0.16B, V1.16B
+    FuzzShiftLeft<u8>(0x6e214402); // USHL V2.16B, V0.16B, V1.16B
+    FuzzSaturatedShiftLeft<s8>(0x4e214c02); // SQSHL V2.16B, V0.16B, V1.16B
+    FuzzSaturatedShiftLeft<s16>(0x4e614c02); // SQSHL V2.8H, V0.8H, V1.8H
+    FuzzSaturatedShiftLeft<s32>(0x4ea14c02); // SQSHL V2.4S, V0.4S, V1.4S
+    FuzzSaturatedShiftLeft<s64>(0x4ee14c02); // SQSHL V2.2D, V0.2D, V1.2D
+    FuzzSaturatedShiftLeft<u8>(0x6e214c02); // UQSHL V2.16B, V0.16B, V1.16B
+    FuzzSaturatedShiftLeft<u16>(0x6e614c02); // UQSHL V2.8H, V0.8H, V1.8H
+    FuzzSaturatedShiftLeft<u32>(0x6ea14c02); // UQSHL V2.4S, V0.4S, V1.4S
+    FuzzSaturatedShiftLeft<u64>(0x6ee14c02); // UQSHL V2.2D, V0.2D, V1.2D
+}
+
+TEST_CASE("A64: Fuzz vector paired minimum and maximum", "[a64]") {
+    const auto max = [](auto a, auto b) { return std::max(a, b); };
+    const auto min = [](auto a, auto b) { return std::min(a, b); };
+
+    FuzzPairedOperation<s8>(0x4e21a402, max); // SMAXP V2.16B, V0.16B, V1.16B
+    FuzzPairedOperation<s16>(0x4e61a402, max); // SMAXP V2.8H, V0.8H, V1.8H
+    FuzzPairedOperation<u8>(0x6e21a402, max); // UMAXP V2.16B, V0.16B, V1.16B
+    FuzzPairedOperation<u16>(0x6e61a402, max); // UMAXP V2.8H, V0.8H, V1.8H
+    FuzzPairedOperation<s8>(0x4e21ac02, min); // SMINP V2.16B, V0.16B, V1.16B
+    FuzzPairedOperation<s16>(0x4e61ac02, min); // SMINP V2.8H, V0.8H, V1.8H
+    FuzzPairedOperation<u8>(0x6e21ac02, min); // UMINP V2.16B, V0.16B, V1.16B
+    FuzzPairedOperation<u16>(0x6e61ac02, min); // UMINP V2.8H, V0.8H, V1.8H
+}
+
+TEST_CASE("A64: Fuzz vector floating-point estimates and rounding", "[a64]") {
+    using Dynarmic::FP::FPCR;
+    using Dynarmic::FP::FPSR;
+    using Dynarmic::FP::RoundingMode;
+
+    FuzzFloatingPointVectorInstruction<u32>(0x4ea1d802, Dynarmic::FP::FPRecipEstimate<u32>); // FRECPE V2.4S, V0.4S
+    FuzzFloatingPointVectorInstruction<u64>(0x4ee1d802, Dynarmic::FP::FPRecipEstimate<u64>); // FRECPE V2.2D, V0.2D
+    FuzzFloatingPointVectorInstruction<u32>(0x6ea1d802, Dynarmic::FP::FPRSqrtEstimate<u32>); // FRSQRTE V2.4S, V0.4S
+    FuzzFloatingPointVectorInstruction<u64>(0x6ee1d802, Dynarmic::FP::FPRSqrtEstimate<u64>); // FRSQRTE V2.2D, V0.2D
+
+    const auto round = [](auto op, FPCR fpcr, FPSR& fpsr) {
+        return Dynarmic::FP::FPRoundInt(op, fpcr, RoundingMode::ToNearest_TieAwayFromZero, false, fpsr);
+    };
+    FuzzFloatingPointVectorInstruction<u32>(0x6e218802, round); // FRINTA V2.4S, V0.4S
+    FuzzFloatingPointVectorInstruction<u64>(0x6e618802, round); // FRINTA V2.2D, V0.2D
+
+    // Vector conversions to fixed-point only report some exceptions in FPSR, in any rounding mode.
+    const auto to_signed = [](auto op, FPCR fpcr, FPSR& fpsr) {
+        return Dynarmic::FP::FPToFixed(sizeof(op) * 8, op, 0, false, fpcr, RoundingMode::ToNearest_TieAwayFromZero, fpsr);
+    };
+    const auto to_unsigned = [](auto op, FPCR fpcr, FPSR& fpsr) {
+        return Dynarmic::FP::FPToFixed(sizeof(op) * 8, op, 0, true, fpcr, RoundingMode::ToNearest_TieAwayFromZero, fpsr);
+    };
+    FuzzFloatingPointVectorInstruction<u32>(0x4e21c802, to_signed, false); // FCVTAS V2.4S, V0.4S
+    FuzzFloatingPointVectorInstruction<u64>(0x4e61c802, to_signed, false); // FCVTAS V2.2D, V0.2D
+    FuzzFloatingPointVectorInstruction<u32>(0x6e21c802, to_unsigned, false); // FCVTAU V2.4S, V0.4S
+    FuzzFloatingPointVectorInstruction<u64>(0x6e61c802, to_unsigned, false); // FCVTAU V2.2D, V0.2D
+}
+
+TEST_CASE("A64: Fuzz vector polynomial multiplication", "[a64]") {
+    FuzzVectorInstruction<u8>(0x6e219c02, [](Lanes<u8>& result, const Lanes<u8>& x, const Lanes<u8>& y) { // PMUL V2.16B, V0.16B, V1.16B
+        for (size_t i = 0; i < result.size(); i++) {
+            result[i] = static_cast<u8>(PolynomialMultiplyReference(x[i], y[i])[0]);
+        }
+    });
+
+    FuzzPolynomialMultiplyLong8(0x0e21e002, 0); // PMULL V2.8H, V0.8B, V1.8B
+    FuzzPolynomialMultiplyLong8(0x4e21e002, 1); // PMULL2 V2.8H, V0.16B, V1.16B
+
+    FuzzVectorInstruction<u64>(0x0ee1e002, [](Lanes<u64>& result, const Lanes<u64>& x, const Lanes<u64>& y) { // PMULL V2.1Q, V0.1D, V1.1D
+        result = PolynomialMultiplyReference(x[0], y[0]);
+    });
+    FuzzVectorInstruction<u64>(0x4ee1e002, [](Lanes<u64>& result, const Lanes<u64>& x, const Lanes<u64>& y) { // PMULL2 V2.1Q, V0.2D, V1.2D
+        result = PolynomialMultiplyReference(x[1], y[1]);
+    });
+}
+
+TEST_CASE("A64: Fuzz SHA1 and SHA256 instructions", "[a64]") {
+    const auto choose = [](u32 x, u32 y, u32 z) { return (x & y) | (~x & z); };
+    const auto majority = [](u32 x, u32 y, u32 z) { return (x & y) | (x & z) | (y & z); };
+    const auto parity = [](u32 x, u32 y, u32 z) { return x ^ y ^ z; };
+
+    FuzzSHAInstruction(0x5e010002, [&](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA1C Q2, S0, V1.4S
+        SHA1HashUpdateReference(d, n[0], m, choose);
+    });
+    FuzzSHAInstruction(0x5e011002, [&](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA1P Q2, S0, V1.4S
+        SHA1HashUpdateReference(d, n[0], m, parity);
+    });
+    FuzzSHAInstruction(0x5e012002, [&](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA1M Q2, S0, V1.4S
+        SHA1HashUpdateReference(d, n[0], m, majority);
+    });
+    FuzzSHAInstruction(0x5e281802, [](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>&) { // SHA1SU1 V2.4S, V0.4S
+        const Lanes<u32> t{d[0] ^ n[1], d[1] ^ n[2], d[2] ^ n[3], d[3]};
+        d = {RotateRight(t[0], 31), RotateRight(t[1], 31), RotateRight(t[2], 31), RotateRight(t[3], 31) ^ RotateRight(t[0], 30)};
+    });
+    FuzzSHAInstruction(0x5e014002, [](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA256H Q2, Q0, V1.4S
+        d = SHA256HashReference(d, n, m, true);
+    });
+    FuzzSHAInstruction(0x5e015002, [](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA256H2 Q2, Q0, V1.4S
+        d = SHA256HashReference(n, d, m, false);
+    });
+    FuzzSHAInstruction(0x5e282802, [](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>&) { // SHA256SU0 V2.4S, V0.4S
+        const Lanes<u32> t{d[1], d[2], d[3], n[0]};
+        for (size_t i = 0; i < 4; i++) {
+            d[i] += RotateRight(t[i], 7) ^ RotateRight(t[i], 18) ^ (t[i] >> 3);
+        }
+    });
+    FuzzSHAInstruction(0x5e016002, [](Lanes<u32>& d, const Lanes<u32>& n, const Lanes<u32>& m) { // SHA256SU1 V2.4S, V0.4S, V1.4S
+        const auto sigma1 = [](u32 x) { return RotateRight(x, 17) ^ RotateRight(x, 19) ^ (x >> 10); };
+        const Lanes<u32> t{n[1], n[2], n[3], m[0]};
+        d[0] += sigma1(m[2]) + t[0];
+        d[1] += sigma1(m[3]) + t[1];
+        d[2] += sigma1(d[0]) + t[2];
+        d[3] += sigma1(d[1]) + t[3];
+    });
+}
+
+TEST_CASE("A64: Lazy MXCSR switching", "[a64]") {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.emplace_back(0x1e212802); // FADD S2, S0, S1
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0x17fffffd); // B .-12
+
+    const u32 host_mxcsr = _mm_getcsr();
+    _mm_setcsr(0x1F80);
+    SCOPE_EXIT { _mm_setcsr(host_mxcsr); };
+
+    // Round towards zero: 1.0 + 0.75 ulp is inexact and rounds down rather than up.
+    jit.SetFpcr(3 << 22);
+    jit.SetVector(0, {0x3F800000, 0});
+    jit.SetVector(1, {0x33C00000, 0});
+
+    const auto run_from = [&](u64 pc) {
+        jit.SetPC(pc);
+        env.ticks_left = 4;
+        jit.Run();
+        REQUIRE(_mm_getcsr() == 0x1F80);
+    };
+
+    run_from(0);
+    REQUIRE(jit.GetFpsr() == 0);
+
+    run_from(8);
+    REQUIRE(jit.GetVector(2)[0] == 0x3F800000);
+    REQUIRE(jit.GetFpsr() == 0x10);
+
+    // The guest's cumulative exception bits survive runs which do not switch to the guest MXCSR.
+    run_from(0);
+    REQUIRE(jit.GetFpsr() == 0x10);
+
+    jit.SetFpsr(0);
+    jit.SetVector(2, {0, 0});
+    run_from(16);
+    REQUIRE(jit.GetVector(2)[0] == 0x3F800000);
+    REQUIRE(jit.GetFpsr() == 0x10);
+}
+
+namespace {
+
+struct MxcsrTestEnv final : public Dynarmic::A64::UserCallbacks {
+    u64 ticks_left = 0;
+    std::vector<u32> code_mem;
+    std::vector<u32> mxcsr_at_svc;
+
+    std::uint32_t MemoryReadCode(u64 vaddr) override { return vaddr / 4 < code_mem.size() ? code_mem[vaddr / 4] : 0x14000000; }
+
+    std::uint8_t MemoryRead8(u64) override { return 0; }
+    std::uint16_t MemoryRead16(u64) override { return 0; }
+    std::uint32_t MemoryRead32(u64) override { return 0; }
+    std::uint64_t MemoryRead64(u64) override { return 0; }
+    Vector MemoryRead128(u64) override { return {0, 0}; }
+
+    void MemoryWrite8(u64, std::uint8_t) override {}
+    void MemoryWrite16(u64, std::uint16_t) override {}
+    void MemoryWrite32(u64, std::uint32_t) override {}
+    void MemoryWrite64(u64, std::uint64_t) override {}
+    void MemoryWrite128(u64, Vector) override {}
+
+    void InterpreterFallback(u64 pc, size_t num_instructions) override { ASSERT_MSG(false, "InterpreterFallback({:016x}, {})", pc, num_instructions); }
+
+    // Callbacks run with whichever MXCSR the calling block left loaded.
+    void CallSVC(std::uint32_t) override { mxcsr_at_svc.emplace_back(_mm_getcsr()); }
+
+    void ExceptionRaised(u64 pc, Dynarmic::A64::Exception) override { ASSERT_MSG(false, "ExceptionRaised({:016x})", pc); }
+
+    void AddTicks(std::uint64_t ticks) override { ticks_left -= std::min(ticks, ticks_left); }
+    std::uint64_t GetTicksRemaining() override { return ticks_left; }
+    std::uint64_t GetCNTPCT() override { return 0; }
+};
+
+} // anonymous namespace
+
+TEST_CASE("A64: Only floating-point blocks load the guest MXCSR", "[a64]") {
+    MxcsrTestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(0x91000400); // ADD X0, X0, #1
+    env.code_mem.emplace_back(0xd4000001); // SVC #0
+    env.code_mem.emplace_back(0x14000000); // B .
+    env.code_mem.emplace_back(0x1e212802); // FADD S2, S0, S1
+    env.code_mem.emplace_back(0xd4000001); // SVC #0
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    const u32 host_mxcsr = _mm_getcsr();
+    _mm_setcsr(0x1F80);
+    SCOPE_EXIT { _mm_setcsr(host_mxcsr); };
+
+    // Round towards zero, which the guest MXCSR reflects in its rounding control bits.
+    jit.SetFpcr(3 << 22);
+
+    const auto run_from = [&](u64 pc) {
+        jit.SetPC(pc);
+        env.ticks_left = 3;
+        jit.Run();
+        REQUIRE(_mm_getcsr() == 0x1F80);
+    };
+
+    run_from(0);
+    run_from(12);
+
+    REQUIRE(env.mxcsr_at_svc.size() == 2);
+    REQUIRE(env.mxcsr_at_svc[0] == 0x1F80);
+    REQUIRE((env.mxcsr_at_svc[1] & 0x6000) == 0x6000);
+}
+
+static void BenchmarkDispatch(const char* name, u32 instruction) {
+    A64TestEnv env;
+    Dynarmic::A64::Jit jit{Dynarmic::A64::UserConfig{&env}};
+
+    env.code_mem.emplace_back(instruction);
+    env.code_mem.emplace_back(0xd503201f); // NOP
+    env.code_mem.emplace_back(0x14000000); // B .
+
+    const auto run = [&] {
+        jit.SetPC(0);
+        env.ticks_left = 1;
+        jit.Run();
+    };
+
+    run(); // Compile the block outside of the benchmark.
+
+    BENCHMARK(name) {
+        for (size_t i = 0; i < 100000; i++) {
+            run();
+        }
+    }
+}
+
+TEST_CASE("A64: Dispatch cost of an integer block", "[.benchmark]") {
+    BenchmarkDispatch("integer block", 0x91000400); // ADD X0, X0, #1
+}
+
+TEST_CASE("A64: Dispatch cost of a floating-point block", "[.benchmark]") {
+    BenchmarkDispatch("floating-point block", 0x1e212802); // FADD S2, S0, S1
+}
@@ -27,6 +27,9 @@ public:
     std::map<u64, u8> modified_memory;
     std::vector<std::string> interrupts;
 
+    u64 read_only_memory_start = 0;
+    u64 read_only_memory_end = 0;
+
     bool IsInCodeMem(u64 vaddr) const {
         return vaddr >= code_mem_start_address && vaddr < code_mem_start_address + code_mem.size() * 4;
     }
@@ -85,6 +88,10 @@ public:
         MemoryWrite64(vaddr + 8, value[1]);
     }
 
+    bool IsReadOnlyMemory(u64 vaddr) override {
+        return vaddr >= read_only_memory_start && vaddr < read_only_memory_end;
+    }
+
     void InterpreterFallback(u64 pc, size_t num_instructions) override { ASSERT_MSG(false, "InterpreterFallback({:016x}, {})", pc, num_instructions); }
 
     void CallSVC(std::uint32_t swi) override { ASSERT_MSG(false, "CallSVC({})", swi); }